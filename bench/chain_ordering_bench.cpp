@@ -0,0 +1,131 @@
+// Benchmark of self-organizing bucket chains on a Zipf-distributed lookup workload.
+//
+// Reports the average position of the searched key inside its chain (number of keys a sequential scan
+// compares before the hit), the average number of chain blocks scanned, and the wall-clock time per lookup.
+
+#include <algorithm>  // lower_bound
+#include <chrono>
+#include <cmath>  // pow
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hash_table.hpp"
+
+using namespace itis;
+
+namespace {
+
+  constexpr int kBlockCapacity = 8;  // keys per chain block
+  constexpr int kNumLookups = 1'000'000;
+  constexpr double kZipfExponent = 1.0;
+
+  // samples ranks [0...n) with probability proportional to 1 / (rank + 1)^s
+  class ZipfDistribution {
+   public:
+    ZipfDistribution(int n, double s) : cdf_(n) {
+      double sum = 0.0;
+      for (int rank = 0; rank < n; rank++) {
+        sum += 1.0 / std::pow(rank + 1, s);
+        cdf_[rank] = sum;
+      }
+      for (auto &value : cdf_) {
+        value /= sum;
+      }
+    }
+
+    int operator()(std::mt19937 &engine) {
+      const double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+      const auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+      return std::min(static_cast<int>(it - cdf_.begin()), static_cast<int>(cdf_.size()) - 1);
+    }
+
+   private:
+    std::vector<double> cdf_;
+  };
+
+  const char *name(HashTable::ChainOrdering ordering) {
+    switch (ordering) {
+      case HashTable::ChainOrdering::kInsertion:
+        return "insertion";
+      case HashTable::ChainOrdering::kMoveToFront:
+        return "move-to-front";
+      case HashTable::ChainOrdering::kTranspose:
+        return "transpose";
+    }
+    return "";
+  }
+
+  void run(const std::string &workload, const std::vector<int> &keys, HashTable::ChainOrdering ordering) {
+    auto hash_table = HashTable(64, 1.0);
+    for (int key : keys) {
+      hash_table.Put(key, std::to_string(key));
+    }
+    hash_table.set_chain_ordering(ordering);
+
+    // the hottest ranks are the last inserted keys, i.e. the worst case for an insertion-ordered chain
+    std::mt19937 engine(42);
+    ZipfDistribution zipf(static_cast<int>(keys.size()), kZipfExponent);
+    std::vector<int> lookups(kNumLookups);
+    for (auto &key : lookups) {
+      key = keys[keys.size() - 1 - zipf(engine)];
+    }
+
+    long long positions = 0;
+    long long blocks = 0;
+    for (int key : lookups) {
+      const int position = hash_table.ChainPosition(key);
+      positions += position;
+      blocks += position / kBlockCapacity + 1;
+      hash_table.Search(key);
+    }
+
+    // timed pass over the already self-organized chains
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t checksum = 0;
+    for (int key : lookups) {
+      checksum += hash_table.Search(key)->size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::left << std::setw(12) << workload << std::setw(16) << name(ordering) << std::right
+              << std::fixed << std::setprecision(2) << std::setw(14)
+              << static_cast<double>(positions) / kNumLookups << std::setw(14)
+              << static_cast<double>(blocks) / kNumLookups << std::setw(14)
+              << std::chrono::duration<double, std::nano>(elapsed).count() / kNumLookups << "   (" << checksum
+              << ")" << std::endl;
+  }
+
+}  // namespace
+
+int main() {
+  // 512 keys that are multiples of 2^20 fall into the same bucket: a single long chain
+  std::vector<int> colliding;
+  for (int index = 0; index < 512; index++) {
+    colliding.push_back(index << 20);
+  }
+
+  // 100'000 random keys: short chains of the typical load
+  std::vector<int> uniform;
+  std::mt19937 engine(7);
+  std::uniform_int_distribution<int> distribution(0, 1 << 30);
+  for (int index = 0; index < 100'000; index++) {
+    uniform.push_back(distribution(engine));
+  }
+
+  std::cout << std::left << std::setw(12) << "workload" << std::setw(16) << "ordering" << std::right
+            << std::setw(14) << "avg position" << std::setw(14) << "avg blocks" << std::setw(14) << "ns/lookup"
+            << std::endl;
+
+  for (const auto ordering : {HashTable::ChainOrdering::kInsertion, HashTable::ChainOrdering::kMoveToFront,
+                              HashTable::ChainOrdering::kTranspose}) {
+    run("colliding", colliding, ordering);
+  }
+  for (const auto ordering : {HashTable::ChainOrdering::kInsertion, HashTable::ChainOrdering::kMoveToFront,
+                              HashTable::ChainOrdering::kTranspose}) {
+    run("uniform", uniform, ordering);
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+// Loopback benchmark of the key-value server backends (epoll vs io_uring).
+//
+// A single-threaded load generator keeps kNumConnections connections busy, each with one request in flight
+// (90% get, 10% set of random preloaded keys), and reports the completed requests per second.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "kv_server.hpp"
+
+using namespace itis;
+
+namespace {
+
+  constexpr int kNumConnections = 64;
+  constexpr int kNumKeys = 100'000;
+  constexpr int kValueBytes = 32;
+  constexpr auto kDuration = std::chrono::seconds(2);
+
+  struct Client {
+    int fd{-1};
+    std::string response;
+    std::string terminator;  // suffix of the complete response
+  };
+
+  int connect_to(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));  // EINPROGRESS
+
+    const int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return fd;
+  }
+
+  void send_request(Client &client, std::mt19937 &engine) {
+    const int key = std::uniform_int_distribution<int>(0, kNumKeys - 1)(engine);
+
+    std::string request;
+    if (engine() % 10 == 0) {
+      request = "set " + std::to_string(key) + " 0 0 " + std::to_string(kValueBytes) + "\r\n"
+              + std::string(kValueBytes, 'v') + "\r\n";
+      client.terminator = "STORED\r\n";
+    } else {
+      request = "get " + std::to_string(key) + "\r\n";
+      client.terminator = "END\r\n";
+    }
+
+    client.response.clear();
+    // a small request always fits into the socket buffer of an idle connection
+    while (send(client.fd, request.data(), request.size(), MSG_NOSIGNAL) == -1 && errno == EAGAIN) {
+    }
+  }
+
+  bool is_complete(const Client &client) {
+    const auto &response = client.response;
+    const auto &terminator = client.terminator;
+    return response.size() >= terminator.size()
+        && response.compare(response.size() - terminator.size(), terminator.size(), terminator) == 0;
+  }
+
+  double run(KvServer::Backend backend, const char *name) {
+    auto table = HashTable(1024);
+    for (int key = 0; key < kNumKeys; key++) {
+      table.Put(key, std::string(kValueBytes, 'v'));
+    }
+
+    auto server = KvServer(table, 0, backend);
+    auto loop = std::thread([&server] { server.Run(); });
+
+    const int epoll_fd = epoll_create1(0);
+    std::vector<Client> clients(kNumConnections);
+    std::mt19937 engine(42);
+    for (int index = 0; index < kNumConnections; index++) {
+      clients[index].fd = connect_to(server.port());
+      epoll_event event{};
+      event.events = EPOLLOUT;
+      event.data.u32 = static_cast<uint32_t>(index);
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, clients[index].fd, &event);
+    }
+
+    long long completed = 0;
+    epoll_event events[kNumConnections];
+    char chunk[64 * 1024];
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + kDuration;
+
+    while (std::chrono::steady_clock::now() < deadline) {
+      const int num_events = epoll_wait(epoll_fd, events, kNumConnections, 100);
+      for (int index = 0; index < num_events; index++) {
+        Client &client = clients[events[index].data.u32];
+
+        if ((events[index].events & EPOLLOUT) != 0) {
+          // connected: switch to waiting for responses
+          epoll_event event{};
+          event.events = EPOLLIN;
+          event.data.u32 = events[index].data.u32;
+          epoll_ctl(epoll_fd, EPOLL_CTL_MOD, client.fd, &event);
+          send_request(client, engine);
+          continue;
+        }
+
+        const ssize_t received = recv(client.fd, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+          continue;
+        }
+        client.response.append(chunk, static_cast<size_t>(received));
+        if (is_complete(client)) {
+          completed++;
+          send_request(client, engine);
+        }
+      }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (auto &client : clients) {
+      close(client.fd);
+    }
+    close(epoll_fd);
+    server.Stop();
+    loop.join();
+
+    const double rps = static_cast<double>(completed) / seconds;
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(12) << std::fixed
+              << std::setprecision(0) << rps << " requests/s" << std::endl;
+    return rps;
+  }
+
+}  // namespace
+
+int main() {
+  std::cout << kNumConnections << " connections, 1 request in flight each, " << kNumKeys << " keys of "
+            << kValueBytes << " bytes" << std::endl;
+
+  const double epoll = run(KvServer::Backend::kEpoll, "epoll");
+  try {
+    const double io_uring = run(KvServer::Backend::kIoUring, "io_uring");
+    std::cout << "io_uring / epoll: " << std::setprecision(2) << io_uring / epoll << std::endl;
+  } catch (const std::runtime_error &error) {
+    std::cout << "io_uring: " << error.what() << std::endl;
+  }
+  return 0;
+}
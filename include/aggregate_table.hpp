@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>  // min
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>  // FILE, tmpfile
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>  // forward, move
+#include <vector>
+
+#include "fixed_hash_table.hpp"  // FixedHash
+#include "utils.hpp"             // round_up_to_power_of_two, parallel_for
+
+namespace itis {
+
+  /**
+   * Hash table of aggregates (counts, sums, ...) for group-by style workloads.
+   *
+   * Upsert finds the aggregate of a key or creates a value-initialized one and updates it in place, all in a
+   * single probe (open addressing, linear probing over a dense key array). There are no removals, so there
+   * are no tombstones either. The aggregate type should be cheap to value-initialize, Agg{} being the identity
+   * of the merge function (zero count, zero sum), because Merge creates missing keys the same way.
+   *
+   * Example (count and sum per key):
+   *
+   *   struct Stats { long count; long sum; };
+   *   AggregateTable<int, Stats> table;
+   *   table.Upsert(key, [&](Stats &stats) { stats.count++; stats.sum += amount; });
+   */
+  template <typename K, typename Agg, typename Hash = FixedHash<K>>
+  class AggregateTable final {
+   public:
+    // constants
+    static constexpr int kDefaultCapacity = 16;
+    static constexpr int kGrowthCoefficient = 2;
+    static constexpr double kLoadFactor = 0.75;
+
+   private:
+    // struct members
+    int num_keys_{0};  // number of (unique) keys in the table
+
+    std::vector<K> keys_;                 // dense array scanned while probing
+    std::vector<std::uint8_t> occupied_;  // 1 - the slot holds a key
+    std::vector<Agg> aggregates_;         // touched on a hit only
+
+    std::size_t slot_of(const K &key) const {
+      return Hash{}(key) & (keys_.size() - 1);
+    }
+
+    /**
+     * @return slot occupied by the key or the empty slot the key would be put into
+     */
+    std::size_t probe(const K &key) const {
+      const std::size_t mask = keys_.size() - 1;
+      std::size_t slot = slot_of(key);
+      while (occupied_[slot] != 0 && !(keys_[slot] == key)) {
+        slot = (slot + 1) & mask;
+      }
+      return slot;
+    }
+
+    void rehash(int capacity) {
+      std::vector<K> old_keys(static_cast<std::size_t>(capacity));
+      std::vector<std::uint8_t> old_occupied(static_cast<std::size_t>(capacity), 0);
+      std::vector<Agg> old_aggregates(static_cast<std::size_t>(capacity));
+      old_keys.swap(keys_);
+      old_occupied.swap(occupied_);
+      old_aggregates.swap(aggregates_);
+
+      for (std::size_t index = 0; index < old_keys.size(); index++) {
+        if (old_occupied[index] != 0) {
+          const std::size_t slot = probe(old_keys[index]);
+          keys_[slot] = old_keys[index];
+          occupied_[slot] = 1;
+          aggregates_[slot] = std::move(old_aggregates[index]);
+        }
+      }
+    }
+
+   public:
+    /**
+     * @param capacity - initial number of slots (rounded up to a power of two)
+     * @throws std::logic_error - if the capacity is not positive
+     */
+    explicit AggregateTable(int capacity = kDefaultCapacity) {
+      if (capacity <= 0) {
+        throw std::logic_error("aggregate table capacity must be greater than zero");
+      }
+      rehash(static_cast<int>(utils::round_up_to_power_of_two(capacity)));
+    }
+
+    /**
+     * Create-or-update the aggregate of the key in one probe.
+     * @param key - value of the key
+     * @param update - function called with the aggregate (value-initialized for a new key)
+     * @return updated aggregate (valid until the next Upsert)
+     */
+    template <typename Function>
+    Agg &Upsert(const K &key, Function &&update) {
+      std::size_t slot = probe(key);
+
+      if (occupied_[slot] == 0) {
+        if (is_full()) {
+          rehash(capacity() * kGrowthCoefficient);
+          slot = probe(key);
+        }
+        keys_[slot] = key;
+        occupied_[slot] = 1;
+        num_keys_++;
+      }
+
+      std::forward<Function>(update)(aggregates_[slot]);
+      return aggregates_[slot];
+    }
+
+    /**
+     * Search (lookup) for the aggregate.
+     * @param key - value of the key
+     * @return found aggregate or nothing
+     */
+    std::optional<Agg> Search(const K &key) const {
+      const std::size_t slot = probe(key);
+      if (occupied_[slot] == 0) {
+        return std::nullopt;
+      }
+      return aggregates_[slot];
+    }
+
+    bool ContainsKey(const K &key) const {
+      return occupied_[probe(key)] != 0;
+    }
+
+    /**
+     * Combine the aggregates of another table into this one (e.g. a thread-local pre-aggregation).
+     * @param other - table to merge from
+     * @param merge - function (Agg &into, const Agg &from) combining two aggregates of one key
+     */
+    template <typename MergeFunction>
+    void Merge(const AggregateTable &other, MergeFunction merge) {
+      other.ForEach([&](const K &key, const Agg &from) { Upsert(key, [&](Agg &into) { merge(into, from); }); });
+    }
+
+    /**
+     * Call the function (const K &key, const Agg &aggregate) for every key in the slot order.
+     */
+    template <typename Function>
+    void ForEach(Function function) const {
+      for (std::size_t slot = 0; slot < keys_.size(); slot++) {
+        if (occupied_[slot] != 0) {
+          function(keys_[slot], aggregates_[slot]);
+        }
+      }
+    }
+
+    /**
+     * Forget all the keys, keeping the slots allocated.
+     */
+    void clear() {
+      std::fill(occupied_.begin(), occupied_.end(), 0);
+      std::fill(aggregates_.begin(), aggregates_.end(), Agg{});
+      num_keys_ = 0;
+    }
+
+    /**
+     * @return true - the next new key makes the table grow
+     */
+    bool is_full() const {
+      return num_keys_ + 1 > static_cast<int>(capacity() * kLoadFactor);
+    }
+
+    bool empty() const {
+      return num_keys_ == 0;
+    }
+
+    int size() const {
+      return num_keys_;
+    }
+
+    int capacity() const {
+      return static_cast<int>(keys_.size());
+    }
+
+    /**
+     * @return memory taken by the slots
+     */
+    std::size_t bytes_used() const {
+      return keys_.size() * (sizeof(K) + sizeof(std::uint8_t) + sizeof(Agg));
+    }
+  };
+
+  /**
+   * Aggregate rows in parallel: every thread pre-aggregates a contiguous range of the rows into its own table
+   * (no sharing, no locks), and the thread-local tables are merged at the end.
+   *
+   * @param rows - input rows
+   * @param key_of - function (const Row &) -> K
+   * @param update - function (Agg &, const Row &) folding a row into the aggregate of its key
+   * @param merge - function (Agg &into, const Agg &from) combining two aggregates of one key
+   * @param num_threads - number of threads, 0 - one per hardware thread
+   * @return aggregates of all the rows
+   * @throws - the first exception thrown by key_of or update (after every thread has stopped)
+   */
+  template <typename K, typename Agg, typename Hash = FixedHash<K>, typename Row, typename KeyOf, typename Update,
+            typename MergeFunction>
+  AggregateTable<K, Agg, Hash> AggregateParallel(const std::vector<Row> &rows, KeyOf key_of, Update update,
+                                                 MergeFunction merge, int num_threads = 0) {
+    if (num_threads <= 0) {
+      num_threads = static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+    }
+    num_threads = static_cast<int>(std::min<std::size_t>(num_threads, std::max<std::size_t>(rows.size(), 1)));
+
+    // an exception thrown by key_of or update is rethrown here once every thread has stopped
+    std::vector<AggregateTable<K, Agg, Hash>> tables(static_cast<std::size_t>(num_threads));
+    utils::parallel_for(num_threads, [&](int index) {
+      const std::size_t begin = rows.size() * index / num_threads;
+      const std::size_t end = rows.size() * (index + 1) / num_threads;
+      auto &table = tables[index];
+      for (std::size_t row = begin; row < end; row++) {
+        table.Upsert(key_of(rows[row]), [&](Agg &into) { update(into, rows[row]); });
+      }
+    });
+
+    for (int index = 1; index < num_threads; index++) {
+      tables[0].Merge(tables[index], merge);
+    }
+    return std::move(tables[0]);
+  }
+
+  /**
+   * Aggregate table bounded by a memory budget (hybrid hash aggregation).
+   *
+   * Keys are aggregated in memory until the table would have to grow past the budget. Then the partial
+   * aggregates are spilled to temporary partition files (chosen by the hash of the key) and the table starts
+   * over. Finish merges every partition on its own, so only about 1/num_partitions of the distinct keys are in
+   * memory at once; a partition that is still too large (skewed keys) is merged in memory regardless.
+   *
+   * The spilled records are raw bytes, so the key and the aggregate must be trivially copyable.
+   */
+  template <typename K, typename Agg, typename Hash = FixedHash<K>>
+  class SpillingAggregateTable final {
+    static_assert(std::is_trivially_copyable_v<K> && std::is_trivially_copyable_v<Agg>,
+                  "spilled keys and aggregates must be trivially copyable");
+
+   public:
+    // constants
+    static constexpr int kDefaultPartitions = 16;
+
+   private:
+    struct FileCloser {
+      void operator()(std::FILE *file) const {
+        std::fclose(file);
+      }
+    };
+
+    // struct members
+    AggregateTable<K, Agg, Hash> table_;
+    const std::size_t memory_budget_;
+    const int num_partitions_;
+    int num_spills_{0};
+    std::vector<std::unique_ptr<std::FILE, FileCloser>> partitions_;  // empty until the first spill
+
+    int partition_of(const K &key) const {
+      // remix the hash, the table indexes its slots by the low bits already
+      const auto hash = static_cast<std::uint64_t>(Hash{}(key)) * 11400714819323198485ULL;
+      return static_cast<int>((hash >> 32U) % static_cast<std::uint64_t>(num_partitions_));
+    }
+
+    void spill() {
+      if (partitions_.empty()) {
+        for (int index = 0; index < num_partitions_; index++) {
+          partitions_.emplace_back(std::tmpfile());
+          if (partitions_.back() == nullptr) {
+            partitions_.clear();
+            throw std::runtime_error("failed to create an aggregate partition file");
+          }
+        }
+      }
+
+      bool is_written = true;
+      table_.ForEach([&](const K &key, const Agg &aggregate) {
+        std::FILE *file = partitions_[partition_of(key)].get();
+        is_written = is_written && std::fwrite(&key, sizeof(K), 1, file) == 1
+                  && std::fwrite(&aggregate, sizeof(Agg), 1, file) == 1;
+      });
+      if (!is_written) {
+        throw std::runtime_error("failed to spill aggregates");
+      }
+
+      table_.clear();
+    }
+
+   public:
+    /**
+     * @param memory_budget - maximum size of the in-memory table in bytes
+     * @param num_partitions - number of partition files to spill to
+     * @throws std::logic_error - if the budget or the number of partitions is not positive
+     */
+    explicit SpillingAggregateTable(std::size_t memory_budget, int num_partitions = kDefaultPartitions)
+        : memory_budget_{memory_budget}, num_partitions_{num_partitions} {
+      if (memory_budget == 0) {
+        throw std::logic_error("aggregate memory budget must be greater than zero");
+      }
+      if (num_partitions <= 0) {
+        throw std::logic_error("number of aggregate partitions must be greater than zero");
+      }
+    }
+
+    /**
+     * Create-or-update the aggregate of the key, spilling the table first if it would outgrow the budget.
+     * @param key - value of the key
+     * @param update - function called with the aggregate (value-initialized for a new key)
+     * @throws std::runtime_error - if spilling fails
+     */
+    template <typename Function>
+    void Upsert(const K &key, Function &&update) {
+      // the extra lookup happens only for the one key that finds the table full
+      if (table_.is_full() && table_.bytes_used() * AggregateTable<K, Agg, Hash>::kGrowthCoefficient > memory_budget_
+          && !table_.ContainsKey(key)) {
+        spill();
+        num_spills_++;
+      }
+      table_.Upsert(key, std::forward<Function>(update));
+    }
+
+    /**
+     * Emit the final aggregate of every key exactly once and reset the table.
+     * @param merge - function (Agg &into, const Agg &from) combining the partial aggregates of one key
+     * @param emit - function (const K &key, const Agg &aggregate)
+     * @throws std::runtime_error - if reading the spilled aggregates back fails
+     */
+    template <typename MergeFunction, typename Function>
+    void Finish(MergeFunction merge, Function emit) {
+      if (partitions_.empty()) {
+        table_.ForEach(emit);
+        table_.clear();
+        return;
+      }
+
+      spill();
+      for (auto &partition : partitions_) {
+        std::FILE *file = partition.get();
+        std::rewind(file);
+
+        K key;
+        Agg from;
+        while (std::fread(&key, sizeof(K), 1, file) == 1) {
+          if (std::fread(&from, sizeof(Agg), 1, file) != 1) {
+            throw std::runtime_error("failed to read spilled aggregates");
+          }
+          table_.Upsert(key, [&](Agg &into) { merge(into, from); });
+        }
+        if (std::ferror(file) != 0) {
+          throw std::runtime_error("failed to read spilled aggregates");
+        }
+
+        table_.ForEach(emit);
+        table_.clear();
+        partition.reset();
+      }
+      partitions_.clear();
+    }
+
+    /**
+     * @return number of keys in memory (a key may have partial aggregates spilled as well)
+     */
+    int size() const {
+      return table_.size();
+    }
+
+    /**
+     * @return number of times the table has outgrown the budget and been spilled
+     */
+    int num_spills() const {
+      return num_spills_;
+    }
+
+    std::size_t memory_budget() const {
+      return memory_budget_;
+    }
+
+    int num_partitions() const {
+      return num_partitions_;
+    }
+  };
+
+}  // namespace itis
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include <sys/types.h>  // pid_t
+
+#include "hash_table.hpp"
+
+namespace itis {
+
+  /**
+   * Checkpoints a hash table to a file in a forked child process (BGSAVE-style).
+   *
+   * fork() gives the child a copy-on-write image of the whole address space, so the child serializes the table
+   * exactly as it was at the moment of the call while the parent keeps modifying it; only the pages the parent
+   * writes to are actually copied by the kernel. The child writes to a temporary file, fsyncs it and renames it
+   * over the target (syncing the directory afterwards), so the target always holds a complete checkpoint, even
+   * after a crash or a power loss.
+   *
+   * The parent learns about the completion by polling; the callback is invoked from Poll or Wait.
+   * Other threads must not modify the table while BackgroundSave forks.
+   */
+  class BackgroundSaver final {
+   public:
+    enum class Status {
+      kIdle,        // no save has been started yet
+      kInProgress,  // the child is still writing
+      kSucceeded,   // the last save completed
+      kFailed       // the last save could not be written
+    };
+
+    using Callback = std::function<void(Status)>;
+
+   private:
+    // struct members
+    pid_t child_{-1};  // pid of the saving process (-1 - no save in progress)
+    Status status_{Status::kIdle};
+    Callback callback_;
+
+    /**
+     * Reap the child and report the result.
+     * @param wait_status - status returned by waitpid
+     */
+    void complete(int wait_status);
+
+   public:
+    BackgroundSaver() = default;
+
+    BackgroundSaver(const BackgroundSaver &) = delete;
+    BackgroundSaver &operator=(const BackgroundSaver &) = delete;
+
+    /**
+     * Wait for the save in progress, if any.
+     */
+    ~BackgroundSaver();
+
+    /**
+     * Start saving the table in a child process and return immediately.
+     * @param table - table to save (its current state is saved, later changes are not)
+     * @param path - file to write (replaced atomically on success)
+     * @param callback - invoked with kSucceeded or kFailed once the completion is observed
+     * @throws std::logic_error - if another save is still in progress
+     * @throws std::runtime_error - if the process cannot be forked
+     */
+    void BackgroundSave(const HashTable &table, const std::string &path, Callback callback = {});
+
+    /**
+     * Check (without blocking) whether the save has completed.
+     * @return current status
+     */
+    Status Poll();
+
+    /**
+     * Block until the save in progress (if any) completes.
+     * @return final status
+     */
+    Status Wait();
+
+    /**
+     * @return status as of the last Poll or Wait
+     */
+    Status status() const;
+  };
+
+}  // namespace itis
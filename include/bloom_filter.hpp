@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Split-block Bloom filter over int keys.
+   *
+   * A key maps to one 256-bit block (half of a cache line) and sets one bit in each of its eight 32-bit words,
+   * so both Insert and MayContain touch a single cache line and the eight bit tests are independent
+   * (the loops vectorize into a couple of SIMD instructions).
+   */
+  class BloomFilter final {
+   public:
+    // constants
+    static constexpr int kWordsPerBlock = 8;
+
+   private:
+    struct alignas(32) Block {
+      std::uint32_t words[kWordsPerBlock]{};
+    };
+
+    std::vector<Block> blocks_;
+
+    /**
+     * @return 64-bit hash of the key: the upper half selects the block, the lower half - the bits inside it
+     */
+    static std::uint64_t mix(int key);
+
+    int block_index(std::uint64_t hash) const;
+
+    static void masks(std::uint64_t hash, std::uint32_t (&masks)[kWordsPerBlock]);
+
+   public:
+    /**
+     * Construct an empty filter sized for the given number of keys.
+     * @param expected_keys - number of keys the filter is going to hold
+     * @param false_positive_rate - target probability that MayContain returns true for an absent key (0...1)
+     */
+    BloomFilter(int expected_keys, double false_positive_rate);
+
+    void Insert(int key);
+
+    /**
+     * @param key - value of the key
+     * @return false - the key has definitely not been inserted, true - it might have been
+     */
+    bool MayContain(int key) const;
+
+    /**
+     * Remove all the keys.
+     */
+    void Clear();
+
+    /**
+     * @return size of the filter in bytes
+     */
+    int bytes() const;
+
+    /**
+     * Estimate the false positive rate of a filter with the given number of bits per key.
+     * @param bits_per_key - size of the filter divided by the number of keys
+     * @return probability of a false positive
+     */
+    static double EstimateFalsePositiveRate(double bits_per_key);
+  };
+
+}  // namespace itis
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+#include "hash_table.hpp"
+
+namespace itis {
+
+  struct BulkLoadOptions {
+    char delimiter{'\t'};  // separates the key from the value ('\t' - TSV, ',' - CSV without quoting)
+    int num_threads{0};    // threads parsing the chunks of the file, 0 - one per hardware thread
+  };
+
+  /**
+   * Load a hash table from a text file of "key<delimiter>value" lines.
+   *
+   * The file is memory-mapped and split into chunks at line boundaries, the chunks are parsed in parallel
+   * (memchr finds the line ends and delimiters with SIMD, std::from_chars parses the keys), and the pairs are
+   * put in the file order into a table presized for all of them, so it never rehashes while loading.
+   * Empty lines are skipped, a trailing '\r' is dropped, a repeated key keeps its last value.
+   *
+   * @param path - path to the file
+   * @param options - format and parallelism
+   * @return loaded table
+   * @throws std::runtime_error - if the file cannot be read or a line is malformed (reported with its number)
+   */
+  HashTable LoadKeyValueFile(const std::string &path, const BulkLoadOptions &options = {});
+
+}  // namespace itis
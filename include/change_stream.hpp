@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Mutation of a hash table delivered to its subscribers.
+   */
+  struct ChangeEvent {
+    enum class Type : std::uint8_t { kPut, kRemove };
+
+    Type type{Type::kPut};
+    int key{0};
+    std::string value;          // new value of kPut, removed value of kRemove
+    std::uint64_t sequence{0};  // number of the mutation in the stream, a gap means lost events
+  };
+
+  /**
+   * Bounded lock-free ring buffer of change events between a table (the producer) and one consumer thread.
+   *
+   * Every slot carries a turn counter (Vyukov's bounded queue): a slot is written only when its turn says it is
+   * free and read only when its turn says it is full, so the producer and the consumer never touch the same event
+   * at once. When the buffer is full the overflow policy decides what happens to a new event:
+   *  - kDrop: the new event is lost;
+   *  - kBlock: the producer waits for the consumer (the table's writer stalls, nothing is lost) until the stream
+   *    is closed or the consumer releases it;
+   *  - kOverwrite: the oldest unconsumed event is discarded to make room (the consumer sees the latest changes).
+   * Lost events are counted and show up as gaps in the sequence numbers.
+   */
+  class ChangeStream final : public std::enable_shared_from_this<ChangeStream> {
+   public:
+    // constants
+    static constexpr std::size_t kDefaultCapacity = 4096;
+
+    enum class OverflowPolicy { kDrop, kBlock, kOverwrite };
+
+   private:
+    struct Slot {
+      std::atomic<std::uint64_t> turn{0};  // position + 1 - the event is ready, position + capacity - free again
+      ChangeEvent event;
+    };
+
+    // struct members
+    std::unique_ptr<Slot[]> slots_;
+    const std::size_t capacity_;
+    const OverflowPolicy policy_;
+    std::uint64_t next_sequence_{1};  // written by the producer only
+
+    alignas(64) std::atomic<std::uint64_t> tail_{0};  // next position to write
+    alignas(64) std::atomic<std::uint64_t> head_{0};  // next position to read (the producer moves it on overwrite)
+    alignas(64) std::atomic<std::uint64_t> num_lost_{0};
+    std::atomic<bool> is_closed_{false};
+
+    /**
+     * @return false - if the buffer is full (the event is not moved from)
+     */
+    bool try_push(ChangeEvent &event);
+
+    /**
+     * @return false - if the buffer is empty
+     */
+    bool try_pop(ChangeEvent &event);
+
+    /**
+     * @return true - if the stream is shared and the producer holds the last reference (nobody can consume)
+     */
+    bool is_abandoned() const;
+
+   public:
+    /**
+     * @param capacity - maximum number of buffered events (rounded up to a power of two)
+     * @param policy - what to do with an event that does not fit
+     * @throws std::logic_error - if the capacity is zero
+     */
+    explicit ChangeStream(std::size_t capacity = kDefaultCapacity, OverflowPolicy policy = OverflowPolicy::kDrop);
+
+    ChangeStream(const ChangeStream &) = delete;
+    ChangeStream &operator=(const ChangeStream &) = delete;
+
+    /**
+     * Deliver a mutation to the consumer (producer side, called by the table).
+     * Under kBlock the call waits while the buffer is full, unless the stream is closed or the caller (the table
+     * holds a reference while publishing) owns the last reference to it; the event is counted as lost then.
+     * @param type - kind of the mutation
+     * @param key - mutated key
+     * @param value - new (kPut) or removed (kRemove) value
+     */
+    void Publish(ChangeEvent::Type type, int key, const std::string &value);
+
+    /**
+     * Take the buffered events without blocking (consumer side).
+     * @param batch - vector to append the events to (in the order of the mutations)
+     * @param max_events - maximum number of events to take
+     * @return number of the appended events
+     */
+    std::size_t Consume(std::vector<ChangeEvent> &batch, std::size_t max_events = kDefaultCapacity);
+
+    /**
+     * Stop the subscription: the table forgets the stream and a producer blocked on it is released.
+     */
+    void Close();
+
+    bool is_closed() const;
+
+    /**
+     * @return number of the events dropped or overwritten so far
+     */
+    std::uint64_t num_lost() const;
+
+    std::size_t capacity() const;
+
+    OverflowPolicy policy() const;
+  };
+
+}  // namespace itis
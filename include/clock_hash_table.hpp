@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace itis {
+
+  /**
+   * Bounded hash table with CLOCK (second chance) eviction on top of an open addressing slot array.
+   *
+   * Search only sets the reference bit of the found slot (and only if it is not set yet), so lookups never
+   * reorder anything and may run concurrently with each other. Put and Remove require exclusive access.
+   * When the table is full, Put sweeps the clock hand over the slots: referenced entries get their bit cleared,
+   * the first unreferenced entry is evicted.
+   */
+  class ClockHashTable final {
+   public:
+    // constants
+    static constexpr auto kDefaultLoadFactor = 0.75;
+    static constexpr auto kTombstoneHeadroom = 0.25;  // tombstones per max key tolerated before a rehash
+
+   private:
+    enum class SlotState : std::uint8_t { kEmpty, kOccupied, kDeleted };
+
+    // struct members
+    int num_keys_{0};           // number of (unique) keys in the hash table
+    int num_deleted_{0};        // number of tombstones left by removals and evictions
+    int num_evictions_{0};      // number of evicted pairs
+    int num_rehashes_{0};       // number of rehashes dropping the tombstones
+    int hand_{0};               // position of the clock hand
+    const int max_keys_;        // maximum number of entries
+    const double load_factor_;  // ratio of "busy" slots to the total number of slots (0...1]
+
+    std::vector<int> keys_;            // compared while probing
+    std::vector<SlotState> states_;    // state of each slot, checked first at every probe
+    std::vector<std::string> values_;  // read only on a hit
+
+    // reference bits, written by (possibly concurrent) Search calls
+    std::unique_ptr<std::atomic<std::uint8_t>[]> referenced_;
+
+    /**
+     * Compute hash for a given key using modulo operator.
+     * @param key - value of the key
+     * @return hash code (or index) in range [0...capacity)
+     */
+    int hash(int key) const;
+
+    /**
+     * Find the slot occupied by the key.
+     * @param key - value of the key
+     * @return index of the slot or -1 if there is no such key
+     */
+    int find(int key) const;
+
+    /**
+     * Advance the clock hand until an unreferenced entry is found and evict it.
+     */
+    void evict();
+
+    /**
+     * Re-insert all the keys into the slot array, dropping tombstones.
+     */
+    void rehash();
+
+   public:
+    /**
+     * Construct a CLOCK hash table with bounded capacity.
+     * @param max_keys - maximum number of entries
+     * @param load_factor - coefficient of the hash-table fullness
+     */
+    explicit ClockHashTable(int max_keys, double load_factor = kDefaultLoadFactor);
+
+    /**
+     * Search (lookup) for the key-value pair and mark it as recently referenced.
+     * Safe to call concurrently with other Search calls (but not with Put or Remove).
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Puts a new or updates an existing key-value pair, evicting a pair if the table is full.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     */
+    void Put(int key, const std::string &value);
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return removed value associated with the key
+     */
+    std::optional<std::string> Remove(int key);
+
+    /**
+     * Check if there is a key-value pair for the given key (does not set the reference bit).
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key) const;
+
+    /**
+     * @return true - there are no key-value pairs, false - otherwise
+     */
+    bool empty() const;
+
+    /**
+     * @return number of key-value pairs in the hash-table
+     */
+    int size() const;
+
+    /**
+     * @return number of slots in the hash-table
+     */
+    int capacity() const;
+
+    int max_keys() const;
+
+    /**
+     * @return number of pairs evicted since construction
+     */
+    int evictions() const;
+
+    /**
+     * @return number of rehashes since construction (one per kTombstoneHeadroom * max_keys evictions at most)
+     */
+    int rehashes() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>  // pair
+#include <vector>
+
+#include "hash_table.hpp"
+
+namespace itis {
+
+  /**
+   * Hash table for keys that (mostly) fall into a compact range.
+   *
+   * While every key lies in [min_key...max_key], values are stored in an array indexed by (key - min_key)
+   * with an occupancy bitmap, so a lookup is a single indexed load. The first key outside the range
+   * moves all the pairs into an ordinary HashTable, which serves all the following operations.
+   */
+  class DenseKeyHashTable final {
+   public:
+    // constants
+    static constexpr auto kDefaultMinDensity = 0.5;
+    static constexpr std::int64_t kMaxRange = std::int64_t{1} << 22;  // 4M values (128 MiB of empty strings)
+
+   private:
+    // struct members
+    int num_keys_{0};  // number of (unique) keys in the direct-address mode
+    std::int64_t min_key_;
+    std::int64_t max_key_;
+
+    std::vector<std::string> values_;      // values_[key - min_key]
+    std::vector<std::uint64_t> occupied_;  // occupancy bitmap of values_
+    std::optional<HashTable> hashed_;      // set once a key outside the range has arrived
+
+    /**
+     * @return index of the key in the direct-address array or -1 if the key is out of the range
+     */
+    int index(int key) const;
+
+    bool is_occupied(int index) const;
+
+    /**
+     * Move all the pairs into a hash table and leave the direct-address mode.
+     * @param expected_keys - number of keys the hash table is sized for (at least the current ones)
+     */
+    void fall_back(int expected_keys = 0);
+
+   public:
+    /**
+     * Construct a table in the direct-address mode for the given range of keys.
+     * @param min_key - smallest expected key
+     * @param max_key - largest expected key
+     * @throws std::logic_error - if the range is empty or holds more than kMaxRange keys
+     */
+    DenseKeyHashTable(int min_key, int max_key);
+
+    /**
+     * Construct a table from the given pairs, choosing the direct-address mode if the keys are dense enough
+     * and their range holds at most kMaxRange keys.
+     * @param pairs - (key, value) pairs
+     * @param min_density - minimal ratio of the number of keys to the size of their range
+     * @return populated table
+     */
+    static DenseKeyHashTable Detect(const std::vector<std::pair<int, std::string>> &pairs,
+                                    double min_density = kDefaultMinDensity);
+
+    std::optional<std::string> Search(int key) const;
+
+    void Put(int key, const std::string &value);
+
+    std::optional<std::string> Remove(int key);
+
+    bool ContainsKey(int key) const;
+
+    bool empty() const;
+
+    int size() const;
+
+    /**
+     * @return number of slots in the direct-address mode, number of buckets after falling back to hashing
+     */
+    int capacity() const;
+
+    /**
+     * @return true - the table is in the direct-address mode, false - it has fallen back to hashing
+     */
+    bool is_direct() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
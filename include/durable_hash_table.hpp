@@ -0,0 +1,97 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "hash_table.hpp"
+#include "write_ahead_log.hpp"
+
+namespace itis {
+
+  /**
+   * Hash table that survives crashes: the latest snapshot plus a write-ahead log of the mutations since then.
+   *
+   * Every Put and Remove is logged before it is applied. Construction recovers the table by loading
+   * the snapshot and replaying the log; Checkpoint writes a new snapshot and empties the log.
+   * The table is safe to use from several threads; concurrent writers share fsyncs through group commit.
+   */
+  class DurableHashTable final {
+   public:
+    // constants
+    static constexpr int kInitialCapacity = 64;  // capacity of a table without a snapshot
+
+    enum class Durability {
+      kSynchronous,  // Put and Remove return once their record is on disk
+      kBuffered      // records reach the disk in groups (when the log buffer fills up or on Sync)
+    };
+
+   private:
+    // struct members
+    const std::string snapshot_path_;
+    const Durability durability_;
+
+    mutable std::mutex mutex_;  // guards the table and the order of the log records
+    WriteAheadLog log_;
+    HashTable table_;  // recovered from the log, so declared after it
+
+   public:
+    /**
+     * Open a durable hash table, recovering its pairs from the snapshot and the log (if they exist).
+     * @param snapshot_path - file of the snapshot written by Checkpoint
+     * @param log_path - file of the write-ahead log
+     * @param durability - when the mutations become durable
+     * @param group_commit_bytes - size of the log buffer that triggers a flush
+     * @throws std::runtime_error - if the files cannot be read or opened
+     */
+    DurableHashTable(const std::string &snapshot_path, const std::string &log_path,
+                     Durability durability = Durability::kSynchronous,
+                     std::size_t group_commit_bytes = WriteAheadLog::kDefaultGroupCommitBytes);
+
+    /**
+     * Load the snapshot (if it exists) and replay the log on top of it.
+     * @param snapshot_path - file of the snapshot written by Checkpoint
+     * @param log - opened log that has not been appended to yet
+     * @return recovered table
+     */
+    static HashTable Recover(const std::string &snapshot_path, WriteAheadLog &log);
+
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Log and apply a new or updated key-value pair.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     * @throws std::logic_error - if the value is 4 GiB or longer (neither logged nor applied)
+     */
+    void Put(int key, const std::string &value);
+
+    /**
+     * Log and apply the removal of a key (nothing is logged if there is no such key).
+     * @param key - value of the key
+     * @return removed value associated with the key
+     */
+    std::optional<std::string> Remove(int key);
+
+    bool ContainsKey(int key) const;
+
+    int size() const;
+
+    /**
+     * Make every mutation durable (needed in the buffered mode only).
+     */
+    void Sync();
+
+    /**
+     * Atomically replace the snapshot with the current pairs and empty the log.
+     * @throws std::runtime_error - if the snapshot cannot be written
+     */
+    void Checkpoint();
+
+    /**
+     * @return number of log fsyncs so far
+     */
+    std::uint64_t num_syncs() const;
+  };
+
+}  // namespace itis
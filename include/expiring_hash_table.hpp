@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "hash_table.hpp"
+#include "time_source.hpp"
+#include "timer_wheel.hpp"
+
+namespace itis {
+
+  /**
+   * Hash table with optional per-entry time-to-live.
+   *
+   * The deadline of a pair is stored in front of its value, so a lookup probes the table once. Expired entries
+   * are dropped lazily by Search and ContainsKey, and actively by ReclaimExpired, which turns a hierarchical
+   * timer wheel instead of scanning the buckets.
+   */
+  class ExpiringHashTable final {
+   public:
+    // constants
+    static constexpr int kMaxTimersPerPair = 2;  // the wheel is rebuilt when stale timers pile up beyond that
+    static constexpr int kMinTimersToRebuild = 1024;
+
+   private:
+    // struct members
+    HashTable table_;  // key -> deadline (milliseconds, 0 - never expires) followed by the value
+    std::shared_ptr<const TimeSource> time_source_;
+    TimerWheel timers_;  // may hold stale timers of updated or removed keys, they are ignored when fired
+
+    /**
+     * Look the key up, removing it if its time-to-live has passed.
+     * @param key - value of the key
+     * @return stored deadline and value, or nothing if there is no such key or it has expired
+     */
+    std::optional<std::string> find(int key);
+
+    /**
+     * Schedule a timer, rebuilding the wheel from the live deadlines if the stale timers outnumber the pairs.
+     */
+    void schedule(int key, std::chrono::milliseconds deadline);
+
+   public:
+    /**
+     * Construct an expiring hash table of a given capacity and constant load factor.
+     * @param capacity - number of buckets in the hash table
+     * @param time_source - source of the current time
+     * @param load_factor - coefficient of the hash-table fullness
+     */
+    explicit ExpiringHashTable(int capacity,
+                               std::shared_ptr<const TimeSource> time_source = std::make_shared<SteadyTimeSource>(),
+                               double load_factor = HashTable::kDefaultLoadFactor);
+
+    /**
+     * Search (lookup) for the key-value pair, removing it if it has expired.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key);
+
+    /**
+     * Puts a new or updates an existing key-value pair that never expires.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     */
+    void Put(int key, const std::string &value);
+
+    /**
+     * Puts a new or updates an existing key-value pair that expires after the given time.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     * @param ttl - time-to-live of the pair (must be positive)
+     */
+    void Put(int key, const std::string &value, std::chrono::milliseconds ttl);
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return removed value associated with the key (nothing if it has expired)
+     */
+    std::optional<std::string> Remove(int key);
+
+    /**
+     * Check if there is a non-expired key-value pair for the given key.
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key);
+
+    /**
+     * Remove all the pairs whose time-to-live has passed.
+     * @return number of removed pairs
+     */
+    int ReclaimExpired();
+
+    /**
+     * @return true - there are no key-value pairs, false - otherwise
+     */
+    bool empty() const;
+
+    /**
+     * @return number of key-value pairs, including the expired ones that have not been reclaimed yet
+     */
+    int size() const;
+
+    /**
+     * @return number of buckets in the hash-table
+     */
+    int capacity() const;
+
+    /**
+     * @return number of pending timers, including the stale ones
+     */
+    int num_timers() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>  // pair, move
+
+namespace itis {
+
+  /**
+   * Hash function usable in constant expressions: integral keys and string views.
+   */
+  template <typename K, typename = void>
+  struct FixedHash;
+
+  template <typename K>
+  struct FixedHash<K, std::enable_if_t<std::is_integral_v<K>>> {
+    constexpr std::size_t operator()(K key) const {
+      // Fibonacci hashing spreads sequential keys over the slots
+      return static_cast<std::size_t>(static_cast<std::uint64_t>(key) * 11400714819323198485ULL >> 32U);
+    }
+  };
+
+  template <>
+  struct FixedHash<std::string_view> {
+    constexpr std::size_t operator()(std::string_view key) const {
+      // FNV-1a
+      std::uint64_t hash = 14695981039346656037ULL;
+      for (const char symbol : key) {
+        hash = (hash ^ static_cast<unsigned char>(symbol)) * 1099511628211ULL;
+      }
+      return static_cast<std::size_t>(hash);
+    }
+  };
+
+  /**
+   * Hash table of a fixed capacity with all the storage inline (open addressing, linear probing).
+   *
+   * Every operation is constexpr, so a table can be built at compile time and placed into a static:
+   *
+   *   constexpr FixedHashTable<int, std::string_view, 4> kCodes{{200, "OK"}, {404, "Not Found"}};
+   *   static_assert(kCodes.Search(404) == "Not Found");
+   *
+   * The semantics follow itis::HashTable except that the table never grows: putting a new key into a full
+   * table throws std::length_error (a compile error in a constant expression).
+   */
+  template <typename K, typename V, std::size_t N, typename Hash = FixedHash<K>>
+  class FixedHashTable final {
+    static_assert(N > 0, "fixed hash table capacity must be greater than zero");
+
+   private:
+    enum class SlotState : std::uint8_t { kEmpty, kOccupied, kDeleted };
+
+    // struct members
+    std::size_t num_keys_{0};  // number of (unique) keys in the hash table
+
+    std::array<K, N> keys_{};
+    std::array<V, N> values_{};
+    std::array<SlotState, N> states_{};  // all kEmpty
+
+    /**
+     * @return index of the slot occupied by the key or N if there is no such key
+     */
+    constexpr std::size_t find(const K &key) const {
+      std::size_t index = Hash{}(key) % N;
+      for (std::size_t step = 0; step < N && states_[index] != SlotState::kEmpty; step++) {
+        if (states_[index] == SlotState::kOccupied && keys_[index] == key) {
+          return index;
+        }
+        index = index + 1 == N ? 0 : index + 1;
+      }
+      return N;
+    }
+
+   public:
+    constexpr FixedHashTable() = default;
+
+    /**
+     * Construct a hash table from a list of key-value pairs (later pairs override earlier ones).
+     * @param pairs - key-value pairs
+     */
+    constexpr FixedHashTable(std::initializer_list<std::pair<K, V>> pairs) {
+      for (const auto &pair : pairs) {
+        Put(pair.first, pair.second);
+      }
+    }
+
+    /**
+     * Search (lookup) for the key-value pair.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    constexpr std::optional<V> Search(const K &key) const {
+      const std::size_t index = find(key);
+      if (index == N) {
+        return std::nullopt;
+      }
+      return values_[index];
+    }
+
+    /**
+     * Puts a new or updates an existing key-value pair.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     * @throws std::length_error - if the key is new and the table is full
+     */
+    constexpr void Put(const K &key, const V &value) {
+      const std::size_t existing = find(key);
+      if (existing != N) {
+        values_[existing] = value;
+        return;
+      }
+
+      if (num_keys_ == N) {
+        throw std::length_error("fixed hash table is full");
+      }
+
+      std::size_t index = Hash{}(key) % N;
+      while (states_[index] == SlotState::kOccupied) {
+        index = index + 1 == N ? 0 : index + 1;
+      }
+
+      keys_[index] = key;
+      values_[index] = value;
+      states_[index] = SlotState::kOccupied;
+      num_keys_++;
+    }
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return removed value associated with the key
+     */
+    constexpr std::optional<V> Remove(const K &key) {
+      const std::size_t index = find(key);
+      if (index == N) {
+        return std::nullopt;
+      }
+
+      states_[index] = SlotState::kDeleted;
+      num_keys_--;
+      return std::move(values_[index]);
+    }
+
+    constexpr bool ContainsKey(const K &key) const {
+      return find(key) != N;
+    }
+
+    constexpr bool empty() const {
+      return num_keys_ == 0;
+    }
+
+    constexpr int size() const {
+      return static_cast<int>(num_keys_);
+    }
+
+    static constexpr int capacity() {
+      return static_cast<int>(N);
+    }
+  };
+
+}  // namespace itis
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace itis {
+
+  /**
+   * Hash table with open addressing (linear probing) and a structure-of-arrays layout.
+   *
+   * Keys, values and slot states live in three parallel arrays, so a probe sequence only touches the
+   * dense state and key arrays (64 states and 16 int keys per cache line) and a value is read on a hit only.
+   */
+  class FlatHashTable final {
+   public:
+    // constants
+    static constexpr auto kGrowthCoefficient = 2;
+    static constexpr auto kDefaultLoadFactor = 0.75;
+
+   private:
+    enum class SlotState : std::uint8_t { kEmpty, kOccupied, kDeleted };
+
+    // struct members
+    int num_keys_{0};           // number of (unique) keys in the hash table
+    int num_deleted_{0};        // number of tombstones left by removals
+    const double load_factor_;  // ratio of "busy" slots to the total number of slots (0...1]
+
+    std::vector<int> keys_;            // [key1, key2, ...] - compared while probing
+    std::vector<SlotState> states_;    // state of each slot, checked first at every probe
+    std::vector<std::string> values_;  // [value1, value2, ...] - read only on a hit
+
+    /**
+     * Compute hash for a given key using modulo operator.
+     * @param key - value of the key
+     * @return hash code (or index) in range [0...capacity)
+     */
+    int hash(int key) const;
+
+    /**
+     * Find the slot occupied by the key.
+     * @param key - value of the key
+     * @return index of the slot or -1 if there is no such key
+     */
+    int find(int key) const;
+
+    /**
+     * Re-insert all the keys into a table of the given capacity, dropping tombstones.
+     * @param capacity - new number of slots
+     */
+    void rehash(int capacity);
+
+   public:
+    /**
+     * Construct a hash table of a given capacity and constant load factor.
+     * @param capacity - number of slots in the hash table
+     * @param load_factor - coefficient of the hash-table fullness
+     */
+    explicit FlatHashTable(int capacity, double load_factor = kDefaultLoadFactor);
+
+    /**
+     * Search (lookup) for the key-value pair.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Puts a new or updates an existing key-value pair.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     */
+    void Put(int key, const std::string &value);
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return removed value associated with the key
+     */
+    std::optional<std::string> Remove(int key);
+
+    /**
+     * Check if there is a key-value pair for the given key.
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key) const;
+
+    /**
+     * @return true - there are no key-value pairs, false - otherwise
+     */
+    bool empty() const;
+
+    /**
+     * @return number of key-value pairs in the hash-table
+     */
+    int size() const;
+
+    /**
+     * @return number of slots in the hash-table
+     */
+    int capacity() const;
+
+    double load_factor() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
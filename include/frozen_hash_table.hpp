@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <utility>  // pair
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Immutable hash table over a minimal perfect hash function (PTHash-style "hash and displace").
+   *
+   * Keys are split into small buckets; for every bucket a pilot value is chosen so that all of its keys land
+   * in distinct free slots of a table with exactly one slot per key. A lookup computes the bucket, reads its
+   * pilot and probes exactly one slot. Pilots are stored in one byte each, the rare large ones in a sorted
+   * side table; together with the remapped spare positions this is about three bits per key.
+   */
+  class FrozenHashTable final {
+   public:
+    // constants
+    static constexpr int kAverageBucketSize = 3;           // keys per pilot bucket
+    static constexpr double kLoadFactor = 0.995;           // keys per position of the pilot search
+    static constexpr std::uint8_t kLargePilot = 0xFF;      // the pilot is stored in the side table
+    static constexpr std::uint32_t kMaxPilot = 1U << 30U;  // give up if a bucket cannot be placed
+
+   private:
+    // struct members
+    std::uint64_t seed_{0};
+    std::vector<std::uint8_t> pilots_;                                   // pilot of each bucket (or kLargePilot)
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> large_pilots_;  // sorted (bucket, pilot) pairs
+    std::vector<std::uint32_t> remap_;                                   // slots of the positions past the end
+
+    std::vector<int> keys_;               // key stored in each slot
+    std::vector<std::uint64_t> offsets_;  // value of slot i is data_[offsets_[i]...offsets_[i + 1])
+    std::string data_;                    // all the values, one after another
+
+    FrozenHashTable() = default;
+
+    int bucket(int key) const;
+
+    std::uint32_t pilot(int bucket) const;
+
+    /**
+     * @return slot of the key for the given pilot
+     */
+    int position(int key, std::uint32_t pilot) const;
+
+    /**
+     * @return slot the key would be stored in
+     */
+    int slot(int key) const;
+
+   public:
+    /**
+     * Build a frozen hash table.
+     * @param pairs - key-value pairs with unique keys
+     * @throws std::logic_error - if the keys are not unique
+     */
+    explicit FrozenHashTable(const std::vector<std::pair<int, std::string>> &pairs);
+
+    /**
+     * Search (lookup) for the key-value pair.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key) const;
+
+    bool ContainsKey(int key) const;
+
+    bool empty() const;
+
+    int size() const;
+
+    /**
+     * @return size of the perfect hash function (pilots) in bits per key
+     */
+    double bits_per_key() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+
+    /**
+     * Write the table in a binary format (host byte order).
+     * @param output - stream to write to
+     */
+    void Save(std::ostream &output) const;
+
+    /**
+     * Read a table written by Save.
+     * @param input - stream to read from
+     * @return loaded table
+     * @throws std::runtime_error - if the stream does not contain a valid table
+     */
+    static FrozenHashTable Load(std::istream &input);
+  };
+
+}  // namespace itis
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>  // pair
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Pair of joined rows: a probe key and one build row with the same key.
+   */
+  struct JoinMatch {
+    std::size_t probe_index{0};  // position of the key in the probed vector
+    int key{0};
+    std::string_view payload;  // payload of the build row (points into the HashJoin)
+  };
+
+  /**
+   * Build side of an equi-join on int keys (duplicate keys allowed), probed with vectors of keys.
+   *
+   * The build rows are radix-partitioned by the high bits of their hash, and every partition gets its own
+   * bucket-chained table that fits into the L2 cache, so building a partition never misses the cache on its
+   * bucket heads. The partitions are independent and are built in parallel. Probing walks the chains of the
+   * partitioned tables, prefetching the bucket heads of the keys a few positions ahead, and hands the matches
+   * to a callback in batches instead of one at a time.
+   *
+   * The table is immutable once built, so it can be probed from any number of threads.
+   */
+  class HashJoin final {
+   public:
+    // constants
+    static constexpr int kAutoRadixBits = -1;                   // choose the number of partitions from the build size
+    static constexpr int kMaxRadixBits = 14;                    // at most 16384 partitions
+    static constexpr std::size_t kPartitionBytes = 256 * 1024;  // target size of the table of one partition
+    static constexpr std::size_t kDefaultBatchSize = 1024;
+    static constexpr int kProbePrefetchDistance = 8;
+
+    using BatchCallback = std::function<void(const std::vector<JoinMatch> &)>;
+    using ParallelBatchCallback = std::function<void(int thread, const std::vector<JoinMatch> &)>;
+
+   private:
+    struct Partition {
+      std::uint32_t begin{0};         // first row of the partition
+      std::uint32_t end{0};           // row after the last one
+      std::uint32_t heads_offset{0};  // first bucket of the partition in heads_
+      int bucket_bits{0};             // the partition has 2^bucket_bits buckets
+    };
+
+    // struct members
+    int radix_bits_{0};
+    std::vector<Partition> partitions_;
+    std::vector<std::uint32_t> heads_;   // first row of every bucket (UINT32_MAX - empty bucket)
+    std::vector<std::uint32_t> next_;    // next row of the same bucket
+    std::vector<int> keys_;              // build keys grouped by partition
+    std::vector<std::string> payloads_;  // build payloads in the same order
+
+    /**
+     * @return index of the bucket head of the key in heads_
+     */
+    std::size_t head_of(std::uint64_t hash) const;
+
+    /**
+     * Link the rows of the partition into its buckets.
+     */
+    void build(Partition &partition);
+
+    /**
+     * Probe keys[begin...end) and emit the matches in batches.
+     * @return number of the matches
+     */
+    std::size_t probe(const std::vector<int> &keys, std::size_t begin, std::size_t end, std::size_t batch_size,
+                      const BatchCallback &emit) const;
+
+   public:
+    /**
+     * Build the join table from the rows of one relation.
+     * @param relation - (key, payload) rows, the payloads are moved into the table
+     * @param num_threads - threads building the partitions, 0 - one per hardware thread
+     * @param radix_bits - the rows are split into 2^radix_bits partitions (kAutoRadixBits - by the build size)
+     * @throws std::logic_error - if the radix bits are out of range or there are too many rows
+     */
+    explicit HashJoin(std::vector<std::pair<int, std::string>> relation, int num_threads = 1,
+                      int radix_bits = kAutoRadixBits);
+
+    /**
+     * Find the build rows matching every key.
+     * @param keys - probe keys
+     * @param emit - called with every full batch of matches and with the last partial one
+     * @param batch_size - maximum number of matches in a batch
+     * @return number of the matches
+     * @throws std::logic_error - if the batch size is zero
+     */
+    std::size_t Probe(const std::vector<int> &keys, const BatchCallback &emit,
+                      std::size_t batch_size = kDefaultBatchSize) const;
+
+    /**
+     * Find the build rows matching every key, every thread probing a contiguous range of the keys.
+     * @param keys - probe keys
+     * @param emit - called from the probing threads (concurrently) with the index of the thread and a batch,
+     *               the batches of one thread follow the order of the keys
+     * @param num_threads - number of threads, 0 - one per hardware thread
+     * @param batch_size - maximum number of matches in a batch
+     * @return number of the matches
+     * @throws std::logic_error - if the batch size is zero
+     * @throws - the first exception thrown by emit (after every thread has stopped)
+     */
+    std::size_t ProbeParallel(const std::vector<int> &keys, const ParallelBatchCallback &emit, int num_threads = 0,
+                              std::size_t batch_size = kDefaultBatchSize) const;
+
+    /**
+     * @return number of the build rows
+     */
+    int size() const;
+
+    int num_partitions() const;
+
+    int radix_bits() const;
+  };
+
+}  // namespace itis
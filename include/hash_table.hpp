@@ -1,35 +1,126 @@
 #pragma once
 
-#include <list>
+#include <istream>
+#include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
-#include <utility>  // pair
 #include <vector>
 #include <unordered_set>
 
+#include "bloom_filter.hpp"
+#include "change_stream.hpp"
+#include "frozen_hash_table.hpp"
+
 namespace itis {
 
   namespace utils {
     inline int hash(int key, int table_size) {
-      return key % table_size;
+      const int index = key % table_size;
+      return index < 0 ? index + table_size : index;  // negative keys
     }
   }  // namespace utils
 
+  class HashTableSnapshot;
+
+  /**
+   * Separate-chaining hash table with int keys and string values.
+   *
+   * The const methods only read the table, so they can be called from several threads at once as long as nobody
+   * writes. Reordering the chains (see set_chain_ordering) and filling the hot-key cache (see EnableHotKeyCache)
+   * are writes: only the non-const Search, SearchBatch and ContainsKey do them, the const ones bypass both.
+   */
   class HashTable final {
+    friend class HashTableSnapshot;
+
    public:
     // constants
     static constexpr auto kGrowthCoefficient = 2;
     static constexpr auto kDefaultLoadFactor = 0.75;
 
+    // how a bucket chain is reorganized after a successful search
+    enum class ChainOrdering {
+      kInsertion,    // keep the chain as is
+      kMoveToFront,  // move the found pair to the head of the chain
+      kTranspose     // exchange the found pair with its predecessor
+    };
+
+    // hit/miss counters of the hot-key cache
+    struct HotKeyCacheStats {
+      long long hits{0};
+      long long misses{0};
+
+      double hit_rate() const {
+        return hits + misses == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+      }
+    };
+
    private:
-    // [(key1, value1), (key2, value2), ...]
-    using Bucket = std::list<std::pair<int, std::string>>;
+    // part of a bucket chain: the keys share one cache line and are compared with a single SIMD instruction
+    struct alignas(64) BucketBlock {
+      static constexpr int kCapacity = 8;
+
+      int keys[kCapacity]{};          // [key1, key2, ...]
+      int size{0};                    // number of occupied slots
+      std::string values[kCapacity];  // [value1, value2, ...]
+    };
+
+    // [block1, block2, ...] - every block except the last one is full
+    using Bucket = std::vector<BucketBlock>;
+
+    // buckets are grouped into pages shared by the table and its snapshots until one of them writes (copy-on-write)
+    static constexpr int kBucketsPerPage = 64;
+
+    // SearchBatch looks this many keys ahead: the bucket headers two distances ahead, their first blocks one distance
+    static constexpr int kBatchPrefetchDistance = 8;
+    using Page = std::vector<Bucket>;
+    using PageTable = std::vector<std::shared_ptr<Page>>;
+
+    // entry of the hot-key cache: remembers where the key was found the last time
+    struct HotKeyCacheSlot {
+      int key{0};
+      int bucket{-1};   // index of the bucket, -1 - the slot is empty
+      int position{0};  // position of the key inside the bucket
+    };
+
+    // change streams of the subscribers; a copy of the table starts without subscribers
+    struct Subscribers {
+      std::vector<std::weak_ptr<ChangeStream>> streams;
+
+      Subscribers() = default;
+
+      Subscribers(const Subscribers & /* other */) {}
+
+      Subscribers(Subscribers &&other) noexcept = default;
+
+      Subscribers &operator=(const Subscribers & /* other */) {
+        return *this;
+      }
+
+      Subscribers &operator=(Subscribers &&other) noexcept = default;
+    };
 
     // struct members
     int num_keys_{0};           // number of (unique) keys in the hash table
     const double load_factor_;  // ratio of "busy" buckets to the total number of buckets [0...1]
 
-    std::vector<Bucket> buckets_;  // array of hash table buckets
+    ChainOrdering chain_ordering_{ChainOrdering::kInsertion};
+
+    int capacity_;  // number of buckets
+
+    // pages of hash table buckets
+    std::shared_ptr<PageTable> pages_;
+
+    // direct-mapped cache in front of the buckets, used by the non-const searches (empty - the cache is disabled)
+    std::vector<HotKeyCacheSlot> hot_keys_;
+    HotKeyCacheStats hot_key_stats_;
+
+    // filter answering most lookups of absent keys without touching the buckets (empty - disabled)
+    std::optional<BloomFilter> bloom_filter_;
+    double bloom_false_positive_rate_{0.0};
+    int bloom_removals_{0};  // keys removed since the filter was built (they still set its bits)
+
+    Subscribers subscribers_;
 
     /**
      * Compute hash for a given key using modulo operator.
@@ -38,6 +129,118 @@ namespace itis {
     */
     int hash(int key) const;
 
+    /**
+     * Find the slot of the key inside a block.
+     * @param block - block of a bucket chain
+     * @param key - value of the key
+     * @return index of the slot or -1 if there is no such key in the block
+     */
+    static int find(const BucketBlock &block, int key);
+
+    /**
+     * Find position of the key inside a bucket.
+     * @param bucket - chain of blocks
+     * @param key - value of the key
+     * @return (block index * BucketBlock::kCapacity + slot index) or -1 if there is no such key
+     */
+    static int find(const Bucket &bucket, int key);
+
+    /**
+     * Allocate empty pages for the given number of buckets.
+     */
+    static std::shared_ptr<PageTable> make_pages(int capacity);
+
+    /**
+     * Call the function for every block of every bucket.
+     */
+    template <typename Function>
+    static void for_each_block(const PageTable &pages, Function function) {
+      for (const auto &page : pages) {
+        for (const auto &bucket : *page) {
+          for (const auto &block : bucket) {
+            function(block);
+          }
+        }
+      }
+    }
+
+    /**
+     * @return bucket for reading
+     */
+    const Bucket &bucket(int index) const;
+
+    /**
+     * Copy the page of the bucket (and the page table) first if they are shared with a snapshot.
+     * @return bucket for writing
+     */
+    Bucket &mutable_bucket(int index);
+
+    /**
+     * Find position of the key inside its bucket, consulting the hot-key cache first (if enabled).
+     * @param index - index of the bucket of the key
+     * @param key - value of the key
+     * @return position of the key or -1 if there is no such key
+     */
+    int locate(int index, int key);
+
+    /**
+     * Lookup the value of the key without reordering its chain or touching the hot-key cache.
+     * @param key - value of the key
+     * @return pointer to the stored value or nullptr if there is no such key
+     */
+    const std::string *lookup(int key) const;
+
+    /**
+     * Lookup the value of the key through the hot-key cache and reorder its chain according to the chain ordering.
+     * @param key - value of the key
+     * @return pointer to the stored value or nullptr if there is no such key
+     */
+    const std::string *lookup(int key);
+
+    /**
+     * Lookup many keys, prefetching the buckets of the next keys (shared by both SearchBatch overloads).
+     * @param table - this table, const or not, which decides whether the chains are reordered
+     */
+    template <typename Table>
+    static std::vector<std::optional<std::string>> search_batch(Table &table, const std::vector<int> &keys);
+
+    /**
+     * Reorder the bucket chain after the key has been found according to the chain ordering.
+     * @param index - index of the bucket
+     * @param position - position of the found key inside the bucket
+     * @return new position of the found key
+     */
+    int promote(int index, int position);
+
+    /**
+     * @return slot of the hot-key cache the key is mapped to
+     */
+    HotKeyCacheSlot &hot_key_slot(int key);
+
+    /**
+     * Deliver a mutation to the subscribers, forgetting the closed and abandoned streams.
+     */
+    void publish(ChangeEvent::Type type, int key, const std::string &value);
+
+    /**
+     * Redistribute all the pairs among the given number of buckets.
+     * @param capacity - new number of buckets
+     */
+    void rehash(int capacity);
+
+    /**
+     * Build a Bloom filter of the current keys, sized for the current capacity.
+     * @param false_positive_rate - target false positive rate of the filter
+     * @return filter holding every key of the table
+     * @throws std::logic_error - if the rate is out of range
+     */
+    BloomFilter build_bloom_filter(double false_positive_rate) const;
+
+    /**
+     * Build the Bloom filter (if enabled) from scratch for the current keys and capacity.
+     */
+    void rebuild_bloom_filter();
+
    public:
     /**
      * Construct a hash table of a given capacity and constant load factor.
@@ -47,12 +250,35 @@ namespace itis {
     explicit HashTable(int capacity, double load_factor = kDefaultLoadFactor);
 
     /**
-     * Search (lookup) for the key-value pair.
+     * Search (lookup) for the key-value pair, reordering the chain of a found key (see set_chain_ordering).
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key);
+
+    /**
+     * Search (lookup) for the key-value pair without reordering the chains.
      * @param key - value of the key
      * @return found value or nothing
      */
     std::optional<std::string> Search(int key) const;
 
+    /**
+     * Search for many keys at once, prefetching the buckets of the next keys while the current one is compared,
+     * so that the cache misses of independent lookups overlap instead of being paid one after another.
+     * Reorders the chains of the found keys (see set_chain_ordering).
+     * @param keys - values of the keys (duplicates are allowed)
+     * @return found values in the order of the keys
+     */
+    std::vector<std::optional<std::string>> SearchBatch(const std::vector<int> &keys);
+
+    /**
+     * Search for many keys at once (see above) without reordering the chains.
+     * @param keys - values of the keys (duplicates are allowed)
+     * @return found values in the order of the keys
+     */
+    std::vector<std::optional<std::string>> SearchBatch(const std::vector<int> &keys) const;
+
     /**
      * Puts a new or updates an existing key-value pair.
      * @param key - value of the key
@@ -68,7 +294,14 @@ namespace itis {
     std::optional<std::string> Remove(int key);
 
     /**
-     * Check if there is a key-value pair for the given key.
+     * Check if there is a key-value pair for the given key, reordering the chain of a found key.
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key);
+
+    /**
+     * Check if there is a key-value pair for the given key without reordering the chains.
      * @param key - value of the key
      * @return true - if there is a pair with the key, false - otherwise
      */
@@ -94,6 +327,124 @@ namespace itis {
     std::unordered_set<int> keys() const;
 
     std::vector<std::string> values() const;
+
+    /**
+     * Enable a small direct-mapped cache of the recently found keys in front of the buckets.
+     * Cached positions are validated on every hit, so the cache never returns stale values.
+     * Only the non-const searches use the cache, and they fill it and count its hits: with the cache enabled they
+     * are writes and must not run concurrently with any other access to the table.
+     * @param num_slots - number of cache slots (rounded up to a power of two)
+     */
+    void EnableHotKeyCache(int num_slots);
+
+    /**
+     * Disable the hot-key cache and reset its counters.
+     */
+    void DisableHotKeyCache();
+
+    /**
+     * @return hit/miss counters of the hot-key cache since it was enabled
+     */
+    HotKeyCacheStats hot_key_cache_stats() const;
+
+    /**
+     * Make bucket chains self-organizing, so that frequently searched keys drift to their heads.
+     * Any ordering but kInsertion turns the non-const searches into writes: they must not run concurrently with
+     * any other access to the table. The const searches never reorder the chains.
+     * @param ordering - how a chain is reordered after a successful non-const Search
+     */
+    void set_chain_ordering(ChainOrdering ordering);
+
+    ChainOrdering chain_ordering() const;
+
+    /**
+     * Position of the key inside its bucket chain, i.e. the number of keys a sequential scan compares before it.
+     * @param key - value of the key
+     * @return position of the key or -1 if there is no such key
+     */
+    int ChainPosition(int key) const;
+
+    /**
+     * Enable a Bloom filter in front of the buckets, so that lookups of absent keys mostly skip the chains.
+     * The filter is rebuilt when the table grows and after many removals.
+     * @param false_positive_rate - target rate of absent keys that still go to the buckets (0...1)
+     * @throws std::logic_error - if the rate is out of range (the current filter is kept)
+     */
+    void EnableBloomFilter(double false_positive_rate);
+
+    void DisableBloomFilter();
+
+    /**
+     * @return size of the Bloom filter in bytes (0 - the filter is disabled)
+     */
+    int bloom_filter_bytes() const;
+
+    /**
+     * Build an immutable copy of the table with a minimal perfect hash function (one probe per lookup).
+     * @return frozen hash table with the same key-value pairs
+     */
+    FrozenHashTable Freeze() const;
+
+    /**
+     * Subscribe to the mutations (change data capture): every following Put and every successful Remove is
+     * published to the returned stream until it is closed or released. A copy of the table has no subscribers.
+     * @param capacity - number of events the stream buffers for the consumer
+     * @param policy - what happens to the events when the consumer falls behind
+     * @return stream to consume the events from (on one thread)
+     */
+    std::shared_ptr<ChangeStream> Subscribe(std::size_t capacity = ChangeStream::kDefaultCapacity,
+                                            ChangeStream::OverflowPolicy policy = ChangeStream::OverflowPolicy::kDrop);
+
+    /**
+     * Take a consistent read-only view of the table in O(1).
+     * The table and its snapshots share bucket pages; a write copies only the page it modifies.
+     * @return snapshot of the current key-value pairs
+     */
+    HashTableSnapshot Snapshot() const;
+
+    /**
+     * Write the key-value pairs in a binary format (host byte order).
+     * @param output - stream to write to
+     */
+    void Save(std::ostream &output) const;
+
+    /**
+     * Read a table written by Save.
+     * @param input - stream to read from
+     * @return loaded table (with the saved capacity and load factor)
+     * @throws std::runtime_error - if the stream does not contain a valid table
+     */
+    static HashTable Load(std::istream &input);
+  };
+
+  /**
+   * Read-only view of a hash table at the moment HashTable::Snapshot was called.
+   * Safe to read (and release) from another thread while the table keeps changing: the table copies a page
+   * before writing to it as long as a snapshot shares it, and takes over a page a released snapshot no longer
+   * shares only after an acquire fence, so the snapshot's reads happen before the table's writes.
+   */
+  class HashTableSnapshot final {
+    friend class HashTable;
+
+   private:
+    std::shared_ptr<const HashTable::PageTable> pages_;
+    int capacity_;
+    int num_keys_;
+
+    HashTableSnapshot(std::shared_ptr<const HashTable::PageTable> pages, int capacity, int num_keys);
+
+   public:
+    std::optional<std::string> Search(int key) const;
+
+    bool ContainsKey(int key) const;
+
+    bool empty() const;
+
+    int size() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
   };
 
 }  // namespace itis
\ No newline at end of file
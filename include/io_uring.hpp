@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <linux/io_uring.h>
+
+namespace itis {
+
+  /**
+   * Minimal io_uring instance driven by raw system calls (no liburing dependency).
+   *
+   * Submission queue entries are taken with GetSqe, filled by the caller and submitted in one batch
+   * by SubmitAndWait; completions are consumed with ForEachCqe.
+   */
+  class IoUring final {
+   private:
+    // struct members
+    int fd_{-1};
+
+    void *sq_ring_{nullptr};  // mapping of the submission ring (shared with the completion ring)
+    std::size_t sq_ring_bytes_{0};
+    io_uring_sqe *sqes_{nullptr};
+    std::size_t sqes_bytes_{0};
+
+    unsigned *sq_head_{nullptr};
+    unsigned *sq_tail_{nullptr};
+    unsigned *sq_array_{nullptr};
+    unsigned sq_mask_{0};
+    unsigned sq_entries_{0};
+    unsigned sq_pending_{0};  // entries taken by GetSqe and not submitted yet
+
+    unsigned *cq_head_{nullptr};
+    unsigned *cq_tail_{nullptr};
+    io_uring_cqe *cqes_{nullptr};
+    unsigned cq_mask_{0};
+
+    void release();
+
+   public:
+    /**
+     * Set up the rings.
+     * @param entries - size of the submission queue
+     * @throws std::runtime_error - if io_uring is not available (old kernel, seccomp policy, etc.)
+     */
+    explicit IoUring(unsigned entries);
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    ~IoUring();
+
+    /**
+     * Take a zeroed submission queue entry (submitting the pending ones first if the queue is full).
+     * @return entry to fill
+     * @throws std::runtime_error - if the queue is still full after the submission (the kernel did not consume
+     *                              the entries, e.g. because the completion queue has to be drained first)
+     */
+    io_uring_sqe *GetSqe();
+
+    /**
+     * Submit the pending entries and wait for completions in a single system call.
+     * @param min_completions - number of completions to wait for
+     */
+    void SubmitAndWait(unsigned min_completions);
+
+    /**
+     * Consume every available completion.
+     * @param function - called with each completion queue entry
+     * @return number of the completions consumed
+     */
+    template <typename Function>
+    unsigned ForEachCqe(Function function) {
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      const unsigned count = tail - head;
+
+      for (; head != tail; head++) {
+        function(cqes_[head & cq_mask_]);
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      return count;
+    }
+
+    /**
+     * Register a ring of provided buffers the kernel picks receive buffers from (IOSQE_BUFFER_SELECT).
+     * @param ring - page-aligned memory for the ring
+     * @param entries - number of ring entries (power of two)
+     * @param group - buffer group id
+     * @throws std::runtime_error - if the kernel does not support buffer rings
+     */
+    void RegisterBufferRing(io_uring_buf_ring *ring, unsigned entries, std::uint16_t group);
+
+    int fd() const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>  // msghdr
+#include <sys/uio.h>     // iovec
+
+#include "hash_table.hpp"
+#include "memcached_protocol.hpp"
+
+struct io_uring_buf_ring;
+struct io_uring_cqe;
+
+namespace itis {
+
+  class IoUring;
+
+  /**
+   * Single-threaded key-value server speaking the memcached text protocol on a localhost TCP port.
+   *
+   * Two interchangeable event loops:
+   *  - epoll: non-blocking sockets multiplexed by a level-triggered epoll loop. A connection is watched for input
+   *    until it has a pending response, and for output until the response is sent;
+   *  - io_uring: one multishot accept and one multishot recv per connection stay armed, the kernel picks receive
+   *    buffers from a registered buffer ring, and all the sends prepared while handling a batch of completions are
+   *    submitted together with the wait for the next batch (one system call per loop iteration).
+   *
+   * Either way every pipelined request of a read buffer is served in one pass (see memcached::Process) and all
+   * of their responses leave in one vectored send.
+   *
+   * Backpressure: at most kMaxReadsPerEvent chunks are read per readiness event, so one fast client cannot hold
+   * the loop, and a connection stops being read while kMaxBufferedBytes of input or output are pending
+   * (the io_uring backend cancels its multishot recv and re-arms it once the output drains). Serving stops once
+   * kMaxBufferedBytes of output are pending, and the rest of the received requests are served as it drains.
+   */
+  class KvServer final {
+   public:
+    // constants
+    static constexpr int kDefaultPort = 11211;
+    static constexpr std::size_t kReadChunkBytes = 64 * 1024;
+    static constexpr int kMaxReadsPerEvent = 4;                        // chunks read before serving other sockets
+    static constexpr std::size_t kMaxBufferedBytes = 4 * 1024 * 1024;  // pending input or output of a connection
+    static constexpr unsigned kRingEntries = 1024;                     // io_uring submission queue size
+    static constexpr unsigned kNumBuffers = 256;  // receive buffers in the buffer ring (power of two)
+    static constexpr std::size_t kBufferBytes = 16 * 1024;
+    static constexpr int kMaxIoVectors = 64;  // pieces of the output sent by one sendmsg
+
+    enum class Backend {
+      kAuto,    // io_uring if the kernel supports it, epoll otherwise
+      kEpoll,
+      kIoUring  // the constructor throws if io_uring is not available
+    };
+
+   private:
+    struct Connection {
+      std::string input;         // received bytes that do not form a whole request yet
+      memcached::Output output;  // responses not sent yet
+      bool is_closing{false};    // close once the output is sent
+
+      // io_uring only
+      memcached::Output sending;  // responses of the send in flight (output keeps growing meanwhile)
+      iovec vectors[kMaxIoVectors];  // pieces of sending described to the kernel
+      msghdr message{};              // sendmsg argument pointing to the vectors
+      bool is_receiving{false};   // the multishot recv is armed
+      bool is_cancelling{false};  // the recv is being cancelled because the connection is backlogged
+      bool is_sending{false};     // a send is in flight
+      bool is_shut_down{false};   // shutdown() was called to terminate the recv
+    };
+
+    // struct members
+    HashTable &table_;
+    int listen_fd_{-1};
+    int epoll_fd_{-1};
+    int stop_fd_{-1};  // eventfd that wakes the loop up to stop it
+    int port_{0};
+    bool is_accept_paused_{false};  // out of descriptors, accepting resumes when a connection is closed
+    std::unordered_map<int, Connection> connections_;
+
+    // io_uring backend (the ring is declared last, so it is torn down before the memory it writes to)
+    std::vector<char> buffers_;                   // kNumBuffers receive buffers of kBufferBytes
+    io_uring_buf_ring *buffer_ring_{nullptr};     // mmap-ed ring of the free buffers
+    std::uint16_t buffer_ring_tail_{0};
+    std::uint64_t stop_value_{0};                 // target of the read of stop_fd_
+    std::unique_ptr<IoUring> ring_;
+
+    void accept_connections();
+
+    /**
+     * Serve the complete requests of the input unless the connection is backlogged.
+     */
+    void serve(Connection &connection);
+
+    /**
+     * @return true - the connection has too much pending input or output to read more requests
+     */
+    static bool is_backlogged(const Connection &connection);
+
+    /**
+     * Watch the listening socket again (or re-arm the accept) after running out of descriptors.
+     */
+    void resume_accept();
+
+    /**
+     * Read the available bytes and serve the complete requests.
+     */
+    void receive(int fd, Connection &connection);
+
+    /**
+     * Send as much of the pending output as the socket accepts.
+     * @return false - if the connection is broken
+     */
+    bool send_output(int fd, Connection &connection);
+
+    /**
+     * Watch the connection for input or output depending on whether it has a pending response,
+     * and close it once it is done.
+     */
+    void update(int fd, Connection &connection);
+
+    void close_connection(int fd);
+
+    void close_sockets();
+
+    void run_epoll();
+
+    /**
+     * Set up the io_uring instance and its buffer ring.
+     * @return false - if the kernel does not support them
+     */
+    bool setup_io_uring();
+
+    void run_io_uring();
+
+    /**
+     * @return true - if the completion requests the loop to stop
+     */
+    bool handle_completion(const io_uring_cqe &cqe);
+
+    void submit_accept();
+
+    void submit_recv(int fd);
+
+    /**
+     * Cancel the multishot recv of a backlogged connection (re-armed by submit_send once the output drains).
+     */
+    void submit_cancel_recv(int fd);
+
+    /**
+     * Send the pending output unless a send is already in flight.
+     */
+    void submit_send(int fd, Connection &connection);
+
+    /**
+     * Give a receive buffer back to the kernel.
+     */
+    void recycle_buffer(std::uint16_t id);
+
+    /**
+     * Close the connection once nothing is in flight (shutting it down first to finish the multishot recv).
+     */
+    void finish(int fd, Connection &connection);
+
+   public:
+    /**
+     * Listen on 127.0.0.1.
+     * @param table - table to serve (must outlive the server and be accessed by Run only)
+     * @param port - TCP port (0 - any free port, see port())
+     * @param backend - event loop implementation
+     * @throws std::runtime_error - if the socket cannot be set up or the requested backend is not available
+     */
+    explicit KvServer(HashTable &table, int port = kDefaultPort, Backend backend = Backend::kAuto);
+
+    KvServer(const KvServer &) = delete;
+    KvServer &operator=(const KvServer &) = delete;
+
+    ~KvServer();
+
+    /**
+     * Serve the clients until Stop is called.
+     */
+    void Run();
+
+    /**
+     * Make Run return (safe to call from another thread or a signal handler).
+     */
+    void Stop();
+
+    /**
+     * @return port the server listens on
+     */
+    int port() const;
+
+    /**
+     * @return backend actually used (never kAuto)
+     */
+    Backend backend() const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace itis {
+
+  /**
+   * Bounded hash table with least-recently-used eviction.
+   *
+   * Every entry is a single node threaded on two intrusive lists at once: the chain of its bucket
+   * and the recency list. Search moves the entry to the head of the recency list, Put evicts from its tail.
+   */
+  class LruHashTable final {
+   public:
+    // constants
+    static constexpr auto kDefaultLoadFactor = 0.75;
+    static constexpr std::size_t kUnlimitedBytes = 0;
+
+   private:
+    struct Node {
+      int key;
+      std::string value;
+
+      Node *next_in_bucket{nullptr};  // chain of the bucket
+      Node *prev{nullptr};            // more recently used entry
+      Node *next{nullptr};            // less recently used entry
+    };
+
+    // struct members
+    int num_keys_{0};              // number of (unique) keys in the hash table
+    std::size_t num_bytes_{0};     // total size of the stored values
+    const int max_keys_;           // maximum number of entries
+    const std::size_t max_bytes_;  // maximum total size of the values (kUnlimitedBytes - no limit)
+    const double load_factor_;     // ratio of entries to the total number of buckets (0...1]
+
+    std::vector<Node *> buckets_;  // heads of the bucket chains (presized for max_keys, never rehashed)
+    Node *head_{nullptr};          // most recently used entry
+    Node *tail_{nullptr};          // least recently used entry
+    int num_evictions_{0};
+
+    /**
+     * Compute hash for a given key using modulo operator.
+     * @param key - value of the key
+     * @return hash code (or index) in range [0...capacity)
+     */
+    int hash(int key) const;
+
+    /**
+     * @return node of the key or nullptr if there is no such key
+     */
+    Node *find(int key) const;
+
+    void link_front(Node *node);
+
+    void unlink(Node *node);
+
+    /**
+     * Remove the node from its bucket chain and from the recency list, and free it.
+     */
+    void erase(Node *node);
+
+    /**
+     * Evict the least recently used entries until the limits are satisfied.
+     */
+    void evict();
+
+   public:
+    /**
+     * Construct an LRU hash table with bounded capacity.
+     * @param max_keys - maximum number of entries
+     * @param max_bytes - maximum total size of the values in bytes (kUnlimitedBytes - no limit)
+     * @param load_factor - coefficient of the hash-table fullness
+     */
+    explicit LruHashTable(int max_keys, std::size_t max_bytes = kUnlimitedBytes,
+                          double load_factor = kDefaultLoadFactor);
+
+    LruHashTable(const LruHashTable &) = delete;
+    LruHashTable &operator=(const LruHashTable &) = delete;
+
+    ~LruHashTable();
+
+    /**
+     * Search (lookup) for the key-value pair and mark it as the most recently used.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key);
+
+    /**
+     * Puts a new or updates an existing key-value pair and marks it as the most recently used.
+     * Evicts the least recently used pairs if the limits are exceeded.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     */
+    void Put(int key, const std::string &value);
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return removed value associated with the key
+     */
+    std::optional<std::string> Remove(int key);
+
+    /**
+     * Check if there is a key-value pair for the given key (does not affect the recency order).
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key) const;
+
+    /**
+     * @return true - there are no key-value pairs, false - otherwise
+     */
+    bool empty() const;
+
+    /**
+     * @return number of key-value pairs in the hash-table
+     */
+    int size() const;
+
+    /**
+     * @return number of buckets in the hash-table
+     */
+    int capacity() const;
+
+    int max_keys() const;
+
+    std::size_t max_bytes() const;
+
+    /**
+     * @return total size of the stored values in bytes
+     */
+    std::size_t bytes() const;
+
+    /**
+     * @return number of pairs evicted since construction
+     */
+    int evictions() const;
+
+    std::unordered_set<int> keys() const;
+
+    /**
+     * @return values from the most to the least recently used
+     */
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
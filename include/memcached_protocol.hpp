@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash_table.hpp"
+
+struct iovec;
+
+namespace itis {
+
+  /**
+   * Subset of the memcached text protocol (get, set, delete, version, quit) over a hash table.
+   *
+   * Keys must be decimal integers (e.g. memtier_benchmark --key-prefix=""), flags and expiration time
+   * of set are accepted but not stored.
+   */
+  namespace memcached {
+
+    // constants
+    inline constexpr std::size_t kMaxLineBytes = 2048;         // a longer command line is a protocol error
+    inline constexpr std::size_t kMaxValueBytes = 1024 * 1024;  // same default item size limit as memcached
+
+    enum class Command { kGet, kSet, kDelete, kVersion, kQuit, kError };
+
+    struct Request {
+      Command command{Command::kError};
+      std::vector<int> keys;  // one key for set and delete
+      std::string value;      // data block of set
+      bool noreply{false};
+      std::string error;  // response line of kError (without the line terminator)
+      bool is_fatal{false};  // the stream cannot be resynchronized after the error, close the connection
+    };
+
+    enum class ParseStatus { kIncomplete, kParsed };
+
+    /**
+     * Pending responses of a connection, handed to the socket as one vectored write.
+     *
+     * Status lines and short values are copied into a shared text buffer; long values are moved in as they are,
+     * so they are not copied again between the table lookup and the socket.
+     */
+    class Output final {
+     public:
+      // constants
+      static constexpr std::size_t kMinMovedValueBytes = 512;  // shorter values are cheaper to copy than to gather
+
+     private:
+      // contiguous piece of the output: a range of text_ or a whole moved value
+      struct Segment {
+        std::size_t offset{0};
+        std::size_t size{0};
+        int value{-1};  // index in values_, -1 - the segment is a part of text_
+      };
+
+      // struct members
+      std::string text_;
+      std::vector<std::string> values_;
+      std::vector<Segment> segments_;
+      std::size_t first_segment_{0};  // segments before it have been sent
+      std::size_t first_offset_{0};   // sent bytes of the first segment
+      std::size_t size_{0};           // bytes not sent yet
+
+     public:
+      /**
+       * Append a copy of the text.
+       */
+      void Append(std::string_view text);
+
+      /**
+       * Append a value of a get, taking it over if it is long.
+       */
+      void AppendValue(std::string &&value);
+
+      /**
+       * Describe the unsent bytes for writev/sendmsg (valid until the output is modified).
+       * @param vectors - array to fill
+       * @param max_vectors - size of the array
+       * @return number of the filled vectors
+       */
+      int Gather(iovec *vectors, int max_vectors) const;
+
+      /**
+       * Drop the bytes that have been sent.
+       * @param bytes - number of the sent bytes (at most size())
+       */
+      void Consume(std::size_t bytes);
+
+      void clear();
+
+      bool empty() const;
+
+      /**
+       * @return number of bytes not sent yet
+       */
+      std::size_t size() const;
+
+      /**
+       * @return unsent bytes as one string
+       */
+      std::string str() const;
+    };
+
+    /**
+     * Parse one request from the beginning of the input.
+     * @param input - received bytes
+     * @param request - parsed request (a malformed one is returned as kError)
+     * @param consumed - number of the input bytes the request occupies
+     * @return kIncomplete - the input does not hold a whole request yet, kParsed - otherwise
+     */
+    ParseStatus Parse(std::string_view input, Request &request, std::size_t &consumed);
+
+    /**
+     * Append a VALUE block of a get response.
+     * @param key - found key
+     * @param value - value of the key
+     * @param output - buffer to append the block to
+     */
+    void AppendValue(int key, const std::string &value, std::string &output);
+
+    /**
+     * Apply the request to the table and append its response.
+     * @param request - parsed request
+     * @param table - table to serve
+     * @param output - buffer to append the response to
+     */
+    void Execute(const Request &request, HashTable &table, std::string &output);
+
+    /**
+     * Serve the complete requests at the beginning of the input (a pipeline of requests).
+     * The keys of consecutive gets are looked up together with HashTable::SearchBatch.
+     * No more requests are parsed once the output holds max_output bytes, the rest of the input is left for the
+     * next call (after the client has read its responses), so the output exceeds the limit by one response at most.
+     * @param input - received bytes
+     * @param table - table to serve
+     * @param output - buffer to append the responses to
+     * @param max_output - number of unsent output bytes that stops serving
+     * @param is_closing - set when the client quits or the stream is broken
+     * @return number of the input bytes consumed
+     */
+    std::size_t Process(std::string_view input, HashTable &table, Output &output, std::size_t max_output,
+                        bool &is_closing);
+
+  }  // namespace memcached
+
+}  // namespace itis
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>  // pair
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Persistent (immutable) hash table - a compressed hash array mapped trie (CHAMP layout).
+   *
+   * Every node covers 5 bits of the key hash and stores its pairs and its children in two compact arrays
+   * indexed by the popcount of a 32-bit bitmap. Put and Remove never modify a version: they copy the nodes
+   * on the path to the key and share the rest of the trie with the previous version, so keeping many versions
+   * costs O(log n) nodes per change. A version is never modified after construction, so any number of threads
+   * may read it without locks.
+   *
+   * Keys are hashed with a bijective 32-bit mix, so distinct keys never share a full hash and the trie
+   * needs no collision nodes (at most 7 levels).
+   */
+  class PersistentHashTable final {
+   public:
+    // constants
+    static constexpr int kBitsPerLevel = 5;
+
+   private:
+    struct Node {
+      std::uint32_t data_map{0};                          // fragments with a pair stored in this node
+      std::uint32_t node_map{0};                          // fragments with a child node
+      std::vector<std::pair<int, std::string>> pairs;     // ordered by fragment
+      std::vector<std::shared_ptr<const Node>> children;  // ordered by fragment
+    };
+
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // struct members
+    NodePtr root_;    // never null
+    int num_keys_{0};
+
+    PersistentHashTable(NodePtr root, int num_keys);
+
+    /**
+     * Bijective mix of the key bits (different keys always get different hashes).
+     */
+    static std::uint32_t hash(int key);
+
+    /**
+     * @return pointer to the value of the key or nullptr if there is no such key
+     */
+    const std::string *lookup(int key) const;
+
+    static NodePtr put(const NodePtr &node, int key, std::uint32_t hash, int shift, const std::string &value,
+                       bool &inserted);
+
+    /**
+     * Build the smallest subtree holding two pairs with different hashes.
+     */
+    static NodePtr merge(std::pair<int, std::string> first, std::uint32_t first_hash,
+                         std::pair<int, std::string> second, std::uint32_t second_hash, int shift);
+
+    /**
+     * @return new node without the key (a child left with a single pair is inlined into its parent)
+     */
+    static NodePtr remove(const NodePtr &node, int key, std::uint32_t hash, int shift, bool &removed);
+
+    template <typename Function>
+    static void for_each_pair(const Node &node, Function &function) {
+      for (const auto &pair : node.pairs) {
+        function(pair);
+      }
+      for (const auto &child : node.children) {
+        for_each_pair(*child, function);
+      }
+    }
+
+   public:
+    /**
+     * Construct an empty version.
+     */
+    PersistentHashTable();
+
+    /**
+     * Search (lookup) for the key-value pair.
+     * @param key - value of the key
+     * @return found value or nothing
+     */
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Put a new or update an existing key-value pair.
+     * @param key - value of the key
+     * @param value - data associated with the key
+     * @return new version sharing all the untouched nodes with this one (this version is not changed)
+     */
+    [[nodiscard]] PersistentHashTable Put(int key, const std::string &value) const;
+
+    /**
+     * Remove a key-value pair for the given key.
+     * @param key - value of the key
+     * @return new version without the key (or this version if there is no such key)
+     */
+    [[nodiscard]] PersistentHashTable Remove(int key) const;
+
+    /**
+     * Check if there is a key-value pair for the given key.
+     * @param key - value of the key
+     * @return true - if there is a pair with the key, false - otherwise
+     */
+    bool ContainsKey(int key) const;
+
+    /**
+     * @return true - there are no key-value pairs, false - otherwise
+     */
+    bool empty() const;
+
+    /**
+     * @return number of key-value pairs in this version
+     */
+    int size() const;
+
+    std::unordered_set<int> keys() const;
+
+    std::vector<std::string> values() const;
+  };
+
+}  // namespace itis
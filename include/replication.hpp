@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "hash_table.hpp"
+#include "write_ahead_log.hpp"
+
+namespace itis {
+
+  /**
+   * Log-shipping replication: a primary table streams its mutations to follower tables in other processes.
+   *
+   * Every Put and Remove on the primary gets the next sequence number and is kept in a bounded in-memory log.
+   * A follower connects with the sequence number it has applied so far; the primary replays the log from there,
+   * or sends a snapshot of the whole table first if the follower is too far behind (or new). Afterwards every
+   * mutation is shipped as it happens.
+   *
+   * Sequence numbers only make sense within the history of one primary, so every primary picks a random ID at
+   * construction and sends it with its snapshots. The follower echoes the ID of the primary it has applied
+   * in its hello; a restarted (or different) primary does not recognize it and sends a snapshot.
+   *
+   * The stream is a connected stream socket (socketpair, Unix-domain or TCP). Frames use the host byte order:
+   * type (1 byte), sequence (8), key (4), payload length (4), payload (the value, or the primary ID (8) followed by
+   * the saved table). A snapshot longer than kSnapshotPartBytes is split into several frames, the last of which
+   * completes it.
+   */
+
+  /**
+   * Primary side: owns the authoritative table and ships its mutations.
+   * Not thread-safe (like HashTable); sends never block, a lagging follower is buffered and disconnected
+   * once its backlog of mutations exceeds the limit (it catches up from a snapshot when it reconnects).
+   * The snapshot a follower starts from does not count towards the limit, so a table of any size can be joined.
+   */
+  class ReplicationPrimary final {
+   public:
+    // constants
+    static constexpr std::size_t kDefaultLogRecords = 100'000;          // mutations kept for catching up
+    static constexpr std::size_t kMaxBacklogBytes = 64 * 1024 * 1024;  // unsent mutation bytes of one follower
+    static constexpr std::size_t kSnapshotPartBytes = 16 * 1024 * 1024;  // payload of one snapshot frame
+
+   private:
+    struct Record {
+      std::uint64_t sequence;
+      WriteAheadLog::RecordType type;
+      int key;
+      std::string value;  // empty for kRemove
+    };
+
+    struct Follower {
+      int fd{-1};
+      std::string output;            // frames not sent yet
+      std::size_t output_offset{0};  // sent bytes of output
+      std::size_t snapshot_end{0};   // the snapshot frames take output[0...snapshot_end)
+    };
+
+    // struct members
+    HashTable table_;
+    const std::uint64_t id_;  // random ID of this primary's history (never 0)
+    const std::size_t log_records_;
+    std::deque<Record> log_;      // the latest mutations, log_.back().sequence == sequence_
+    std::uint64_t sequence_{0};  // sequence number of the last mutation
+    std::vector<Follower> followers_;
+
+    /**
+     * Append a mutation to the log and to the output of every follower.
+     */
+    void ship(WriteAheadLog::RecordType type, int key, const std::string &value);
+
+    /**
+     * Send as much of the follower's output as its socket accepts.
+     * @return false - if the follower has to be disconnected
+     */
+    static bool send_output(Follower &follower);
+
+   public:
+    /**
+     * @param capacity - initial number of buckets of the table
+     * @param log_records - number of the latest mutations kept for the followers catching up
+     * @throws std::logic_error - if the capacity or the number of log records is not positive
+     */
+    explicit ReplicationPrimary(int capacity = 1024, std::size_t log_records = kDefaultLogRecords);
+
+    ReplicationPrimary(const ReplicationPrimary &) = delete;
+    ReplicationPrimary &operator=(const ReplicationPrimary &) = delete;
+
+    /**
+     * Disconnect the followers.
+     */
+    ~ReplicationPrimary();
+
+    /**
+     * Put a new or update an existing key-value pair and ship the mutation.
+     * @throws std::logic_error - if the value is 4 GiB or longer (it does not fit a frame)
+     */
+    void Put(int key, const std::string &value);
+
+    std::optional<std::string> Remove(int key);
+
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Start shipping to a follower: read its hello and send what it misses (log records or a snapshot).
+     * @param fd - connected socket (owned by the primary from now on)
+     * @throws std::runtime_error - if the hello cannot be read (the socket is closed)
+     */
+    void AddFollower(int fd);
+
+    /**
+     * Send the buffered frames to the followers whose sockets have room for them.
+     * @return number of the followers still having unsent frames
+     */
+    int Flush();
+
+    /**
+     * @return sequence number of the last mutation
+     */
+    std::uint64_t sequence() const;
+
+    /**
+     * @return number of the connected followers
+     */
+    int num_followers() const;
+
+    /**
+     * @return random ID of the primary (followers of another primary are sent a snapshot)
+     */
+    std::uint64_t id() const;
+
+    const HashTable &table() const;
+  };
+
+  /**
+   * Follower side: applies the shipped mutations to its own table and serves reads only.
+   * Poll is meant for one thread, the read methods are safe to call from others meanwhile.
+   */
+  class ReplicationFollower final {
+   private:
+    // struct members
+    int fd_{-1};
+    std::string input_;     // received bytes that do not form a whole frame yet
+    std::string snapshot_;  // parts of a snapshot whose last frame has not arrived yet
+    std::uint64_t sequence_{0};
+    std::uint64_t primary_id_{0};  // primary whose history has been applied (0 - none yet)
+
+    mutable std::shared_mutex mutex_;  // guards the table: Poll writes, the readers share it
+    std::optional<HashTable> table_;   // replaced as a whole by a snapshot
+
+    /**
+     * Apply the complete frames at the beginning of the input.
+     */
+    void apply();
+
+   public:
+    /**
+     * @param capacity - initial number of buckets of the table
+     */
+    explicit ReplicationFollower(int capacity = 1024);
+
+    ReplicationFollower(const ReplicationFollower &) = delete;
+    ReplicationFollower &operator=(const ReplicationFollower &) = delete;
+
+    ~ReplicationFollower();
+
+    /**
+     * Connect to the primary, asking for the mutations after the last applied one (the previous connection,
+     * if any, is closed). A new follower receives a snapshot first.
+     * @param fd - connected socket (owned by the follower from now on)
+     * @throws std::runtime_error - if the hello cannot be sent
+     */
+    void Connect(int fd);
+
+    /**
+     * Close the connection to the primary (the applied mutations are kept).
+     */
+    void Disconnect();
+
+    /**
+     * Apply the mutations received so far without blocking.
+     * @return false - if the primary has closed the stream (Connect again to resume)
+     * @throws std::runtime_error - if the stream is corrupted or skips a mutation
+     */
+    bool Poll();
+
+    std::optional<std::string> Search(int key) const;
+
+    bool ContainsKey(int key) const;
+
+    int size() const;
+
+    /**
+     * @return sequence number of the last applied mutation
+     */
+    std::uint64_t sequence() const;
+
+    /**
+     * @return ID of the primary the applied mutations come from (0 - none yet)
+     */
+    std::uint64_t primary_id() const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "hash_table.hpp"
+#include "memcached_protocol.hpp"
+#include "spsc_queue.hpp"
+
+namespace itis {
+
+  /**
+   * Thread-per-core memcached-protocol server (shared-nothing, Seastar/Dragonfly style).
+   *
+   * Every worker thread owns one shard - a private HashTable with the keys mapped to it - and an epoll loop
+   * over its own SO_REUSEPORT listening socket, so the kernel spreads the connections across the workers.
+   * A request for a key of another shard is forwarded to the owner over a lock-free SPSC queue and the reply
+   * comes back the same way; nothing on the request path takes a lock. The responses of a connection are sent
+   * in the order of its requests no matter which shards served them.
+   *
+   * Backpressure works as in KvServer: at most kMaxReadsPerEvent chunks are read per readiness event, and a
+   * connection is not read while kMaxBufferedBytes of input or any output are pending.
+   */
+  class ShardedKvServer final {
+   public:
+    // constants
+    static constexpr int kDefaultPort = 11211;
+    static constexpr std::size_t kReadChunkBytes = 64 * 1024;
+    static constexpr int kMaxReadsPerEvent = 4;                        // chunks read before serving other sockets
+    static constexpr std::size_t kMaxBufferedBytes = 4 * 1024 * 1024;  // pending input of a connection
+    static constexpr std::size_t kQueueCapacity = 4096;   // messages in flight to one worker from all the others
+    static constexpr std::size_t kMinQueueCapacity = 64;  // messages in flight between two workers at least
+
+   private:
+    struct Message {
+      enum class Kind : std::uint8_t { kGet, kSet, kDelete, kReply };
+
+      Kind kind{Kind::kReply};
+      bool noreply{false};
+      int origin{0};  // worker to reply to
+      int key{0};
+      std::string value;  // value of kSet, response text of kReply
+      std::uint64_t connection{0};
+      std::uint64_t sequence{0};  // response of the connection the reply belongs to
+      std::uint32_t part{0};      // key of a multi-get
+    };
+
+    // response of one request, complete once every part has been filled in
+    struct Response {
+      std::vector<std::string> parts;
+      std::string suffix;  // e.g. END of a get
+      int outstanding{0};  // parts being served by other shards
+    };
+
+    struct Connection {
+      int fd{-1};
+      std::string input;
+      std::string output;
+      std::size_t output_offset{0};
+      std::uint32_t events{0};  // epoll events the socket is watched for
+      bool is_closing{false};   // close once the responses are sent
+      std::deque<Response> responses;
+      std::uint64_t first_sequence{0};  // sequence number of responses.front()
+    };
+
+    struct Worker {
+      int index{0};
+      HashTable shard{HashTable(1024)};
+      int listen_fd{-1};
+      int epoll_fd{-1};
+      int wake_fd{-1};  // eventfd signalled when messages arrive or the server stops
+      std::thread thread;
+      bool is_accept_paused{false};  // out of descriptors, accepting resumes when a connection is closed
+
+      std::uint64_t next_connection{2};  // 0 and 1 are the epoll tags of the listening socket and wake_fd
+      std::unordered_map<std::uint64_t, Connection> connections;
+      std::vector<std::uint64_t> dirty;  // connections with new responses to send
+
+      std::vector<std::vector<Message>> outboxes;  // messages to the other workers not queued yet
+
+      Worker() = default;
+
+      Worker(const Worker &) = delete;
+      Worker &operator=(const Worker &) = delete;
+
+      /**
+       * Close the sockets of the worker and of its connections (the thread must have been joined).
+       */
+      ~Worker();
+    };
+
+    // struct members
+    const int num_shards_;
+    int port_{0};
+    std::atomic<bool> is_stopping_{false};
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // queues_[from * num_shards_ + to], kQueueCapacity slots are split between the queues to a worker, so the
+    // memory grows linearly with the number of shards rather than quadratically
+    std::vector<std::unique_ptr<SpscQueue<Message>>> queues_;
+
+    SpscQueue<Message> &queue(int from, int to);
+
+    void run(Worker &worker);
+
+    void accept_connections(Worker &worker);
+
+    /**
+     * Read the available bytes (at most kMaxReadsPerEvent chunks) and dispatch the complete requests.
+     */
+    void receive(Worker &worker, std::uint64_t id, Connection &connection);
+
+    /**
+     * Serve the request locally or forward its keys to their shards.
+     */
+    void dispatch(Worker &worker, std::uint64_t id, Connection &connection, const memcached::Request &request);
+
+    /**
+     * Serve a forwarded operation or accept a reply to one.
+     */
+    void handle(Worker &worker, Message &message);
+
+    /**
+     * Move the complete responses to the output and send it.
+     */
+    void flush(Worker &worker, std::uint64_t id);
+
+    /**
+     * Queue the outbox messages and wake their receivers up.
+     * @return true - if some messages did not fit into the queues
+     */
+    bool send_messages(Worker &worker);
+
+    void close_connection(Worker &worker, std::uint64_t id);
+
+   public:
+    /**
+     * Set up the listening sockets of the workers (the workers start with Start).
+     * @param num_shards - number of worker threads and shards
+     * @param port - TCP port on 127.0.0.1 (0 - any free port, see port())
+     * @throws std::logic_error - if the number of shards is not positive
+     * @throws std::runtime_error - if the sockets cannot be set up
+     */
+    explicit ShardedKvServer(int num_shards, int port = kDefaultPort);
+
+    ShardedKvServer(const ShardedKvServer &) = delete;
+    ShardedKvServer &operator=(const ShardedKvServer &) = delete;
+
+    /**
+     * Stop the workers and close the sockets.
+     */
+    ~ShardedKvServer();
+
+    /**
+     * Start the worker threads (each one pinned to a CPU where possible).
+     */
+    void Start();
+
+    /**
+     * Stop the worker threads and wait for them.
+     */
+    void Stop();
+
+    /**
+     * @return shard that owns the key
+     */
+    static int ShardOf(int key, int num_shards);
+
+    int port() const;
+
+    int num_shards() const;
+
+    /**
+     * @return number of keys in the shard (only while the workers are stopped)
+     */
+    int shard_size(int shard) const;
+  };
+
+}  // namespace itis
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+
+namespace itis {
+
+  /**
+   * Hash table placed entirely in a POSIX shared-memory segment, so that one copy serves several processes.
+   *
+   * The bucket array, the chain entries and the value bytes are allocated inside the segment and refer to each
+   * other by offsets from its beginning instead of pointers, because every process maps the segment at its own
+   * address. Free blocks are recycled through per-size-class free lists kept in the segment header.
+   *
+   * Writers are serialized by a process-shared robust mutex in the segment. A process that dies while holding it
+   * does not wedge the others: the next process to lock takes the mutex over, though the operation of the dead
+   * process may be left half-applied. Lookups do not take the mutex: a sequence counter next to it (a seqlock) is
+   * odd while a write is in progress and a lookup is retried if the counter has changed, so readers never block
+   * each other. A lookup that keeps losing to the writers (or finds a dead writer) falls back to the mutex.
+   * A process-shared rwlock would also let the readers run in parallel, but it is not robust: a reader that dies
+   * holding it would block every writer forever.
+   */
+  class SharedHashTable final {
+   public:
+    // constants
+    static constexpr int kGrowthCoefficient = 2;
+    static constexpr double kLoadFactor = 0.75;
+    static constexpr std::size_t kDefaultSegmentBytes = 64 * 1024 * 1024;
+
+   private:
+    struct Header;
+
+    // struct members
+    std::string name_;
+    Header *header_{nullptr};  // beginning of the mapped segment
+    std::size_t segment_bytes_{0};
+
+    SharedHashTable(std::string name, void *segment, std::size_t segment_bytes);
+
+    /**
+     * @return address of the object at the offset inside the segment
+     */
+    template <typename T>
+    T *at(std::uint64_t offset) const {
+      return reinterpret_cast<T *>(reinterpret_cast<char *>(header_) + offset);
+    }
+
+    /**
+     * Take a block of at least the given size from the free lists or the unused tail of the segment.
+     * @return offset of the block or 0 if the segment is full
+     */
+    std::uint64_t allocate(std::size_t bytes);
+
+    /**
+     * Return a block taken by allocate.
+     */
+    void deallocate(std::uint64_t offset, std::size_t bytes);
+
+    /**
+     * @return offset of the entry of the key or 0 if there is no such key
+     */
+    std::uint64_t find(int key) const;
+
+    /**
+     * @return true - if the block lies inside the segment (offsets read without the mutex may be torn)
+     */
+    bool is_valid(std::uint64_t offset, std::size_t bytes) const;
+
+    /**
+     * Find the key without the mutex, checking every offset before following it.
+     * @param key - value of the key
+     * @param entry - offset of the entry of the key or 0 if there is no such key
+     * @return false - if the table is being changed and the lookup must be retried
+     */
+    bool find_unlocked(int key, std::uint64_t &entry) const;
+
+    /**
+     * Run a reader optimistically until no write overlaps it (under the mutex after too many retries).
+     * @param reader - callable returning false if it has seen torn data
+     */
+    template <typename Reader>
+    void read(const Reader &reader) const;
+
+    /**
+     * Double the number of buckets (skipped if the segment has no room for the new bucket array).
+     */
+    void grow();
+
+   public:
+    /**
+     * Create a new shared-memory segment with an empty table.
+     * @param name - name of the segment ("/name")
+     * @param segment_bytes - size of the segment (all the table's memory comes from it)
+     * @param capacity - initial number of buckets
+     * @return table mapped by the calling process
+     * @throws std::logic_error - if the name, the size or the capacity is invalid
+     * @throws std::runtime_error - if the segment exists or cannot be created, or its mutex cannot be initialized
+     */
+    static SharedHashTable Create(const std::string &name, std::size_t segment_bytes = kDefaultSegmentBytes,
+                                  int capacity = 1024);
+
+    /**
+     * Map an existing table created by another (or the same) process.
+     * @param name - name of the segment given to Create
+     * @return table mapped by the calling process
+     * @throws std::runtime_error - if there is no such segment or it does not hold a table
+     */
+    static SharedHashTable Open(const std::string &name);
+
+    /**
+     * Remove the segment name; the memory is released once every process has unmapped it.
+     * @param name - name of the segment
+     * @return true - if the segment existed
+     */
+    static bool Unlink(const std::string &name);
+
+    SharedHashTable(SharedHashTable &&other) noexcept;
+
+    SharedHashTable(const SharedHashTable &) = delete;
+    SharedHashTable &operator=(const SharedHashTable &) = delete;
+    SharedHashTable &operator=(SharedHashTable &&) = delete;
+
+    /**
+     * Unmap the segment (it stays available to the other processes until unlinked).
+     */
+    ~SharedHashTable();
+
+    std::optional<std::string> Search(int key) const;
+
+    /**
+     * Put a new or update an existing key-value pair.
+     * @throws std::logic_error - if the value is 4 GiB or longer
+     * @throws std::runtime_error - if the segment has no room for the pair (the table is left unchanged)
+     */
+    void Put(int key, const std::string &value);
+
+    std::optional<std::string> Remove(int key);
+
+    bool ContainsKey(int key) const;
+
+    bool empty() const;
+
+    int size() const;
+
+    int capacity() const;
+
+    std::unordered_set<int> keys() const;
+
+    /**
+     * @return bytes of the segment taken by the header, the buckets, the entries and the values (free blocks too)
+     */
+    std::size_t bytes_used() const;
+
+    std::size_t segment_bytes() const;
+
+    const std::string &name() const;
+  };
+
+}  // namespace itis
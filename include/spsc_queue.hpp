@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>  // move
+#include <vector>
+
+#include "utils.hpp"  // round_up_to_power_of_two
+
+namespace itis {
+
+  /**
+   * Bounded lock-free queue for exactly one producer thread and one consumer thread.
+   *
+   * The producer owns the tail and the consumer owns the head; each side reads the other's index only
+   * when its cached copy says the queue is full (or empty), so the indices' cache lines are rarely shared.
+   */
+  template <typename T>
+  class SpscQueue final {
+   private:
+    // struct members
+    std::vector<T> slots_;
+    const std::size_t mask_;
+
+    alignas(64) std::atomic<std::size_t> head_{0};  // next slot to pop (written by the consumer)
+    std::size_t cached_tail_{0};                     // consumer's last seen tail
+
+    alignas(64) std::atomic<std::size_t> tail_{0};  // next slot to push (written by the producer)
+    std::size_t cached_head_{0};                     // producer's last seen head
+
+   public:
+    /**
+     * @param capacity - maximum number of queued values (rounded up to a power of two)
+     */
+    explicit SpscQueue(std::size_t capacity)
+        : slots_(utils::round_up_to_power_of_two(capacity)), mask_{slots_.size() - 1} {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * Enqueue a value (producer thread only).
+     * @return false - if the queue is full (the value is not moved from)
+     */
+    bool TryPush(T &&value) {
+      const std::size_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail - cached_head_ == slots_.size()) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ == slots_.size()) {
+          return false;
+        }
+      }
+
+      slots_[tail & mask_] = std::move(value);
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Dequeue a value (consumer thread only).
+     * @return false - if the queue is empty
+     */
+    bool TryPop(T &value) {
+      const std::size_t head = head_.load(std::memory_order_relaxed);
+      if (head == cached_tail_) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+        if (head == cached_tail_) {
+          return false;
+        }
+      }
+
+      value = std::move(slots_[head & mask_]);
+      head_.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * @return maximum number of queued values
+     */
+    std::size_t capacity() const {
+      return slots_.size();
+    }
+  };
+
+}  // namespace itis
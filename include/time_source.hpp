@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+
+namespace itis {
+
+  /**
+   * Source of the current time, injected into the tables that expire their entries.
+   */
+  class TimeSource {
+   public:
+    virtual ~TimeSource() = default;
+
+    /**
+     * @return current time in milliseconds since an arbitrary (but fixed) epoch
+     */
+    virtual std::chrono::milliseconds Now() const = 0;
+  };
+
+  /**
+   * Monotonic wall-clock time.
+   */
+  class SteadyTimeSource final : public TimeSource {
+   public:
+    std::chrono::milliseconds Now() const override {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now().time_since_epoch());
+    }
+  };
+
+  /**
+   * Time that only moves when told to (e.g. in tests).
+   */
+  class ManualTimeSource final : public TimeSource {
+   private:
+    std::chrono::milliseconds now_{0};
+
+   public:
+    std::chrono::milliseconds Now() const override {
+      return now_;
+    }
+
+    void Advance(std::chrono::milliseconds duration) {
+      now_ += duration;
+    }
+  };
+
+}  // namespace itis
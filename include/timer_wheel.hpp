@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>  // pair
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Hierarchical timer wheel with millisecond ticks.
+   *
+   * Level L has 64 slots, each covering 64^L ticks. A timer is put into the coarsest level that still
+   * distinguishes its deadline and cascades to finer levels as the wheel turns, so both scheduling and
+   * expiry are O(1) per timer, independent of the number of pending timers.
+   */
+  class TimerWheel final {
+   public:
+    // constants
+    static constexpr int kLevels = 4;       // 64^4 ms ~ 4.6 hours before the overflow list is used
+    static constexpr int kSlotsPerLevel = 64;
+    static constexpr int kBitsPerLevel = 6;
+
+    // (key, deadline)
+    using Timer = std::pair<int, std::chrono::milliseconds>;
+
+   private:
+    using Slot = std::vector<Timer>;
+
+    // struct members
+    std::int64_t now_;  // current tick (milliseconds)
+    int num_timers_{0};
+
+    std::array<std::array<Slot, kSlotsPerLevel>, kLevels> levels_;
+    std::array<int, kLevels> level_sizes_{};  // number of timers on each level
+    Slot overflow_;  // timers beyond the range of the wheel
+    Slot due_;       // timers scheduled at or before the current tick
+
+    /**
+     * Put a timer with a deadline not earlier than the current tick into its slot.
+     */
+    void schedule(const Timer &timer);
+
+   public:
+    /**
+     * Construct a timer wheel.
+     * @param now - current time
+     */
+    explicit TimerWheel(std::chrono::milliseconds now);
+
+    /**
+     * Schedule a timer. Timers with deadlines in the past fire on the next Advance.
+     * @param key - value of the key the timer belongs to
+     * @param deadline - time the timer fires at
+     */
+    void Schedule(int key, std::chrono::milliseconds deadline);
+
+    /**
+     * Turn the wheel up to the given time.
+     * @param now - current time
+     * @return timers with deadlines up to the given time
+     */
+    std::vector<Timer> Advance(std::chrono::milliseconds now);
+
+    /**
+     * @return number of pending timers
+     */
+    int size() const;
+  };
+
+}  // namespace itis
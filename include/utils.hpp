@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>  // exception_ptr, current_exception, rethrow_exception
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace itis {
+
+  namespace utils {
+
+    /**
+     * @return smallest power of two not less than the value (1 for 0)
+     */
+    inline std::size_t round_up_to_power_of_two(std::size_t value) {
+      std::size_t result = 1;
+      while (result < value) {
+        result *= 2;
+      }
+      return result;
+    }
+
+    /**
+     * Flush a file or a directory to the disk (an fstream cannot be fsynced, so the written file is reopened).
+     * @param path - path to the file or the directory
+     * @param flags - extra open flags (O_DIRECTORY for a directory)
+     * @return true - if the data is on the disk
+     */
+    inline bool sync_path(const std::string &path, int flags = 0) {
+      const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | flags);
+      if (fd == -1) {
+        return false;
+      }
+      const bool is_synced = fsync(fd) == 0;
+      close(fd);
+      return is_synced;
+    }
+
+    /**
+     * @return directory holding the file, whose sync makes a rename of the file durable
+     */
+    inline std::string directory_of(const std::string &path) {
+      const auto slash = path.rfind('/');
+      return slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    /**
+     * Hint the CPU to start loading the cache line of the address (the load is not waited for).
+     */
+    inline void prefetch(const void *address) {
+#if defined(__GNUC__)
+      __builtin_prefetch(address);
+#else
+      static_cast<void>(address);
+#endif
+    }
+
+    /**
+     * Call the function once for every thread index: index 0 on the calling thread, the others on new threads.
+     * Every started thread is joined even if the function throws or a thread cannot be started, and the first
+     * exception (by thread index) is rethrown on the calling thread.
+     * @param num_threads - number of threads (the calling one included)
+     * @param function - called with the index of the thread in range [0...num_threads)
+     */
+    template <typename Function>
+    void parallel_for(int num_threads, const Function &function) {
+      std::vector<std::exception_ptr> errors(num_threads > 0 ? num_threads : 0);
+      const auto run = [&function, &errors](int thread) {
+        try {
+          function(thread);
+        } catch (...) {
+          errors[thread] = std::current_exception();
+        }
+      };
+
+      std::exception_ptr start_error;
+      std::vector<std::thread> threads;
+      try {
+        for (int thread = 1; thread < num_threads; thread++) {
+          threads.emplace_back(run, thread);
+        }
+      } catch (...) {
+        start_error = std::current_exception();
+      }
+
+      if (!start_error && num_threads > 0) {
+        run(0);
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+
+      if (start_error) {
+        std::rethrow_exception(start_error);
+      }
+      for (const auto &error : errors) {
+        if (error) {
+          std::rethrow_exception(error);
+        }
+      }
+    }
+
+  }  // namespace utils
+
+}  // namespace itis
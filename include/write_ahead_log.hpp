@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace itis {
+
+  /**
+   * Append-only log of hash table mutations with group commit.
+   *
+   * Records are appended to an in-memory buffer and get a log sequence number (LSN). Commit makes a record
+   * durable: the first committer becomes the leader, writes the whole buffer and calls fdatasync once, while
+   * the committers arriving meanwhile wait and are flushed together by the next leader. Thus one fsync covers
+   * every record appended since the previous one, however many threads are writing.
+   *
+   * Record format (host byte order): crc32 (4 bytes), type (1), key (4), value length (4), value bytes.
+   * The checksum covers everything after it, so a torn write at the tail is detected and discarded on recovery.
+   */
+  class WriteAheadLog final {
+   public:
+    // constants
+    static constexpr std::size_t kDefaultGroupCommitBytes = 64 * 1024;
+
+    enum class RecordType : std::uint8_t { kPut = 1, kRemove = 2 };
+
+    struct Record {
+      RecordType type;
+      int key;
+      std::string value;  // empty for kRemove
+    };
+
+   private:
+    // struct members
+    int fd_{-1};
+    const std::size_t group_commit_bytes_;  // the buffer is flushed once it grows to this size
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_;
+    std::string buffer_;            // encoded records not written yet
+    std::uint64_t next_lsn_{1};     // LSN of the next appended record
+    std::uint64_t durable_lsn_{0};  // all the records up to this LSN are on disk
+    bool is_flushing_{false};       // a leader is writing a batch
+    bool is_broken_{false};         // a batch failed to be written
+    std::uint64_t num_syncs_{0};
+
+   public:
+    /**
+     * Open (or create) the log file for appending.
+     * @param path - path to the log file
+     * @param group_commit_bytes - size of the buffer that triggers a flush by Append
+     * @throws std::runtime_error - if the file cannot be opened
+     */
+    explicit WriteAheadLog(const std::string &path, std::size_t group_commit_bytes = kDefaultGroupCommitBytes);
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    /**
+     * Flush the buffered records and close the file.
+     */
+    ~WriteAheadLog();
+
+    /**
+     * Read the records already in the file and cut off a torn or corrupted tail.
+     * Must be called before the first Append.
+     * @return records in the order they were appended
+     */
+    std::vector<Record> Recover();
+
+    /**
+     * Buffer a record (flushes the buffer if it has reached the group commit size).
+     * @return LSN of the record
+     * @throws std::logic_error - if the value is 4 GiB or longer (the record length has 32 bits)
+     */
+    std::uint64_t Append(RecordType type, int key, const std::string &value = {});
+
+    /**
+     * Block until the record is durable, sharing the fsync with the concurrent committers.
+     * @param lsn - LSN returned by Append
+     * @throws std::runtime_error - if the log cannot be written
+     */
+    void Commit(std::uint64_t lsn);
+
+    /**
+     * Make every appended record durable.
+     */
+    void Sync();
+
+    /**
+     * Drop every record (e.g. once they are all covered by a snapshot).
+     */
+    void Truncate();
+
+    /**
+     * @return LSN of the last durable record
+     */
+    std::uint64_t durable_lsn() const;
+
+    /**
+     * @return number of fsync calls so far
+     */
+    std::uint64_t num_syncs() const;
+  };
+
+}  // namespace itis
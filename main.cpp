@@ -1,6 +1,120 @@
+#include <csignal>
+#include <cstdlib>  // strtol
+#include <cstring>  // strcmp
 #include <iostream>
+#include <stdexcept>
 
+#include <pthread.h>  // pthread_sigmask
+
+#include "bulk_loader.hpp"
+#include "hash_table.hpp"
+#include "kv_server.hpp"
+#include "sharded_kv_server.hpp"
+
+namespace {
+
+  itis::KvServer *server = nullptr;
+
+  void stop(int /* signal */) {
+    if (server != nullptr) {
+      server->Stop();
+    }
+  }
+
+  void print_usage(const char *program) {
+    std::cerr << "usage: " << program << " [--port PORT] [--backend auto|epoll|io_uring] [--shards N]"
+              << " [--load FILE [--csv]]" << std::endl;
+  }
+
+  // thread-per-core server, runs until SIGINT or SIGTERM
+  int run_sharded(int num_shards, int port) {
+    // the workers inherit the blocked signals, so they are delivered to sigwait only
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    auto sharded_server = itis::ShardedKvServer(num_shards, port);
+    sharded_server.Start();
+    std::cout << "listening on 127.0.0.1:" << sharded_server.port() << " (" << num_shards << " shards)" << std::endl;
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    sharded_server.Stop();
+
+    int num_keys = 0;
+    for (int shard = 0; shard < num_shards; shard++) {
+      num_keys += sharded_server.shard_size(shard);
+    }
+    std::cout << "stopped with " << num_keys << " keys" << std::endl;
+    return 0;
+  }
+
+}  // namespace
+
+// memcached-protocol key-value server over itis::HashTable (get, set, delete with integer keys)
 int main(int argc, char **argv) {
-  std::cout << "Hello, stranger!" << std::endl;
+  int port = itis::KvServer::kDefaultPort;
+  auto backend = itis::KvServer::Backend::kAuto;
+  int num_shards = 0;  // 0 - single-threaded KvServer
+  const char *load_path = nullptr;
+  auto load_options = itis::BulkLoadOptions{};
+
+  for (int index = 1; index < argc; index++) {
+    if (std::strcmp(argv[index], "--port") == 0 && index + 1 < argc) {
+      port = static_cast<int>(std::strtol(argv[++index], nullptr, 10));
+    } else if (std::strcmp(argv[index], "--backend") == 0 && index + 1 < argc) {
+      const char *name = argv[++index];
+      if (std::strcmp(name, "epoll") == 0) {
+        backend = itis::KvServer::Backend::kEpoll;
+      } else if (std::strcmp(name, "io_uring") == 0) {
+        backend = itis::KvServer::Backend::kIoUring;
+      } else if (std::strcmp(name, "auto") != 0) {
+        print_usage(argv[0]);
+        return 2;
+      }
+    } else if (std::strcmp(argv[index], "--shards") == 0 && index + 1 < argc) {
+      num_shards = static_cast<int>(std::strtol(argv[++index], nullptr, 10));
+    } else if (std::strcmp(argv[index], "--load") == 0 && index + 1 < argc) {
+      load_path = argv[++index];
+    } else if (std::strcmp(argv[index], "--csv") == 0) {
+      load_options.delimiter = ',';
+    } else {
+      print_usage(argv[0]);
+      return 2;
+    }
+  }
+  if (load_path != nullptr && num_shards > 0) {
+    std::cerr << "--load is not supported with --shards" << std::endl;
+    return 2;
+  }
+
+  try {
+    if (num_shards > 0) {
+      return run_sharded(num_shards, port);
+    }
+
+    auto table = load_path == nullptr ? itis::HashTable(1024) : itis::LoadKeyValueFile(load_path, load_options);
+    if (load_path != nullptr) {
+      std::cout << "loaded " << table.size() << " keys from " << load_path << std::endl;
+    }
+    auto kv_server = itis::KvServer(table, port, backend);
+    server = &kv_server;
+
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    const bool is_io_uring = kv_server.backend() == itis::KvServer::Backend::kIoUring;
+    std::cout << "listening on 127.0.0.1:" << kv_server.port() << " (" << (is_io_uring ? "io_uring" : "epoll") << ")"
+              << std::endl;
+    kv_server.Run();
+
+    server = nullptr;
+    std::cout << "stopped with " << table.size() << " keys" << std::endl;
+  } catch (const std::exception &error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
   return 0;
-}
\ No newline at end of file
+}
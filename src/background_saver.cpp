@@ -0,0 +1,116 @@
+#include "background_saver.hpp"
+
+#include <cerrno>
+#include <cstdio>  // rename
+#include <fstream>
+#include <stdexcept>
+#include <utility>  // move
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "utils.hpp"  // sync_path, directory_of
+
+namespace itis {
+
+  namespace {
+
+    // runs in the child: nothing here may return into the code of the parent
+    [[noreturn]] void save_and_exit(const HashTable &table, const std::string &path) {
+      bool saved = false;
+      try {
+        const std::string temporary_path = path + ".tmp";
+        {
+          std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+          table.Save(output);
+          output.close();
+          saved = !output.fail();
+        }
+
+        // the data must be on the disk before the rename is, or a crash may leave an empty file behind it;
+        // the rename itself is durable once the directory is synced
+        saved = saved && utils::sync_path(temporary_path) && std::rename(temporary_path.c_str(), path.c_str()) == 0
+             && utils::sync_path(utils::directory_of(path), O_DIRECTORY);
+      } catch (...) {
+        saved = false;
+      }
+
+      // skip the atexit handlers and the stream buffers inherited from the parent
+      _exit(saved ? 0 : 1);
+    }
+
+  }  // namespace
+
+  BackgroundSaver::~BackgroundSaver() {
+    if (child_ != -1) {
+      int wait_status = 0;
+      while (waitpid(child_, &wait_status, 0) == -1 && errno == EINTR) {
+      }
+    }
+  }
+
+  void BackgroundSaver::BackgroundSave(const HashTable &table, const std::string &path, Callback callback) {
+    if (child_ != -1) {
+      throw std::logic_error("background save is already in progress");
+    }
+
+    const pid_t child = fork();
+    if (child == -1) {
+      throw std::runtime_error("failed to fork the background save process");
+    }
+
+    if (child == 0) {
+      save_and_exit(table, path);
+    }
+
+    child_ = child;
+    status_ = Status::kInProgress;
+    callback_ = std::move(callback);
+  }
+
+  void BackgroundSaver::complete(int wait_status) {
+    child_ = -1;
+    status_ = WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == 0 ? Status::kSucceeded : Status::kFailed;
+
+    // the callback may start the next save
+    Callback callback = std::move(callback_);
+    callback_ = nullptr;
+    if (callback) {
+      callback(status_);
+    }
+  }
+
+  BackgroundSaver::Status BackgroundSaver::Poll() {
+    if (child_ == -1) {
+      return status_;
+    }
+
+    int wait_status = 0;
+    const pid_t result = waitpid(child_, &wait_status, WNOHANG);
+    if (result == child_) {
+      complete(wait_status);
+    } else if (result == -1 && errno != EINTR) {
+      complete(-1);  // the child is gone (e.g. reaped elsewhere), its result is unknown
+    }
+    return status_;
+  }
+
+  BackgroundSaver::Status BackgroundSaver::Wait() {
+    if (child_ == -1) {
+      return status_;
+    }
+
+    int wait_status = 0;
+    pid_t result = 0;
+    while ((result = waitpid(child_, &wait_status, 0)) == -1 && errno == EINTR) {
+    }
+    complete(result == child_ ? wait_status : -1);
+    return status_;
+  }
+
+  BackgroundSaver::Status BackgroundSaver::status() const {
+    return status_;
+  }
+
+}  // namespace itis
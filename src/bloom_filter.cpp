@@ -0,0 +1,105 @@
+#include "bloom_filter.hpp"
+
+#include <cmath>  // ceil, exp, pow
+#include <stdexcept>
+
+namespace itis {
+
+  namespace {
+
+    constexpr int kBitsPerBlock = BloomFilter::kWordsPerBlock * 32;
+
+    // odd multipliers selecting one bit per word (as in the Impala/Parquet split-block filter)
+    constexpr std::uint32_t kSalts[BloomFilter::kWordsPerBlock] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU,
+                                                                   0xa2b7289dU, 0x705495c7U, 0x2df1424bU,
+                                                                   0x9efc4947U, 0x5c6bfb31U};
+
+  }  // namespace
+
+  std::uint64_t BloomFilter::mix(int key) {
+    // finalizer of MurmurHash3: sequential keys end up in unrelated blocks
+    auto hash = static_cast<std::uint64_t>(static_cast<std::uint32_t>(key));
+    hash ^= hash >> 33U;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33U;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33U;
+    return hash;
+  }
+
+  int BloomFilter::block_index(std::uint64_t hash) const {
+    // multiply-shift maps the upper 32 bits onto [0...number of blocks) without a division
+    return static_cast<int>(((hash >> 32U) * blocks_.size()) >> 32U);
+  }
+
+  void BloomFilter::masks(std::uint64_t hash, std::uint32_t (&masks)[kWordsPerBlock]) {
+    const auto low = static_cast<std::uint32_t>(hash);
+    for (int word = 0; word < kWordsPerBlock; word++) {
+      masks[word] = 1U << ((low * kSalts[word]) >> 27U);
+    }
+  }
+
+  double BloomFilter::EstimateFalsePositiveRate(double bits_per_key) {
+    // the number of keys in a block is Poisson-distributed; a block with j keys has each bit set
+    // with probability 1 - (31/32)^j, and a false positive needs all eight of them
+    const double mean = kBitsPerBlock / bits_per_key;
+    const int max_keys = static_cast<int>(mean * 4) + 64;
+
+    double probability = std::exp(-mean);  // P(j = 0)
+    double rate = 0.0;
+    for (int keys = 0; keys <= max_keys; keys++) {
+      rate += probability * std::pow(1.0 - std::pow(31.0 / 32.0, keys), kWordsPerBlock);
+      probability *= mean / (keys + 1);
+    }
+    return rate;
+  }
+
+  BloomFilter::BloomFilter(int expected_keys, double false_positive_rate) {
+    if (false_positive_rate <= 0.0 || false_positive_rate >= 1.0) {
+      throw std::logic_error("bloom filter false positive rate must be in range (0...1)");
+    }
+
+    const int num_keys = expected_keys > 0 ? expected_keys : 1;
+
+    double bits_per_key = 1.0;
+    while (EstimateFalsePositiveRate(bits_per_key) > false_positive_rate && bits_per_key < 64.0) {
+      bits_per_key *= 1.1;
+    }
+
+    const auto num_blocks = static_cast<int>(std::ceil(num_keys * bits_per_key / kBitsPerBlock));
+    blocks_.resize(num_blocks > 0 ? num_blocks : 1);
+  }
+
+  void BloomFilter::Insert(int key) {
+    const std::uint64_t hash = mix(key);
+    std::uint32_t bits[kWordsPerBlock];
+    masks(hash, bits);
+
+    Block &block = blocks_[block_index(hash)];
+    for (int word = 0; word < kWordsPerBlock; word++) {
+      block.words[word] |= bits[word];
+    }
+  }
+
+  bool BloomFilter::MayContain(int key) const {
+    const std::uint64_t hash = mix(key);
+    std::uint32_t bits[kWordsPerBlock];
+    masks(hash, bits);
+
+    const Block &block = blocks_[block_index(hash)];
+    std::uint32_t missing = 0;
+    for (int word = 0; word < kWordsPerBlock; word++) {
+      missing |= bits[word] & ~block.words[word];
+    }
+    return missing == 0;
+  }
+
+  void BloomFilter::Clear() {
+    blocks_.assign(blocks_.size(), Block{});
+  }
+
+  int BloomFilter::bytes() const {
+    return static_cast<int>(blocks_.size() * sizeof(Block));
+  }
+
+}  // namespace itis
@@ -0,0 +1,156 @@
+#include "bulk_loader.hpp"
+
+#include <algorithm>   // clamp
+#include <charconv>    // from_chars
+#include <cstring>     // memchr
+#include <stdexcept>
+#include <string_view>
+#include <thread>  // hardware_concurrency
+#include <utility>  // pair
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils.hpp"  // parallel_for
+
+namespace itis {
+
+  namespace {
+
+    constexpr std::size_t kMinChunkBytes = 1024 * 1024;  // smaller files are not worth a thread per chunk
+
+    // read-only mapping of a whole file
+    struct MappedFile {
+      const char *data{nullptr};
+      std::size_t size{0};
+
+      explicit MappedFile(const std::string &path) {
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+          throw std::runtime_error("failed to open " + path);
+        }
+
+        struct stat status {};
+        if (fstat(fd, &status) == -1) {
+          close(fd);
+          throw std::runtime_error("failed to read " + path);
+        }
+        size = static_cast<std::size_t>(status.st_size);
+
+        if (size > 0) {
+          void *memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (memory == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("failed to map " + path);
+          }
+          madvise(memory, size, MADV_SEQUENTIAL);  // read-ahead aggressively, the file is scanned once
+          data = static_cast<const char *>(memory);
+        }
+        close(fd);
+      }
+
+      MappedFile(const MappedFile &) = delete;
+      MappedFile &operator=(const MappedFile &) = delete;
+
+      ~MappedFile() {
+        if (data != nullptr) {
+          munmap(const_cast<char *>(data), size);
+        }
+      }
+    };
+
+    // lines of the file parsed by one thread
+    struct Chunk {
+      const char *begin{nullptr};
+      const char *end{nullptr};
+      std::vector<std::pair<int, std::string_view>> pairs;  // values point into the mapping
+      std::size_t num_lines{0};                              // lines scanned (including the empty ones)
+      bool is_malformed{false};                              // parsing stopped at line num_lines
+    };
+
+    void parse(Chunk &chunk, char delimiter) {
+      const char *line = chunk.begin;
+
+      while (line < chunk.end) {
+        const auto *newline = static_cast<const char *>(std::memchr(line, '\n', chunk.end - line));
+        const char *line_end = newline == nullptr ? chunk.end : newline;
+        const char *next = newline == nullptr ? chunk.end : newline + 1;
+        chunk.num_lines++;
+
+        if (line_end > line && line_end[-1] == '\r') {
+          line_end--;
+        }
+        if (line_end == line) {
+          line = next;
+          continue;
+        }
+
+        const auto *separator = static_cast<const char *>(std::memchr(line, delimiter, line_end - line));
+        int key = 0;
+        const auto [key_end, error] = std::from_chars(line, separator == nullptr ? line : separator, key);
+        if (separator == nullptr || error != std::errc{} || key_end != separator) {
+          chunk.is_malformed = true;
+          return;
+        }
+
+        chunk.pairs.emplace_back(key, std::string_view(separator + 1, line_end - separator - 1));
+        line = next;
+      }
+    }
+
+  }  // namespace
+
+  HashTable LoadKeyValueFile(const std::string &path, const BulkLoadOptions &options) {
+    const MappedFile file(path);
+    const char *const end = file.data + file.size;
+
+    int num_threads = options.num_threads > 0 ? options.num_threads
+                                              : static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+    num_threads = static_cast<int>(std::clamp<std::size_t>(file.size / kMinChunkBytes, 1, num_threads));
+
+    // chunks of roughly equal size, every boundary moved to the beginning of a line
+    std::vector<Chunk> chunks(num_threads);
+    const char *begin = file.data;
+    for (int index = 0; index < num_threads; index++) {
+      const char *boundary = index + 1 == num_threads ? end : file.data + file.size / num_threads * (index + 1);
+      if (boundary < begin) {
+        boundary = begin;
+      }
+      if (boundary < end) {
+        const auto *newline = static_cast<const char *>(std::memchr(boundary, '\n', end - boundary));
+        boundary = newline == nullptr ? end : newline + 1;
+      }
+      chunks[index].begin = begin;
+      chunks[index].end = boundary;
+      begin = boundary;
+    }
+
+    utils::parallel_for(num_threads, [&chunks, &options](int index) { parse(chunks[index], options.delimiter); });
+
+    std::size_t num_pairs = 0;
+    std::size_t num_lines = 0;
+    for (const auto &chunk : chunks) {
+      if (chunk.is_malformed) {
+        throw std::runtime_error("malformed line " + std::to_string(num_lines + chunk.num_lines) + " of " + path);
+      }
+      num_pairs += chunk.pairs.size();
+      num_lines += chunk.num_lines;
+    }
+
+    // enough buckets to stay under the load factor with every pair (repeated keys only make it roomier)
+    const auto capacity = static_cast<int>(static_cast<double>(num_pairs) / HashTable::kDefaultLoadFactor) + 1;
+    auto table = HashTable(capacity);
+    std::string value;
+    for (const auto &chunk : chunks) {
+      for (const auto &[key, view] : chunk.pairs) {
+        value.assign(view);
+        table.Put(key, value);
+      }
+    }
+    return table;
+  }
+
+}  // namespace itis
@@ -0,0 +1,134 @@
+#include "change_stream.hpp"
+
+#include <stdexcept>
+#include <thread>   // yield
+#include <utility>  // move
+
+#include "utils.hpp"  // round_up_to_power_of_two
+
+namespace itis {
+
+  ChangeStream::ChangeStream(std::size_t capacity, OverflowPolicy policy)
+      : capacity_{utils::round_up_to_power_of_two(capacity)}, policy_{policy} {
+    if (capacity == 0) {
+      throw std::logic_error("change stream capacity must be greater than zero");
+    }
+
+    slots_ = std::make_unique<Slot[]>(capacity_);
+    for (std::size_t position = 0; position < capacity_; position++) {
+      slots_[position].turn.store(position, std::memory_order_relaxed);
+    }
+  }
+
+  bool ChangeStream::try_push(ChangeEvent &event) {
+    std::uint64_t position = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[position & (capacity_ - 1)];
+      const std::uint64_t turn = slot.turn.load(std::memory_order_acquire);
+
+      if (turn == position) {
+        if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.event = std::move(event);
+          slot.turn.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < position) {
+        return false;  // the slot still holds the event written a lap ago
+      } else {
+        position = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool ChangeStream::try_pop(ChangeEvent &event) {
+    std::uint64_t position = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[position & (capacity_ - 1)];
+      const std::uint64_t turn = slot.turn.load(std::memory_order_acquire);
+
+      if (turn == position + 1) {
+        // the producer competes for the head when it overwrites, hence the CAS
+        if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          event = std::move(slot.event);
+          slot.turn.store(position + capacity_, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < position + 1) {
+        return false;  // nothing has been written to the slot yet
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool ChangeStream::is_abandoned() const {
+    // a stream that is not owned by a shared_ptr has no weak reference to itself (use count 0)
+    return weak_from_this().use_count() == 1;
+  }
+
+  void ChangeStream::Publish(ChangeEvent::Type type, int key, const std::string &value) {
+    ChangeEvent event{type, key, value, next_sequence_++};
+
+    if (try_push(event)) {
+      return;
+    }
+
+    switch (policy_) {
+      case OverflowPolicy::kDrop:
+        num_lost_.fetch_add(1, std::memory_order_relaxed);
+        break;
+
+      case OverflowPolicy::kBlock:
+        while (!try_push(event)) {
+          if (is_closed_.load(std::memory_order_acquire) || is_abandoned()) {
+            num_lost_.fetch_add(1, std::memory_order_relaxed);
+            return;
+          }
+          std::this_thread::yield();
+        }
+        break;
+
+      case OverflowPolicy::kOverwrite: {
+        ChangeEvent oldest;
+        while (!try_push(event)) {
+          // the consumer may take the oldest event first, then the push simply succeeds on the next try
+          if (try_pop(oldest)) {
+            num_lost_.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+        break;
+      }
+    }
+  }
+
+  std::size_t ChangeStream::Consume(std::vector<ChangeEvent> &batch, std::size_t max_events) {
+    std::size_t count = 0;
+    ChangeEvent event;
+    while (count < max_events && try_pop(event)) {
+      batch.push_back(std::move(event));
+      count++;
+    }
+    return count;
+  }
+
+  void ChangeStream::Close() {
+    is_closed_.store(true, std::memory_order_release);
+  }
+
+  bool ChangeStream::is_closed() const {
+    return is_closed_.load(std::memory_order_acquire);
+  }
+
+  std::uint64_t ChangeStream::num_lost() const {
+    return num_lost_.load(std::memory_order_relaxed);
+  }
+
+  std::size_t ChangeStream::capacity() const {
+    return capacity_;
+  }
+
+  ChangeStream::OverflowPolicy ChangeStream::policy() const {
+    return policy_;
+  }
+
+}  // namespace itis
@@ -0,0 +1,219 @@
+#include "clock_hash_table.hpp"
+
+#include <cmath>  // ceil
+#include <stdexcept>
+#include <utility>  // move
+
+namespace itis {
+
+  int ClockHashTable::hash(int key) const {
+    return static_cast<int>(static_cast<unsigned>(key) % static_cast<unsigned>(keys_.size()));
+  }
+
+  ClockHashTable::ClockHashTable(int max_keys, double load_factor) : max_keys_{max_keys}, load_factor_{load_factor} {
+    if (max_keys <= 0) {
+      throw std::logic_error("hash table max number of keys must be greater than zero");
+    }
+
+    if (load_factor <= 0.0 || load_factor > 1.0) {
+      throw std::logic_error("hash table load factor must be in range [0...1]");
+    }
+
+    // a full table still stays below the load factor, so there is always an empty slot to stop probing; the
+    // headroom lets evictions leave tombstones for a while, so that a full table is not rehashed on every Put
+    const int capacity = static_cast<int>(std::ceil(max_keys * (1.0 + kTombstoneHeadroom) / load_factor)) + 1;
+
+    keys_.resize(capacity);
+    states_.resize(capacity, SlotState::kEmpty);
+    values_.resize(capacity);
+    referenced_ = std::make_unique<std::atomic<std::uint8_t>[]>(capacity);
+    for (int index = 0; index < capacity; index++) {
+      referenced_[index].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  int ClockHashTable::find(int key) const {
+    const int capacity = this->capacity();
+    int index = hash(key);
+
+    while (states_[index] != SlotState::kEmpty) {
+      if (states_[index] == SlotState::kOccupied && keys_[index] == key) {
+        return index;
+      }
+      index = index + 1 == capacity ? 0 : index + 1;
+    }
+    return -1;
+  }
+
+  void ClockHashTable::evict() {
+    const int capacity = this->capacity();
+
+    while (true) {
+      const int index = hand_;
+      hand_ = hand_ + 1 == capacity ? 0 : hand_ + 1;
+
+      if (states_[index] != SlotState::kOccupied) {
+        continue;
+      }
+
+      // second chance: a referenced entry survives one more sweep of the hand
+      if (referenced_[index].load(std::memory_order_relaxed) != 0) {
+        referenced_[index].store(0, std::memory_order_relaxed);
+        continue;
+      }
+
+      states_[index] = SlotState::kDeleted;
+      values_[index].clear();
+      num_keys_--;
+      num_deleted_++;
+      num_evictions_++;
+      return;
+    }
+  }
+
+  void ClockHashTable::rehash() {
+    const int capacity = this->capacity();
+    const std::vector<int> old_keys = std::move(keys_);
+    const std::vector<SlotState> old_states = std::move(states_);
+    std::vector<std::string> old_values = std::move(values_);
+    const std::unique_ptr<std::atomic<std::uint8_t>[]> old_referenced = std::move(referenced_);
+
+    keys_.assign(capacity, 0);
+    states_.assign(capacity, SlotState::kEmpty);
+    values_.assign(capacity, std::string{});
+    referenced_ = std::make_unique<std::atomic<std::uint8_t>[]>(capacity);
+    for (int index = 0; index < capacity; index++) {
+      referenced_[index].store(0, std::memory_order_relaxed);
+    }
+    num_deleted_ = 0;
+    num_rehashes_++;
+    hand_ = 0;
+
+    for (int slot = 0; slot < capacity; slot++) {
+      if (old_states[slot] != SlotState::kOccupied) {
+        continue;
+      }
+
+      int index = hash(old_keys[slot]);
+      while (states_[index] != SlotState::kEmpty) {
+        index = index + 1 == capacity ? 0 : index + 1;
+      }
+
+      keys_[index] = old_keys[slot];
+      states_[index] = SlotState::kOccupied;
+      values_[index] = std::move(old_values[slot]);
+      referenced_[index].store(old_referenced[slot].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+  std::optional<std::string> ClockHashTable::Search(int key) const {
+    const int index = find(key);
+    if (index == -1) {
+      return std::nullopt;
+    }
+
+    // check before writing, so that hot entries do not bounce their cache line between cores
+    if (referenced_[index].load(std::memory_order_relaxed) == 0) {
+      referenced_[index].store(1, std::memory_order_relaxed);
+    }
+    return values_[index];
+  }
+
+  void ClockHashTable::Put(int key, const std::string &value) {
+    const int existing = find(key);
+    if (existing != -1) {
+      values_[existing] = value;
+      referenced_[existing].store(1, std::memory_order_relaxed);
+      return;
+    }
+
+    if (num_keys_ == max_keys_) {
+      evict();
+    }
+
+    const int capacity = this->capacity();
+    int index = hash(key);
+    while (states_[index] == SlotState::kOccupied) {
+      index = index + 1 == capacity ? 0 : index + 1;
+    }
+
+    if (states_[index] == SlotState::kDeleted) {
+      num_deleted_--;
+    }
+
+    // a new entry starts unreferenced, so a scan of cold keys cannot flush the hot ones
+    keys_[index] = key;
+    states_[index] = SlotState::kOccupied;
+    values_[index] = value;
+    referenced_[index].store(0, std::memory_order_relaxed);
+    num_keys_++;
+
+    if (static_cast<double>(num_keys_ + num_deleted_) / capacity >= load_factor_) {
+      rehash();
+    }
+  }
+
+  std::optional<std::string> ClockHashTable::Remove(int key) {
+    const int index = find(key);
+    if (index == -1) {
+      return std::nullopt;
+    }
+
+    std::string removed = std::move(values_[index]);
+    values_[index].clear();
+    states_[index] = SlotState::kDeleted;
+    num_keys_--;
+    num_deleted_++;
+    return removed;
+  }
+
+  bool ClockHashTable::ContainsKey(int key) const {
+    return find(key) != -1;
+  }
+
+  bool ClockHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int ClockHashTable::size() const {
+    return num_keys_;
+  }
+
+  int ClockHashTable::capacity() const {
+    return static_cast<int>(keys_.size());
+  }
+
+  int ClockHashTable::max_keys() const {
+    return max_keys_;
+  }
+
+  int ClockHashTable::evictions() const {
+    return num_evictions_;
+  }
+
+  int ClockHashTable::rehashes() const {
+    return num_rehashes_;
+  }
+
+  std::unordered_set<int> ClockHashTable::keys() const {
+    std::unordered_set<int> keys(num_keys_);
+    for (int index = 0; index < capacity(); index++) {
+      if (states_[index] == SlotState::kOccupied) {
+        keys.insert(keys_[index]);
+      }
+    }
+    return keys;
+  }
+
+  std::vector<std::string> ClockHashTable::values() const {
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    for (int index = 0; index < capacity(); index++) {
+      if (states_[index] == SlotState::kOccupied) {
+        values.push_back(values_[index]);
+      }
+    }
+    return values;
+  }
+
+}  // namespace itis
@@ -0,0 +1,176 @@
+#include "dense_key_hash_table.hpp"
+
+#include <algorithm>  // max, minmax_element
+#include <stdexcept>
+
+namespace itis {
+
+  DenseKeyHashTable::DenseKeyHashTable(int min_key, int max_key) : min_key_{min_key}, max_key_{max_key} {
+    if (min_key > max_key) {
+      throw std::logic_error("key range must not be empty");
+    }
+
+    const std::int64_t range = max_key_ - min_key_ + 1;
+    if (range > kMaxRange) {
+      throw std::logic_error("key range is too large for the direct-address mode");
+    }
+
+    values_.resize(range);
+    occupied_.resize((range + 63) / 64, 0);
+  }
+
+  DenseKeyHashTable DenseKeyHashTable::Detect(const std::vector<std::pair<int, std::string>> &pairs,
+                                              double min_density) {
+    if (pairs.empty()) {
+      return DenseKeyHashTable(0, 0);
+    }
+
+    const auto [min_pair, max_pair] = std::minmax_element(
+        pairs.begin(), pairs.end(), [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    const std::int64_t range = std::int64_t{max_pair->first} - min_pair->first + 1;
+
+    const bool is_dense =
+        range <= kMaxRange && static_cast<double>(pairs.size()) / static_cast<double>(range) >= min_density;
+    auto table = is_dense ? DenseKeyHashTable(min_pair->first, max_pair->first) : DenseKeyHashTable(0, 0);
+    if (!is_dense) {
+      table.fall_back(static_cast<int>(pairs.size()));
+    }
+
+    for (const auto &[key, value] : pairs) {
+      table.Put(key, value);
+    }
+    return table;
+  }
+
+  int DenseKeyHashTable::index(int key) const {
+    if (key < min_key_ || key > max_key_) {
+      return -1;
+    }
+    return static_cast<int>(key - min_key_);
+  }
+
+  bool DenseKeyHashTable::is_occupied(int index) const {
+    return (occupied_[index / 64] >> (index % 64) & 1U) != 0;
+  }
+
+  void DenseKeyHashTable::fall_back(int expected_keys) {
+    // sized so that the expected keys stay below the load factor and the table is not rehashed while filling
+    const int num_keys = std::max(num_keys_, expected_keys);
+    hashed_.emplace(static_cast<int>(num_keys / HashTable::kDefaultLoadFactor) + 1);
+
+    for (int index = 0; index < static_cast<int>(values_.size()); index++) {
+      if (is_occupied(index)) {
+        hashed_->Put(static_cast<int>(min_key_ + index), values_[index]);
+      }
+    }
+
+    num_keys_ = 0;
+    values_.clear();
+    values_.shrink_to_fit();
+    occupied_.clear();
+    occupied_.shrink_to_fit();
+  }
+
+  std::optional<std::string> DenseKeyHashTable::Search(int key) const {
+    if (hashed_) {
+      return hashed_->Search(key);
+    }
+
+    const int index = this->index(key);
+    if (index == -1 || !is_occupied(index)) {
+      return std::nullopt;
+    }
+    return values_[index];
+  }
+
+  void DenseKeyHashTable::Put(int key, const std::string &value) {
+    if (!hashed_ && index(key) == -1) {
+      fall_back();
+    }
+
+    if (hashed_) {
+      hashed_->Put(key, value);
+      return;
+    }
+
+    const int index = this->index(key);
+    if (!is_occupied(index)) {
+      occupied_[index / 64] |= std::uint64_t{1} << (index % 64);
+      num_keys_++;
+    }
+    values_[index] = value;
+  }
+
+  std::optional<std::string> DenseKeyHashTable::Remove(int key) {
+    if (hashed_) {
+      return hashed_->Remove(key);
+    }
+
+    const int index = this->index(key);
+    if (index == -1 || !is_occupied(index)) {
+      return std::nullopt;
+    }
+
+    occupied_[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+    num_keys_--;
+
+    std::string removed = std::move(values_[index]);
+    values_[index].clear();
+    return removed;
+  }
+
+  bool DenseKeyHashTable::ContainsKey(int key) const {
+    if (hashed_) {
+      return hashed_->ContainsKey(key);
+    }
+
+    const int index = this->index(key);
+    return index != -1 && is_occupied(index);
+  }
+
+  bool DenseKeyHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int DenseKeyHashTable::size() const {
+    return hashed_ ? hashed_->size() : num_keys_;
+  }
+
+  int DenseKeyHashTable::capacity() const {
+    return hashed_ ? hashed_->capacity() : static_cast<int>(values_.size());
+  }
+
+  bool DenseKeyHashTable::is_direct() const {
+    return !hashed_;
+  }
+
+  std::unordered_set<int> DenseKeyHashTable::keys() const {
+    if (hashed_) {
+      return hashed_->keys();
+    }
+
+    std::unordered_set<int> keys(num_keys_);
+    for (int index = 0; index < static_cast<int>(values_.size()); index++) {
+      if (is_occupied(index)) {
+        keys.insert(static_cast<int>(min_key_ + index));
+      }
+    }
+    return keys;
+  }
+
+  std::vector<std::string> DenseKeyHashTable::values() const {
+    if (hashed_) {
+      return hashed_->values();
+    }
+
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    for (int index = 0; index < static_cast<int>(values_.size()); index++) {
+      if (is_occupied(index)) {
+        values.push_back(values_[index]);
+      }
+    }
+    return values;
+  }
+
+}  // namespace itis
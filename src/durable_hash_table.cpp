@@ -0,0 +1,111 @@
+#include "durable_hash_table.hpp"
+
+#include <cstdio>  // rename
+#include <fstream>
+#include <stdexcept>
+
+#include "utils.hpp"  // sync_path, directory_of
+
+namespace itis {
+
+  DurableHashTable::DurableHashTable(const std::string &snapshot_path, const std::string &log_path,
+                                     Durability durability, std::size_t group_commit_bytes)
+      : snapshot_path_{snapshot_path},
+        durability_{durability},
+        log_{log_path, group_commit_bytes},
+        table_{Recover(snapshot_path_, log_)} {}
+
+  HashTable DurableHashTable::Recover(const std::string &snapshot_path, WriteAheadLog &log) {
+    std::ifstream snapshot(snapshot_path, std::ios::binary);
+    HashTable table = snapshot ? HashTable::Load(snapshot) : HashTable(kInitialCapacity);
+
+    for (const auto &record : log.Recover()) {
+      if (record.type == WriteAheadLog::RecordType::kPut) {
+        table.Put(record.key, record.value);
+      } else {
+        table.Remove(record.key);
+      }
+    }
+    return table;
+  }
+
+  std::optional<std::string> DurableHashTable::Search(int key) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return table_.Search(key);
+  }
+
+  void DurableHashTable::Put(int key, const std::string &value) {
+    std::uint64_t lsn = 0;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      lsn = log_.Append(WriteAheadLog::RecordType::kPut, key, value);
+      table_.Put(key, value);
+    }
+
+    // wait outside the lock, so that the records of the other writers join the same fsync
+    if (durability_ == Durability::kSynchronous) {
+      log_.Commit(lsn);
+    }
+  }
+
+  std::optional<std::string> DurableHashTable::Remove(int key) {
+    std::uint64_t lsn = 0;
+    std::optional<std::string> removed;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      if (!table_.ContainsKey(key)) {
+        return std::nullopt;
+      }
+      lsn = log_.Append(WriteAheadLog::RecordType::kRemove, key);
+      removed = table_.Remove(key);
+    }
+
+    if (durability_ == Durability::kSynchronous) {
+      log_.Commit(lsn);
+    }
+    return removed;
+  }
+
+  bool DurableHashTable::ContainsKey(int key) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return table_.ContainsKey(key);
+  }
+
+  int DurableHashTable::size() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return table_.size();
+  }
+
+  void DurableHashTable::Sync() {
+    log_.Sync();
+  }
+
+  void DurableHashTable::Checkpoint() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    const std::string temporary_path = snapshot_path_ + ".tmp";
+    {
+      std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+      table_.Save(output);
+      output.flush();
+      if (!output) {
+        throw std::runtime_error("failed to write the snapshot " + temporary_path);
+      }
+    }
+
+    // the rename must be on the disk before the log is emptied, or a crash may lose both the new snapshot and
+    // the records it covers
+    if (!utils::sync_path(temporary_path) || std::rename(temporary_path.c_str(), snapshot_path_.c_str()) != 0
+        || !utils::sync_path(utils::directory_of(snapshot_path_), O_DIRECTORY)) {
+      throw std::runtime_error("failed to replace the snapshot " + snapshot_path_);
+    }
+
+    // the snapshot covers every logged mutation
+    log_.Truncate();
+  }
+
+  std::uint64_t DurableHashTable::num_syncs() const {
+    return log_.num_syncs();
+  }
+
+}  // namespace itis
@@ -0,0 +1,154 @@
+#include "expiring_hash_table.hpp"
+
+#include <algorithm>  // max
+#include <cstring>    // memcpy
+#include <stdexcept>
+#include <utility>  // as_const, move
+
+namespace itis {
+
+  namespace {
+
+    using Deadline = std::chrono::milliseconds::rep;
+
+    constexpr std::size_t kHeaderBytes = sizeof(Deadline);
+    constexpr Deadline kNever = 0;
+
+    std::string encode(Deadline deadline, const std::string &value) {
+      std::string entry(kHeaderBytes, '\0');
+      std::memcpy(entry.data(), &deadline, kHeaderBytes);
+      entry += value;
+      return entry;
+    }
+
+    Deadline deadline_of(const std::string &entry) {
+      Deadline deadline = kNever;
+      std::memcpy(&deadline, entry.data(), kHeaderBytes);
+      return deadline;
+    }
+
+    std::string value_of(std::string &&entry) {
+      entry.erase(0, kHeaderBytes);
+      return std::move(entry);
+    }
+
+  }  // namespace
+
+  ExpiringHashTable::ExpiringHashTable(int capacity, std::shared_ptr<const TimeSource> time_source,
+                                       double load_factor)
+      : table_{capacity, load_factor}, time_source_{std::move(time_source)}, timers_{time_source_->Now()} {}
+
+  std::optional<std::string> ExpiringHashTable::find(int key) {
+    auto entry = table_.Search(key);
+    if (!entry) {
+      return std::nullopt;
+    }
+
+    const Deadline deadline = deadline_of(*entry);
+    if (deadline != kNever && deadline <= time_source_->Now().count()) {
+      table_.Remove(key);
+      return std::nullopt;
+    }
+    return entry;
+  }
+
+  void ExpiringHashTable::schedule(int key, std::chrono::milliseconds deadline) {
+    timers_.Schedule(key, deadline);
+    if (timers_.size() < std::max(kMinTimersToRebuild, kMaxTimersPerPair * table_.size())) {
+      return;
+    }
+
+    // every update of a key with a time-to-live leaves a stale timer behind, rebuilding bounds their number
+    timers_ = TimerWheel(time_source_->Now());
+    for (const int live_key : table_.keys()) {
+      const Deadline live_deadline = deadline_of(*std::as_const(table_).Search(live_key));
+      if (live_deadline != kNever) {
+        timers_.Schedule(live_key, std::chrono::milliseconds(live_deadline));
+      }
+    }
+  }
+
+  std::optional<std::string> ExpiringHashTable::Search(int key) {
+    auto entry = find(key);
+    if (!entry) {
+      return std::nullopt;
+    }
+    return value_of(std::move(*entry));
+  }
+
+  void ExpiringHashTable::Put(int key, const std::string &value) {
+    table_.Put(key, encode(kNever, value));
+  }
+
+  void ExpiringHashTable::Put(int key, const std::string &value, std::chrono::milliseconds ttl) {
+    if (ttl.count() <= 0) {
+      throw std::logic_error("time-to-live must be greater than zero");
+    }
+
+    const auto deadline = time_source_->Now() + ttl;
+    table_.Put(key, encode(deadline.count(), value));
+    schedule(key, deadline);
+  }
+
+  std::optional<std::string> ExpiringHashTable::Remove(int key) {
+    auto entry = table_.Remove(key);
+    if (!entry) {
+      return std::nullopt;
+    }
+
+    const Deadline deadline = deadline_of(*entry);
+    if (deadline != kNever && deadline <= time_source_->Now().count()) {
+      return std::nullopt;
+    }
+    return value_of(std::move(*entry));
+  }
+
+  bool ExpiringHashTable::ContainsKey(int key) {
+    return find(key).has_value();
+  }
+
+  int ExpiringHashTable::ReclaimExpired() {
+    int num_expired = 0;
+
+    for (const auto &[key, deadline] : timers_.Advance(time_source_->Now())) {
+      // a stale timer: the key has been removed or put again with another deadline since
+      const auto entry = std::as_const(table_).Search(key);
+      if (!entry || deadline_of(*entry) != deadline.count()) {
+        continue;
+      }
+
+      table_.Remove(key);
+      num_expired++;
+    }
+    return num_expired;
+  }
+
+  bool ExpiringHashTable::empty() const {
+    return table_.empty();
+  }
+
+  int ExpiringHashTable::size() const {
+    return table_.size();
+  }
+
+  int ExpiringHashTable::capacity() const {
+    return table_.capacity();
+  }
+
+  int ExpiringHashTable::num_timers() const {
+    return timers_.size();
+  }
+
+  std::unordered_set<int> ExpiringHashTable::keys() const {
+    return table_.keys();
+  }
+
+  std::vector<std::string> ExpiringHashTable::values() const {
+    auto values = table_.values();
+    for (auto &value : values) {
+      value.erase(0, kHeaderBytes);
+    }
+    return values;
+  }
+
+}  // namespace itis
@@ -0,0 +1,165 @@
+#include "flat_hash_table.hpp"
+
+#include <stdexcept>
+#include <utility>  // move
+
+namespace itis {
+
+  int FlatHashTable::hash(int key) const {
+    // unsigned arithmetic keeps the index non-negative for negative keys
+    return static_cast<int>(static_cast<unsigned>(key) % static_cast<unsigned>(keys_.size()));
+  }
+
+  FlatHashTable::FlatHashTable(int capacity, double load_factor) : load_factor_{load_factor} {
+    if (capacity <= 0) {
+      throw std::logic_error("hash table capacity must be greater than zero");
+    }
+
+    if (load_factor <= 0.0 || load_factor > 1.0) {
+      throw std::logic_error("hash table load factor must be in range [0...1]");
+    }
+
+    keys_.resize(capacity);
+    states_.resize(capacity, SlotState::kEmpty);
+    values_.resize(capacity);
+  }
+
+  int FlatHashTable::find(int key) const {
+    const int capacity = this->capacity();
+    int index = hash(key);
+
+    // the table always keeps at least one empty slot, so the probe sequence terminates
+    while (states_[index] != SlotState::kEmpty) {
+      if (states_[index] == SlotState::kOccupied && keys_[index] == key) {
+        return index;
+      }
+      index = index + 1 == capacity ? 0 : index + 1;
+    }
+    return -1;
+  }
+
+  void FlatHashTable::rehash(int capacity) {
+    const std::vector<int> old_keys = std::move(keys_);
+    const std::vector<SlotState> old_states = std::move(states_);
+    std::vector<std::string> old_values = std::move(values_);
+
+    keys_.assign(capacity, 0);
+    states_.assign(capacity, SlotState::kEmpty);
+    values_.assign(capacity, std::string{});
+    num_deleted_ = 0;
+
+    for (int slot = 0; slot < static_cast<int>(old_keys.size()); slot++) {
+      if (old_states[slot] != SlotState::kOccupied) {
+        continue;
+      }
+
+      int index = hash(old_keys[slot]);
+      while (states_[index] != SlotState::kEmpty) {
+        index = index + 1 == capacity ? 0 : index + 1;
+      }
+
+      keys_[index] = old_keys[slot];
+      states_[index] = SlotState::kOccupied;
+      values_[index] = std::move(old_values[slot]);
+    }
+  }
+
+  std::optional<std::string> FlatHashTable::Search(int key) const {
+    const int index = find(key);
+    if (index == -1) {
+      return std::nullopt;
+    }
+    return values_[index];
+  }
+
+  void FlatHashTable::Put(int key, const std::string &value) {
+    const int capacity = this->capacity();
+    int index = hash(key);
+    int tombstone = -1;
+
+    while (states_[index] != SlotState::kEmpty) {
+      if (states_[index] == SlotState::kOccupied && keys_[index] == key) {
+        values_[index] = value;
+        return;
+      }
+      if (states_[index] == SlotState::kDeleted && tombstone == -1) {
+        tombstone = index;
+      }
+      index = index + 1 == capacity ? 0 : index + 1;
+    }
+
+    // reuse the first tombstone on the probe sequence, if any
+    if (tombstone != -1) {
+      index = tombstone;
+      num_deleted_--;
+    }
+
+    keys_[index] = key;
+    states_[index] = SlotState::kOccupied;
+    values_[index] = value;
+    num_keys_++;
+
+    if (static_cast<double>(num_keys_) / capacity >= load_factor_) {
+      rehash(capacity * kGrowthCoefficient);
+    } else if (static_cast<double>(num_keys_ + num_deleted_) / capacity >= load_factor_) {
+      // too many tombstones: clean them up without growing
+      rehash(capacity);
+    }
+  }
+
+  std::optional<std::string> FlatHashTable::Remove(int key) {
+    const int index = find(key);
+    if (index == -1) {
+      return std::nullopt;
+    }
+
+    std::string removed = std::move(values_[index]);
+    values_[index].clear();
+    states_[index] = SlotState::kDeleted;
+    num_keys_--;
+    num_deleted_++;
+    return removed;
+  }
+
+  bool FlatHashTable::ContainsKey(int key) const {
+    return find(key) != -1;
+  }
+
+  bool FlatHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int FlatHashTable::size() const {
+    return num_keys_;
+  }
+
+  int FlatHashTable::capacity() const {
+    return static_cast<int>(keys_.size());
+  }
+
+  double FlatHashTable::load_factor() const {
+    return load_factor_;
+  }
+
+  std::unordered_set<int> FlatHashTable::keys() const {
+    std::unordered_set<int> keys(num_keys_);
+    for (int index = 0; index < capacity(); index++) {
+      if (states_[index] == SlotState::kOccupied) {
+        keys.insert(keys_[index]);
+      }
+    }
+    return keys;
+  }
+
+  std::vector<std::string> FlatHashTable::values() const {
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    for (int index = 0; index < capacity(); index++) {
+      if (states_[index] == SlotState::kOccupied) {
+        values.push_back(values_[index]);
+      }
+    }
+    return values;
+  }
+
+}  // namespace itis
@@ -0,0 +1,321 @@
+#include "frozen_hash_table.hpp"
+
+#include <algorithm>  // find, lower_bound, sort
+#include <stdexcept>
+
+namespace itis {
+
+  namespace {
+
+    constexpr char kMagic[8] = {'I', 'T', 'I', 'S', 'F', 'H', 'T', '1'};
+
+    // finalizer of MurmurHash3
+    std::uint64_t mix(std::uint64_t hash) {
+      hash ^= hash >> 33U;
+      hash *= 0xff51afd7ed558ccdULL;
+      hash ^= hash >> 33U;
+      hash *= 0xc4ceb9fe1a85ec53ULL;
+      hash ^= hash >> 33U;
+      return hash;
+    }
+
+    // maps a 64-bit hash onto [0...size) without a division
+    int reduce(std::uint64_t hash, std::size_t size) {
+      return static_cast<int>(((hash >> 32U) * size) >> 32U);
+    }
+
+    template <typename T>
+    void write(std::ostream &output, const T &value) {
+      output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void write(std::ostream &output, const std::vector<T> &values) {
+      write(output, static_cast<std::uint64_t>(values.size()));
+      output.write(reinterpret_cast<const char *>(values.data()),
+                   static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    T read(std::istream &input) {
+      T value{};
+      if (!input.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+        throw std::runtime_error("frozen hash table stream is truncated");
+      }
+      return value;
+    }
+
+    template <typename T>
+    std::vector<T> read_vector(std::istream &input) {
+      const auto size = read<std::uint64_t>(input);
+      std::vector<T> values;
+
+      // grow while reading, so that a corrupted size cannot trigger a huge allocation
+      constexpr std::uint64_t kChunk = 1U << 16U;
+      for (std::uint64_t done = 0; done < size; done += kChunk) {
+        const std::uint64_t count = std::min(kChunk, size - done);
+        values.resize(done + count);
+        auto *destination = reinterpret_cast<char *>(values.data() + done);
+        if (!input.read(destination, static_cast<std::streamsize>(count * sizeof(T)))) {
+          throw std::runtime_error("frozen hash table stream is truncated");
+        }
+      }
+      return values;
+    }
+
+  }  // namespace
+
+  int FrozenHashTable::bucket(int key) const {
+    // skewed mapping: 60% of the keys go to the first 30% of the buckets, which are placed while the table is empty
+    const std::uint64_t hash = mix(static_cast<std::uint32_t>(key) ^ seed_);
+    const auto num_dense = static_cast<std::size_t>(static_cast<double>(pilots_.size()) * 0.3);
+    if (num_dense > 0 && static_cast<std::uint32_t>(hash) < static_cast<std::uint32_t>(0.6 * 4294967296.0)) {
+      return reduce(hash, num_dense);
+    }
+    return static_cast<int>(num_dense) + reduce(hash, pilots_.size() - num_dense);
+  }
+
+  std::uint32_t FrozenHashTable::pilot(int bucket) const {
+    if (pilots_[bucket] != kLargePilot) {
+      return pilots_[bucket];
+    }
+
+    const auto large = std::lower_bound(large_pilots_.begin(), large_pilots_.end(),
+                                        std::make_pair(static_cast<std::uint32_t>(bucket), std::uint32_t{0}));
+    return large->second;
+  }
+
+  int FrozenHashTable::position(int key, std::uint32_t pilot) const {
+    const std::uint64_t hash = mix(static_cast<std::uint32_t>(key) ^ (seed_ << 32U) ^ 0x9e3779b97f4a7c15ULL);
+    return reduce(mix(hash ^ mix(pilot)), keys_.size() + remap_.size());
+  }
+
+  int FrozenHashTable::slot(int key) const {
+    const int position = this->position(key, pilot(bucket(key)));
+    if (position < static_cast<int>(keys_.size())) {
+      return position;
+    }
+    return static_cast<int>(remap_[position - keys_.size()]);
+  }
+
+  FrozenHashTable::FrozenHashTable(const std::vector<std::pair<int, std::string>> &pairs) {
+    const auto num_keys = static_cast<int>(pairs.size());
+    if (num_keys == 0) {
+      return;
+    }
+
+    seed_ = 0x5851f42d4c957f2dULL;
+    keys_.resize(num_keys);
+    pilots_.resize((num_keys + kAverageBucketSize - 1) / kAverageBucketSize);
+
+    // a few spare positions keep the last buckets from searching long for the last free slots
+    const auto num_positions = static_cast<int>(num_keys / kLoadFactor) + 1;
+    remap_.resize(num_positions - num_keys);
+
+    // (bucket, index of the pair), grouped by bucket and ordered by key inside a bucket
+    std::vector<std::pair<int, int>> members(num_keys);
+    for (int index = 0; index < num_keys; index++) {
+      members[index] = {bucket(pairs[index].first), index};
+    }
+    std::sort(members.begin(), members.end(), [&pairs](const auto &lhs, const auto &rhs) {
+      return lhs.first != rhs.first ? lhs.first < rhs.first : pairs[lhs.second].first < pairs[rhs.second].first;
+    });
+
+    for (int index = 1; index < num_keys; index++) {
+      if (pairs[members[index].second].first == pairs[members[index - 1].second].first) {
+        throw std::logic_error("frozen hash table keys must be unique");
+      }
+    }
+
+    // (size, first member) of every non-empty bucket, the largest ones are placed first while the table is empty
+    std::vector<std::pair<int, int>> buckets;
+    for (int begin = 0; begin < num_keys;) {
+      int end = begin;
+      while (end < num_keys && members[end].first == members[begin].first) {
+        end++;
+      }
+      buckets.emplace_back(end - begin, begin);
+      begin = end;
+    }
+    std::stable_sort(buckets.begin(), buckets.end(),
+                     [](const auto &lhs, const auto &rhs) { return lhs.first > rhs.first; });
+
+    std::vector<bool> taken(num_positions, false);
+    std::vector<int> slots_of_pair(num_keys);
+    std::vector<int> candidate;
+
+    for (const auto &[size, first] : buckets) {
+      const int bucket_index = members[first].first;
+
+      for (std::uint32_t pilot = 0;; pilot++) {
+        if (pilot == kMaxPilot) {
+          throw std::runtime_error("failed to build a perfect hash function");
+        }
+
+        candidate.clear();
+        bool fits = true;
+        for (int member = first; member < first + size && fits; member++) {
+          const int slot = position(pairs[members[member].second].first, pilot);
+          fits = !taken[slot] && std::find(candidate.begin(), candidate.end(), slot) == candidate.end();
+          candidate.push_back(slot);
+        }
+
+        if (!fits) {
+          continue;
+        }
+
+        for (int member = 0; member < size; member++) {
+          taken[candidate[member]] = true;
+          slots_of_pair[members[first + member].second] = candidate[member];
+        }
+
+        if (pilot < kLargePilot) {
+          pilots_[bucket_index] = static_cast<std::uint8_t>(pilot);
+        } else {
+          pilots_[bucket_index] = kLargePilot;
+          large_pilots_.emplace_back(bucket_index, pilot);
+        }
+        break;
+      }
+    }
+    std::sort(large_pilots_.begin(), large_pilots_.end());
+
+    // positions past the end of the table are remapped onto the slots left free inside it
+    int free_slot = 0;
+    for (int position = num_keys; position < num_positions; position++) {
+      if (!taken[position]) {
+        continue;
+      }
+      while (taken[free_slot]) {
+        free_slot++;
+      }
+      taken[free_slot] = true;
+      remap_[position - num_keys] = free_slot;
+    }
+    for (auto &slot : slots_of_pair) {
+      if (slot >= num_keys) {
+        slot = static_cast<int>(remap_[slot - num_keys]);
+      }
+    }
+
+    // lay the values out in slot order
+    std::vector<int> pair_of_slot(num_keys);
+    for (int index = 0; index < num_keys; index++) {
+      pair_of_slot[slots_of_pair[index]] = index;
+    }
+
+    offsets_.reserve(num_keys + 1);
+    offsets_.push_back(0);
+    for (int slot = 0; slot < num_keys; slot++) {
+      const auto &[key, value] = pairs[pair_of_slot[slot]];
+      keys_[slot] = key;
+      data_ += value;
+      offsets_.push_back(data_.size());
+    }
+  }
+
+  std::optional<std::string> FrozenHashTable::Search(int key) const {
+    if (keys_.empty()) {
+      return std::nullopt;
+    }
+
+    const int slot = this->slot(key);
+    if (keys_[slot] != key) {
+      return std::nullopt;
+    }
+    return data_.substr(offsets_[slot], offsets_[slot + 1] - offsets_[slot]);
+  }
+
+  bool FrozenHashTable::ContainsKey(int key) const {
+    return !keys_.empty() && keys_[slot(key)] == key;
+  }
+
+  bool FrozenHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int FrozenHashTable::size() const {
+    return static_cast<int>(keys_.size());
+  }
+
+  double FrozenHashTable::bits_per_key() const {
+    if (keys_.empty()) {
+      return 0.0;
+    }
+
+    const auto bytes = pilots_.size() * sizeof(std::uint8_t) + large_pilots_.size() * sizeof(large_pilots_[0])
+                     + remap_.size() * sizeof(std::uint32_t);
+    return static_cast<double>(bytes * 8) / static_cast<double>(keys_.size());
+  }
+
+  std::unordered_set<int> FrozenHashTable::keys() const {
+    return std::unordered_set<int>(keys_.begin(), keys_.end());
+  }
+
+  std::vector<std::string> FrozenHashTable::values() const {
+    std::vector<std::string> values;
+    values.reserve(keys_.size());
+    for (int slot = 0; slot < size(); slot++) {
+      values.push_back(data_.substr(offsets_[slot], offsets_[slot + 1] - offsets_[slot]));
+    }
+    return values;
+  }
+
+  void FrozenHashTable::Save(std::ostream &output) const {
+    output.write(kMagic, sizeof(kMagic));
+    write(output, seed_);
+    write(output, pilots_);
+    write(output, large_pilots_);
+    write(output, remap_);
+    write(output, keys_);
+    write(output, offsets_);
+    write(output, std::vector<char>(data_.begin(), data_.end()));
+
+    if (!output) {
+      throw std::runtime_error("failed to write the frozen hash table");
+    }
+  }
+
+  FrozenHashTable FrozenHashTable::Load(std::istream &input) {
+    char magic[sizeof(kMagic)];
+    if (!input.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+      throw std::runtime_error("stream does not contain a frozen hash table");
+    }
+
+    FrozenHashTable table;
+    table.seed_ = read<std::uint64_t>(input);
+    table.pilots_ = read_vector<std::uint8_t>(input);
+    table.large_pilots_ = read_vector<std::pair<std::uint32_t, std::uint32_t>>(input);
+    table.remap_ = read_vector<std::uint32_t>(input);
+    table.keys_ = read_vector<int>(input);
+    table.offsets_ = read_vector<std::uint64_t>(input);
+    const auto data = read_vector<char>(input);
+    table.data_.assign(data.begin(), data.end());
+
+    const bool is_empty = table.keys_.empty();
+    const bool is_consistent = is_empty
+                                   ? table.pilots_.empty() && table.offsets_.empty() && table.data_.empty()
+                                   : !table.pilots_.empty() && table.offsets_.size() == table.keys_.size() + 1
+                                         && std::all_of(table.remap_.begin(), table.remap_.end(),
+                                                        [&table](auto slot) { return slot < table.keys_.size(); })
+                                         && table.offsets_.back() == table.data_.size()
+                                         && std::is_sorted(table.offsets_.begin(), table.offsets_.end());
+
+    // pilot() binary-searches the side table, so it must list exactly the marked buckets in increasing order
+    std::size_t num_large = 0;
+    bool has_large_pilots = true;
+    for (std::size_t bucket = 0; bucket < table.pilots_.size() && has_large_pilots; bucket++) {
+      if (table.pilots_[bucket] == kLargePilot) {
+        has_large_pilots = num_large < table.large_pilots_.size() && table.large_pilots_[num_large].first == bucket;
+        num_large++;
+      }
+    }
+    has_large_pilots = has_large_pilots && num_large == table.large_pilots_.size();
+
+    if (!is_consistent || !has_large_pilots) {
+      throw std::runtime_error("frozen hash table stream is corrupted");
+    }
+    return table;
+  }
+
+}  // namespace itis
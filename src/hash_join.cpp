@@ -0,0 +1,210 @@
+#include "hash_join.hpp"
+
+#include <algorithm>  // max, min
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>  // move
+
+#include "utils.hpp"  // prefetch, parallel_for
+
+namespace itis {
+
+  namespace {
+
+    constexpr std::uint32_t kEnd = std::numeric_limits<std::uint32_t>::max();     // end of a bucket chain
+    constexpr std::size_t kRowBytes = sizeof(int) + 2 * sizeof(std::uint32_t);  // key, next row, bucket head
+
+    // Fibonacci hashing: the high bits pick the partition, the bits below them pick the bucket
+    inline std::uint64_t hash(int key) {
+      return static_cast<std::uint64_t>(static_cast<std::uint32_t>(key)) * 11400714819323198485ULL;
+    }
+
+    inline std::size_t partition_of(std::uint64_t hash, int radix_bits) {
+      return radix_bits == 0 ? 0 : static_cast<std::size_t>(hash >> (64 - radix_bits));
+    }
+
+    int resolve_num_threads(int num_threads) {
+      return num_threads > 0 ? num_threads : static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+    }
+
+  }  // namespace
+
+  HashJoin::HashJoin(std::vector<std::pair<int, std::string>> relation, int num_threads, int radix_bits) {
+    if (radix_bits < kAutoRadixBits || radix_bits > kMaxRadixBits) {
+      throw std::logic_error("join radix bits must be in range [0..." + std::to_string(kMaxRadixBits) + "]");
+    }
+    if (relation.size() >= kEnd) {
+      throw std::logic_error("too many rows to build a join table");
+    }
+
+    const auto num_rows = static_cast<std::uint32_t>(relation.size());
+    if (radix_bits == kAutoRadixBits) {
+      radix_bits = 0;
+      while (radix_bits < kMaxRadixBits && (num_rows >> radix_bits) * kRowBytes > kPartitionBytes) {
+        radix_bits++;
+      }
+    }
+    radix_bits_ = radix_bits;
+    partitions_.resize(std::size_t{1} << radix_bits_);
+
+    // histogram of the partition sizes, then their offsets
+    for (const auto &row : relation) {
+      partitions_[partition_of(hash(row.first), radix_bits_)].end++;
+    }
+    std::uint32_t offset = 0;
+    std::uint32_t heads_offset = 0;
+    for (auto &partition : partitions_) {
+      const std::uint32_t size = partition.end;
+      partition.begin = offset;
+      partition.end = offset;  // advanced by the scatter below
+      offset += size;
+
+      while ((std::uint32_t{1} << partition.bucket_bits) < size) {
+        partition.bucket_bits++;
+      }
+      partition.heads_offset = heads_offset;
+      heads_offset += std::uint32_t{1} << partition.bucket_bits;
+    }
+
+    // scatter the rows into their partitions
+    keys_.resize(num_rows);
+    payloads_.resize(num_rows);
+    for (auto &row : relation) {
+      const std::uint32_t position = partitions_[partition_of(hash(row.first), radix_bits_)].end++;
+      keys_[position] = row.first;
+      payloads_[position] = std::move(row.second);
+    }
+    relation.clear();
+
+    heads_.assign(heads_offset, kEnd);
+    next_.assign(num_rows, kEnd);
+
+    // every partition writes its own range of heads_ and next_ only
+    num_threads = std::min(resolve_num_threads(num_threads), static_cast<int>(partitions_.size()));
+    utils::parallel_for(num_threads, [this, num_threads](int first) {
+      for (std::size_t index = first; index < partitions_.size(); index += num_threads) {
+        build(partitions_[index]);
+      }
+    });
+  }
+
+  std::size_t HashJoin::head_of(std::uint64_t hash) const {
+    const Partition &partition = partitions_[partition_of(hash, radix_bits_)];
+    if (partition.bucket_bits == 0) {
+      return partition.heads_offset;
+    }
+    return partition.heads_offset + static_cast<std::size_t>((hash << radix_bits_) >> (64 - partition.bucket_bits));
+  }
+
+  void HashJoin::build(Partition &partition) {
+    // linked from the last row to the first, so a chain lists the rows in the order of the relation
+    for (std::uint32_t row = partition.end; row-- > partition.begin;) {
+      std::uint32_t &head = heads_[head_of(hash(keys_[row]))];
+      next_[row] = head;
+      head = row;
+    }
+  }
+
+  std::size_t HashJoin::probe(const std::vector<int> &keys, std::size_t begin, std::size_t end,
+                              std::size_t batch_size, const BatchCallback &emit) const {
+    if (batch_size == 0) {
+      throw std::logic_error("join batch size must be greater than zero");
+    }
+
+    // the first row of a bucket is reached through two dependent loads (the head, then the row), so they are
+    // prefetched in two stages like in HashTable::SearchBatch
+    const auto prefetch_head = [this, &keys, end](std::size_t index) {
+      if (index < end) {
+        utils::prefetch(&heads_[head_of(hash(keys[index]))]);
+      }
+    };
+    const auto prefetch_row = [this, &keys, end](std::size_t index) {
+      if (index < end) {
+        const std::uint32_t row = heads_[head_of(hash(keys[index]))];
+        if (row != kEnd) {
+          utils::prefetch(&keys_[row]);
+        }
+      }
+    };
+
+    for (std::size_t index = begin; index < std::min(end, begin + 2 * kProbePrefetchDistance); index++) {
+      prefetch_head(index);
+    }
+    for (std::size_t index = begin; index < std::min(end, begin + kProbePrefetchDistance); index++) {
+      prefetch_row(index);
+    }
+
+    std::vector<JoinMatch> batch;
+    batch.reserve(batch_size);
+    std::size_t num_matches = 0;
+
+    for (std::size_t index = begin; index < end; index++) {
+      prefetch_head(index + 2 * kProbePrefetchDistance);
+      prefetch_row(index + kProbePrefetchDistance);
+
+      const int key = keys[index];
+      for (std::uint32_t row = heads_[head_of(hash(key))]; row != kEnd; row = next_[row]) {
+        if (keys_[row] != key) {
+          continue;
+        }
+        batch.push_back(JoinMatch{index, key, payloads_[row]});
+        if (batch.size() == batch_size) {
+          emit(batch);
+          num_matches += batch.size();
+          batch.clear();
+        }
+      }
+    }
+
+    if (!batch.empty()) {
+      emit(batch);
+      num_matches += batch.size();
+    }
+    return num_matches;
+  }
+
+  std::size_t HashJoin::Probe(const std::vector<int> &keys, const BatchCallback &emit, std::size_t batch_size) const {
+    return probe(keys, 0, keys.size(), batch_size, emit);
+  }
+
+  std::size_t HashJoin::ProbeParallel(const std::vector<int> &keys, const ParallelBatchCallback &emit,
+                                      int num_threads, std::size_t batch_size) const {
+    if (batch_size == 0) {
+      throw std::logic_error("join batch size must be greater than zero");
+    }
+
+    num_threads = static_cast<int>(
+        std::min<std::size_t>(resolve_num_threads(num_threads), std::max<std::size_t>(keys.size(), 1)));
+    std::vector<std::size_t> num_matches(num_threads, 0);
+
+    // an exception thrown by emit stops the probing of its thread only and is rethrown here
+    utils::parallel_for(num_threads, [&](int thread) {
+      const std::size_t begin = keys.size() * thread / num_threads;
+      const std::size_t end = keys.size() * (thread + 1) / num_threads;
+      num_matches[thread] =
+          probe(keys, begin, end, batch_size, [&emit, thread](const std::vector<JoinMatch> &batch) {
+            emit(thread, batch);
+          });
+    });
+
+    std::size_t total = 0;
+    for (const auto count : num_matches) {
+      total += count;
+    }
+    return total;
+  }
+
+  int HashJoin::size() const {
+    return static_cast<int>(keys_.size());
+  }
+
+  int HashJoin::num_partitions() const {
+    return static_cast<int>(partitions_.size());
+  }
+
+  int HashJoin::radix_bits() const {
+    return radix_bits_;
+  }
+
+}  // namespace itis
@@ -1,14 +1,41 @@
 #include "hash_table.hpp"
 
+#include <algorithm>  // equal, fill, min
+#include <atomic>     // atomic_thread_fence
+#include <cstdint>
 #include <stdexcept>
+#include <utility>  // move, swap
+
+#include "utils.hpp"  // prefetch, round_up_to_power_of_two
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
 
 namespace itis {
 
+  namespace {
+
+    // use_count() is a relaxed load: a count of 1 left by a snapshot released in another thread only orders that
+    // thread's reads of the object before our writes together with the acquire fence (the release is acq_rel)
+    template <typename T>
+    bool is_unique(const std::shared_ptr<T> &pointer) {
+      if (pointer.use_count() > 1) {
+        return false;
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return true;
+    }
+
+  }  // namespace
+
   int HashTable::hash(int key) const {
-    return utils::hash(key, static_cast<int>(buckets_.size()));
+    return utils::hash(key, capacity_);
   }
 
-  HashTable::HashTable(int capacity, double load_factor) : load_factor_{load_factor} {
+  HashTable::HashTable(int capacity, double load_factor) : load_factor_{load_factor}, capacity_{capacity} {
     if (capacity <= 0) {
       throw std::logic_error("hash table capacity must be greater than zero");
     }
@@ -16,68 +43,371 @@ namespace itis {
     if (load_factor <= 0.0 || load_factor > 1.0) {
       throw std::logic_error("hash table load factor must be in range [0...1]");
     }
-    buckets_.resize(capacity);
+    pages_ = make_pages(capacity);
   }
 
-  std::optional<std::string> HashTable::Search(int key) const {
-    const int index = hash(key);
-    for(auto iterator = buckets_[index].begin(); iterator != buckets_[index].end(); iterator++){
-      if(iterator->first == key){
-        return iterator->second;
+  std::shared_ptr<HashTable::PageTable> HashTable::make_pages(int capacity) {
+    auto pages = std::make_shared<PageTable>();
+    pages->reserve((capacity + kBucketsPerPage - 1) / kBucketsPerPage);
+    for (int first = 0; first < capacity; first += kBucketsPerPage) {
+      pages->push_back(std::make_shared<Page>(std::min(kBucketsPerPage, capacity - first)));
+    }
+    return pages;
+  }
+
+  const HashTable::Bucket &HashTable::bucket(int index) const {
+    return (*(*pages_)[index / kBucketsPerPage])[index % kBucketsPerPage];
+  }
+
+  HashTable::Bucket &HashTable::mutable_bucket(int index) {
+    if (!is_unique(pages_)) {
+      pages_ = std::make_shared<PageTable>(*pages_);
+    }
+
+    std::shared_ptr<Page> &page = (*pages_)[index / kBucketsPerPage];
+    if (!is_unique(page)) {
+      page = std::make_shared<Page>(*page);
+    }
+    return (*page)[index % kBucketsPerPage];
+  }
+
+  int HashTable::find(const BucketBlock &block, int key) {
+#if defined(__AVX2__)
+    const __m256i keys = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.keys));
+    const __m256i matches = _mm256_cmpeq_epi32(keys, _mm256_set1_epi32(key));
+    auto mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(matches)));
+#elif defined(__SSE2__)
+    const __m128i needle = _mm_set1_epi32(key);
+    const __m128i low = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.keys)), needle);
+    const __m128i high = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.keys + 4)), needle);
+    auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(low)))
+              | static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(high))) << 4U;
+#else
+    unsigned mask = 0;
+    for (int slot = 0; slot < BucketBlock::kCapacity; slot++) {
+      mask |= static_cast<unsigned>(block.keys[slot] == key) << static_cast<unsigned>(slot);
+    }
+#endif
+    // ignore matches in the unoccupied slots
+    mask &= (1U << static_cast<unsigned>(block.size)) - 1U;
+
+    for (int slot = 0; mask != 0; slot++, mask >>= 1U) {
+      if ((mask & 1U) != 0) {
+        return slot;
       }
     }
-    return std::nullopt;
+    return -1;
   }
 
-  void HashTable::Put(int key, const std::string &value) {
+  int HashTable::find(const Bucket &bucket, int key) {
+    for (int block = 0; block < static_cast<int>(bucket.size()); block++) {
+      const int slot = find(bucket[block], key);
+      if (slot != -1) {
+        return block * BucketBlock::kCapacity + slot;
+      }
+    }
+    return -1;
+  }
+
+  HashTable::HotKeyCacheSlot &HashTable::hot_key_slot(int key) {
+    // Fibonacci hashing spreads sequential keys over the slots, the high bits are the best mixed ones: for a power
+    // of two number of slots the product below is hash >> (32 - log2(slots))
+    const auto hash = static_cast<std::uint32_t>(static_cast<std::uint32_t>(key) * 2654435769U);
+    return hot_keys_[(static_cast<std::uint64_t>(hash) * hot_keys_.size()) >> 32U];
+  }
+
+  int HashTable::promote(int index, int position) {
+    if (chain_ordering_ == ChainOrdering::kInsertion || position == 0) {
+      return position;
+    }
+
+    // move-to-front shifts the whole prefix of the chain, transpose is a single exchange
+    const int target = chain_ordering_ == ChainOrdering::kMoveToFront ? 0 : position - 1;
+    Bucket &bucket = mutable_bucket(index);
+
+    for (int current = position; current > target; current--) {
+      BucketBlock &from = bucket[current / BucketBlock::kCapacity];
+      BucketBlock &to = bucket[(current - 1) / BucketBlock::kCapacity];
+      const int from_slot = current % BucketBlock::kCapacity;
+      const int to_slot = (current - 1) % BucketBlock::kCapacity;
+
+      std::swap(from.keys[from_slot], to.keys[to_slot]);
+      std::swap(from.values[from_slot], to.values[to_slot]);
+
+      if (!hot_keys_.empty()) {
+        hot_key_slot(from.keys[from_slot]) = HotKeyCacheSlot{};
+      }
+    }
+    return target;
+  }
+
+  int HashTable::locate(int index, int key) {
+    const Bucket &bucket = this->bucket(index);
+    if (hot_keys_.empty()) {
+      return find(bucket, key);
+    }
+
+    HotKeyCacheSlot &slot = hot_key_slot(key);
+    if (slot.bucket == index && slot.key == key) {
+      const int block = slot.position / BucketBlock::kCapacity;
+      const int offset = slot.position % BucketBlock::kCapacity;
+
+      // the pair might have been moved since the slot was filled
+      if (block < static_cast<int>(bucket.size()) && offset < bucket[block].size && bucket[block].keys[offset] == key) {
+        hot_key_stats_.hits++;
+        return slot.position;
+      }
+    }
+
+    hot_key_stats_.misses++;
+    const int position = find(bucket, key);
+    if (position != -1) {
+      slot = HotKeyCacheSlot{key, index, position};
+    }
+    return position;
+  }
+
+  const std::string *HashTable::lookup(int key) const {
+    if (bloom_filter_ && !bloom_filter_->MayContain(key)) {
+      return nullptr;
+    }
+
+    const Bucket &bucket = this->bucket(hash(key));
+    const int position = find(bucket, key);
+    if (position == -1) {
+      return nullptr;
+    }
+    return &bucket[position / BucketBlock::kCapacity].values[position % BucketBlock::kCapacity];
+  }
+
+  const std::string *HashTable::lookup(int key) {
+    if (bloom_filter_ && !bloom_filter_->MayContain(key)) {
+      return nullptr;
+    }
+
     const int index = hash(key);
-    if(ContainsKey(key)) {
-      for (auto iterator = buckets_[index].begin(); iterator != buckets_[index].end(); iterator++) {
-        if (iterator->first == key) {
-          iterator->second = value;
+    const int position = locate(index, key);
+    if (position == -1) {
+      return nullptr;
+    }
+
+    const int target = promote(index, position);
+    if (target != position && !hot_keys_.empty()) {
+      hot_key_slot(key) = HotKeyCacheSlot{key, index, target};
+    }
+
+    // promoting may copy a page shared with a snapshot, so the bucket is looked up again
+    return &bucket(index)[target / BucketBlock::kCapacity].values[target % BucketBlock::kCapacity];
+  }
+
+  std::optional<std::string> HashTable::Search(int key) {
+    const std::string *value = lookup(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  std::optional<std::string> HashTable::Search(int key) const {
+    const std::string *value = lookup(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  template <typename Table>
+  std::vector<std::optional<std::string>> HashTable::search_batch(Table &table, const std::vector<int> &keys) {
+    const int num_keys = static_cast<int>(keys.size());
+    std::vector<std::optional<std::string>> values(keys.size());
+
+    // a bucket is reached through two dependent loads (its header, then its blocks), so they are prefetched in
+    // two stages: the header of the key two distances ahead, and the first block of the key one distance ahead
+    const auto prefetch_header = [&table, &keys, num_keys](int index) {
+      if (index < num_keys) {
+        utils::prefetch(&table.bucket(table.hash(keys[index])));
+      }
+    };
+    const auto prefetch_block = [&table, &keys, num_keys](int index) {
+      if (index < num_keys) {
+        const Bucket &bucket = table.bucket(table.hash(keys[index]));
+        if (!bucket.empty()) {
+          utils::prefetch(bucket.data());
         }
       }
+    };
+
+    for (int index = 0; index < 2 * kBatchPrefetchDistance; index++) {
+      prefetch_header(index);
     }
-    else{
-      buckets_[index].push_back({key,value});
-      num_keys_++;
+    for (int index = 0; index < kBatchPrefetchDistance; index++) {
+      prefetch_block(index);
     }
-    // Tip 1: compute hash code (index) to determine which bucket to use
-    // Tip 2: consider the case when the key exists (read the docs in the header file)
 
-    if (static_cast<double>(num_keys_) / buckets_.size() >= load_factor_) {
-      std::vector<Bucket> newBuckets(this->capacity() * kGrowthCoefficient);
-      for(int i = 0; i < buckets_.size(); ++i){
-        for(const auto &pair : buckets_[i]){
-          auto newHash = utils::hash(pair.first, newBuckets.size());
-          newBuckets[newHash].push_back(pair);
+    for (int index = 0; index < num_keys; index++) {
+      prefetch_header(index + 2 * kBatchPrefetchDistance);
+      prefetch_block(index + kBatchPrefetchDistance);
+
+      const std::string *value = table.lookup(keys[index]);
+      if (value != nullptr) {
+        values[index] = *value;
+      }
+    }
+    return values;
+  }
+
+  std::vector<std::optional<std::string>> HashTable::SearchBatch(const std::vector<int> &keys) {
+    return search_batch(*this, keys);
+  }
+
+  std::vector<std::optional<std::string>> HashTable::SearchBatch(const std::vector<int> &keys) const {
+    return search_batch(*this, keys);
+  }
+
+  void HashTable::Put(int key, const std::string &value) {
+    Bucket &bucket = mutable_bucket(hash(key));
+    const int position = find(bucket, key);
+
+    if (position != -1) {
+      bucket[position / BucketBlock::kCapacity].values[position % BucketBlock::kCapacity] = value;
+      if (!subscribers_.streams.empty()) {
+        publish(ChangeEvent::Type::kPut, key, value);
+      }
+      return;
+    }
+
+    if (bucket.empty() || bucket.back().size == BucketBlock::kCapacity) {
+      bucket.emplace_back();
+    }
+
+    BucketBlock &block = bucket.back();
+    block.keys[block.size] = key;
+    block.values[block.size] = value;
+    block.size++;
+    num_keys_++;
+
+    if (static_cast<double>(num_keys_) / capacity_ >= load_factor_) {
+      rehash(capacity() * kGrowthCoefficient);
+      rebuild_bloom_filter();
+    } else if (bloom_filter_) {
+      bloom_filter_->Insert(key);
+    }
+
+    if (!subscribers_.streams.empty()) {
+      publish(ChangeEvent::Type::kPut, key, value);
+    }
+  }
+
+  void HashTable::rehash(int capacity) {
+    std::shared_ptr<PageTable> new_pages = make_pages(capacity);
+    const bool is_table_owned = is_unique(pages_);
+
+    for (auto &old_page : *pages_) {
+      // pages still shared with a snapshot are copied from, the rest are moved from
+      const bool is_owned = is_table_owned && is_unique(old_page);
+
+      for (auto &old_bucket : *old_page) {
+        for (auto &old_block : old_bucket) {
+          for (int slot = 0; slot < old_block.size; slot++) {
+            const int index = utils::hash(old_block.keys[slot], capacity);
+            Bucket &new_bucket = (*(*new_pages)[index / kBucketsPerPage])[index % kBucketsPerPage];
+            if (new_bucket.empty() || new_bucket.back().size == BucketBlock::kCapacity) {
+              new_bucket.emplace_back();
+            }
+
+            BucketBlock &new_block = new_bucket.back();
+            new_block.keys[new_block.size] = old_block.keys[slot];
+            new_block.values[new_block.size] =
+                is_owned ? std::move(old_block.values[slot]) : old_block.values[slot];
+            new_block.size++;
+          }
         }
       }
-      this -> buckets_ = newBuckets;
     }
+    pages_ = std::move(new_pages);
+    capacity_ = capacity;
+
+    // every cached position refers to the old buckets
+    std::fill(hot_keys_.begin(), hot_keys_.end(), HotKeyCacheSlot{});
   }
 
   std::optional<std::string> HashTable::Remove(int key) {
+    if (bloom_filter_ && !bloom_filter_->MayContain(key)) {
+      return std::nullopt;
+    }
+
     const int index = hash(key);
-    std::string deletedElem = "";
-    if(ContainsKey(key)){
-      for(auto iterator = buckets_[index].begin(); iterator != buckets_[index].end(); iterator ++){
-        if(iterator -> first == key){
-          deletedElem = iterator -> second;
-          buckets_[index].erase(iterator);
-          num_keys_--;
-          return deletedElem;
-        }
+    const int position = find(this->bucket(index), key);
+
+    if (position == -1) {
+      return std::nullopt;
+    }
+
+    Bucket &bucket = mutable_bucket(index);
+    BucketBlock &block = bucket[position / BucketBlock::kCapacity];
+    const int slot = position % BucketBlock::kCapacity;
+    std::string removed = std::move(block.values[slot]);
+
+    // fill the hole with the last pair of the chain, so that only the last block may be partially filled
+    BucketBlock &last_block = bucket.back();
+    const int last_slot = last_block.size - 1;
+    if (&last_block != &block || last_slot != slot) {
+      block.keys[slot] = last_block.keys[last_slot];
+      block.values[slot] = std::move(last_block.values[last_slot]);
+
+      if (!hot_keys_.empty()) {
+        hot_key_slot(block.keys[slot]) = HotKeyCacheSlot{};
+      }
+    }
+
+    if (!hot_keys_.empty()) {
+      hot_key_slot(key) = HotKeyCacheSlot{};
+    }
+
+    last_block.values[last_slot].clear();
+    last_block.size--;
+    if (last_block.size == 0) {
+      bucket.pop_back();
+    }
+
+    num_keys_--;
+
+    // removed keys keep their bits set and raise the false positive rate until the filter is rebuilt
+    if (bloom_filter_ && ++bloom_removals_ > num_keys_) {
+      rebuild_bloom_filter();
+    }
+
+    if (!subscribers_.streams.empty()) {
+      publish(ChangeEvent::Type::kRemove, key, removed);
+    }
+    return removed;
+  }
+
+  std::shared_ptr<ChangeStream> HashTable::Subscribe(std::size_t capacity, ChangeStream::OverflowPolicy policy) {
+    auto stream = std::make_shared<ChangeStream>(capacity, policy);
+    subscribers_.streams.push_back(stream);
+    return stream;
+  }
+
+  void HashTable::publish(ChangeEvent::Type type, int key, const std::string &value) {
+    auto &streams = subscribers_.streams;
+    for (auto weak = streams.begin(); weak != streams.end();) {
+      const std::shared_ptr<ChangeStream> stream = weak->lock();
+      if (!stream || stream->is_closed()) {
+        weak = streams.erase(weak);
+        continue;
       }
+      stream->Publish(type, key, value);
+      ++weak;
     }
-    // Tip 1: compute hash code (index) to determine which bucket to use
-    // TIp 2: find the key-value pair to remove and make a copy of value to return
-    return std::nullopt;
+  }
+
+  bool HashTable::ContainsKey(int key) {
+    return lookup(key) != nullptr;
   }
 
   bool HashTable::ContainsKey(int key) const {
-    // Note: uses Search(key) which is not initially implemented
-    return Search(key).has_value();
+    return lookup(key) != nullptr;
   }
 
   bool HashTable::empty() const {
@@ -89,7 +419,7 @@ namespace itis {
   }
 
   int HashTable::capacity() const {
-    return static_cast<int>(buckets_.size());
+    return capacity_;
   }
 
   double HashTable::load_factor() const {
@@ -98,21 +428,221 @@ namespace itis {
 
   std::unordered_set<int> HashTable::keys() const {
     std::unordered_set<int> keys(num_keys_);
-    for (const auto &bucket : buckets_) {
-      for (const auto &[key, _] : bucket) {
-        keys.insert(key);
-      }
-    }
+    for_each_block(*pages_, [&keys](const BucketBlock &block) { keys.insert(block.keys, block.keys + block.size); });
     return keys;
   }
 
   std::vector<std::string> HashTable::values() const {
     std::vector<std::string> values;
-    for (const auto &bucket : buckets_) {
-      for (const auto &[_, value] : bucket) {
-        values.push_back(value);
+    values.reserve(num_keys_);
+    for_each_block(*pages_, [&values](const BucketBlock &block) {
+      values.insert(values.end(), block.values, block.values + block.size);
+    });
+    return values;
+  }
+
+  void HashTable::EnableHotKeyCache(int num_slots) {
+    if (num_slots <= 0) {
+      throw std::logic_error("hot-key cache size must be greater than zero");
+    }
+
+    hot_keys_.assign(utils::round_up_to_power_of_two(num_slots), HotKeyCacheSlot{});
+    hot_key_stats_ = HotKeyCacheStats{};
+  }
+
+  void HashTable::DisableHotKeyCache() {
+    hot_keys_.clear();
+    hot_keys_.shrink_to_fit();
+    hot_key_stats_ = HotKeyCacheStats{};
+  }
+
+  HashTable::HotKeyCacheStats HashTable::hot_key_cache_stats() const {
+    return hot_key_stats_;
+  }
+
+  void HashTable::set_chain_ordering(ChainOrdering ordering) {
+    chain_ordering_ = ordering;
+  }
+
+  HashTable::ChainOrdering HashTable::chain_ordering() const {
+    return chain_ordering_;
+  }
+
+  int HashTable::ChainPosition(int key) const {
+    return find(bucket(hash(key)), key);
+  }
+
+  BloomFilter HashTable::build_bloom_filter(double false_positive_rate) const {
+    // sized for the number of keys the table holds right before its next growth
+    const auto expected_keys = static_cast<int>(capacity() * load_factor_) + 1;
+    auto filter = BloomFilter(expected_keys, false_positive_rate);
+
+    for_each_block(*pages_, [&filter](const BucketBlock &block) {
+      for (int slot = 0; slot < block.size; slot++) {
+        filter.Insert(block.keys[slot]);
       }
+    });
+    return filter;
+  }
+
+  void HashTable::rebuild_bloom_filter() {
+    if (!bloom_filter_) {
+      return;
     }
+
+    bloom_filter_ = build_bloom_filter(bloom_false_positive_rate_);
+    bloom_removals_ = 0;
+  }
+
+  void HashTable::EnableBloomFilter(double false_positive_rate) {
+    // the new filter is built before anything changes, so an invalid rate leaves the current filter untouched
+    bloom_filter_ = build_bloom_filter(false_positive_rate);
+    bloom_false_positive_rate_ = false_positive_rate;
+    bloom_removals_ = 0;
+  }
+
+  void HashTable::DisableBloomFilter() {
+    bloom_filter_.reset();
+    bloom_removals_ = 0;
+  }
+
+  int HashTable::bloom_filter_bytes() const {
+    return bloom_filter_ ? bloom_filter_->bytes() : 0;
+  }
+
+  FrozenHashTable HashTable::Freeze() const {
+    std::vector<std::pair<int, std::string>> pairs;
+    pairs.reserve(num_keys_);
+    for_each_block(*pages_, [&pairs](const BucketBlock &block) {
+      for (int slot = 0; slot < block.size; slot++) {
+        pairs.emplace_back(block.keys[slot], block.values[slot]);
+      }
+    });
+    return FrozenHashTable(pairs);
+  }
+
+  namespace {
+
+    constexpr char kMagic[8] = {'I', 'T', 'I', 'S', 'H', 'T', 'B', '1'};
+
+    template <typename T>
+    void write(std::ostream &output, const T &value) {
+      output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T read(std::istream &input) {
+      T value{};
+      if (!input.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+        throw std::runtime_error("hash table stream is truncated");
+      }
+      return value;
+    }
+
+  }  // namespace
+
+  void HashTable::Save(std::ostream &output) const {
+    output.write(kMagic, sizeof(kMagic));
+    write(output, capacity_);
+    write(output, load_factor_);
+    write(output, num_keys_);
+
+    for_each_block(*pages_, [&output](const BucketBlock &block) {
+      for (int slot = 0; slot < block.size; slot++) {
+        write(output, block.keys[slot]);
+        write(output, static_cast<std::uint64_t>(block.values[slot].size()));
+        output.write(block.values[slot].data(), static_cast<std::streamsize>(block.values[slot].size()));
+      }
+    });
+
+    if (!output) {
+      throw std::runtime_error("failed to write the hash table");
+    }
+  }
+
+  HashTable HashTable::Load(std::istream &input) {
+    char magic[sizeof(kMagic)];
+    if (!input.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+      throw std::runtime_error("stream does not contain a hash table");
+    }
+
+    const auto capacity = read<int>(input);
+    const auto load_factor = read<double>(input);
+    const auto num_keys = read<int>(input);
+    if (capacity <= 0 || !(load_factor > 0.0 && load_factor <= 1.0) || num_keys < 0) {
+      throw std::runtime_error("hash table stream is corrupted");
+    }
+
+    HashTable table(capacity, load_factor);
+    std::string value;
+    for (int index = 0; index < num_keys; index++) {
+      const auto key = read<int>(input);
+      const auto size = read<std::uint64_t>(input);
+
+      // grow while reading, so that a corrupted size cannot trigger a huge allocation
+      constexpr std::uint64_t kChunk = 1U << 16U;
+      value.clear();
+      for (std::uint64_t done = 0; done < size; done += kChunk) {
+        const std::uint64_t count = std::min(kChunk, size - done);
+        value.resize(done + count);
+        if (!input.read(&value[done], static_cast<std::streamsize>(count))) {
+          throw std::runtime_error("hash table stream is truncated");
+        }
+      }
+      table.Put(key, value);
+    }
+
+    if (table.size() != num_keys) {
+      throw std::runtime_error("hash table stream is corrupted");
+    }
+    return table;
+  }
+
+  HashTableSnapshot HashTable::Snapshot() const {
+    return HashTableSnapshot(pages_, capacity_, num_keys_);
+  }
+
+  HashTableSnapshot::HashTableSnapshot(std::shared_ptr<const HashTable::PageTable> pages, int capacity, int num_keys)
+      : pages_{std::move(pages)}, capacity_{capacity}, num_keys_{num_keys} {}
+
+  std::optional<std::string> HashTableSnapshot::Search(int key) const {
+    const int index = utils::hash(key, capacity_);
+    const auto &page = *(*pages_)[index / HashTable::kBucketsPerPage];
+    const HashTable::Bucket &bucket = page[index % HashTable::kBucketsPerPage];
+
+    const int position = HashTable::find(bucket, key);
+    if (position == -1) {
+      return std::nullopt;
+    }
+    return bucket[position / HashTable::BucketBlock::kCapacity].values[position % HashTable::BucketBlock::kCapacity];
+  }
+
+  bool HashTableSnapshot::ContainsKey(int key) const {
+    return Search(key).has_value();
+  }
+
+  bool HashTableSnapshot::empty() const {
+    return size() == 0;
+  }
+
+  int HashTableSnapshot::size() const {
+    return num_keys_;
+  }
+
+  std::unordered_set<int> HashTableSnapshot::keys() const {
+    std::unordered_set<int> keys(num_keys_);
+    HashTable::for_each_block(*pages_, [&keys](const HashTable::BucketBlock &block) {
+      keys.insert(block.keys, block.keys + block.size);
+    });
+    return keys;
+  }
+
+  std::vector<std::string> HashTableSnapshot::values() const {
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    HashTable::for_each_block(*pages_, [&values](const HashTable::BucketBlock &block) {
+      values.insert(values.end(), block.values, block.values + block.size);
+    });
     return values;
   }
 
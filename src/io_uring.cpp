@@ -0,0 +1,149 @@
+#include "io_uring.hpp"
+
+#include <algorithm>  // max
+#include <cerrno>
+#include <cstring>  // memset
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace itis {
+
+  namespace {
+
+    int io_uring_setup(unsigned entries, io_uring_params *params) {
+      return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+      return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int io_uring_register(int fd, unsigned opcode, void *argument, unsigned num_arguments) {
+      return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, argument, num_arguments));
+    }
+
+  }  // namespace
+
+  IoUring::IoUring(unsigned entries) {
+    io_uring_params params{};
+    fd_ = io_uring_setup(entries, &params);
+    if (fd_ == -1) {
+      throw std::runtime_error("io_uring is not available");
+    }
+
+    // the submission and completion rings share one mapping since Linux 5.4
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0) {
+      release();
+      throw std::runtime_error("io_uring is too old");
+    }
+
+    sq_ring_bytes_ = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    sq_ring_ = mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                    IORING_OFF_SQ_RING);
+    sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+
+    if (sq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+      sq_ring_ = sq_ring_ == MAP_FAILED ? nullptr : sq_ring_;
+      sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe *>(sqes);
+      release();
+      throw std::runtime_error("failed to map the io_uring rings");
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto *ring = static_cast<char *>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned *>(ring + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(ring + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<unsigned *>(ring + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<unsigned *>(ring + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+
+    cq_head_ = reinterpret_cast<unsigned *>(ring + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(ring + params.cq_off.tail);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+    cq_mask_ = *reinterpret_cast<unsigned *>(ring + params.cq_off.ring_mask);
+  }
+
+  IoUring::~IoUring() {
+    release();
+  }
+
+  void IoUring::release() {
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_bytes_);
+      sqes_ = nullptr;
+    }
+    if (sq_ring_ != nullptr) {
+      munmap(sq_ring_, sq_ring_bytes_);
+      sq_ring_ = nullptr;
+    }
+    if (fd_ != -1) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  io_uring_sqe *IoUring::GetSqe() {
+    const auto is_full = [this] {
+      return *sq_tail_ + sq_pending_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_;
+    };
+
+    if (is_full()) {
+      SubmitAndWait(0);
+      // a busy or interrupted io_uring_enter consumes nothing, and the slot still holds an unsubmitted entry
+      if (is_full()) {
+        throw std::runtime_error("io_uring submission queue is full");
+      }
+    }
+
+    const unsigned index = (*sq_tail_ + sq_pending_) & sq_mask_;
+    sq_pending_++;
+
+    io_uring_sqe *sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  void IoUring::SubmitAndWait(unsigned min_completions) {
+    __atomic_store_n(sq_tail_, *sq_tail_ + sq_pending_, __ATOMIC_RELEASE);
+    sq_pending_ = 0;
+
+    const unsigned flags = min_completions > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+      // including the entries left unconsumed by an interrupted or busy previous call
+      const unsigned to_submit = *sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+      if (io_uring_enter(fd_, to_submit, min_completions, flags) != -1) {
+        return;
+      }
+
+      // EBUSY/EAGAIN - the completion queue is full, the caller drains it and submits again
+      if (errno == EBUSY || errno == EAGAIN || (errno == EINTR && min_completions == 0)) {
+        return;
+      }
+      if (errno != EINTR) {
+        throw std::runtime_error("io_uring_enter failed");
+      }
+    }
+  }
+
+  void IoUring::RegisterBufferRing(io_uring_buf_ring *ring, unsigned entries, std::uint16_t group) {
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<std::uint64_t>(ring);
+    registration.ring_entries = entries;
+    registration.bgid = group;
+
+    if (io_uring_register(fd_, IORING_REGISTER_PBUF_RING, &registration, 1) == -1) {
+      throw std::runtime_error("io_uring buffer rings are not supported");
+    }
+  }
+
+  int IoUring::fd() const {
+    return fd_;
+  }
+
+}  // namespace itis
@@ -0,0 +1,527 @@
+#include "kv_server.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>   // to_string
+#include <utility>  // swap
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "io_uring.hpp"
+#include "memcached_protocol.hpp"
+
+namespace itis {
+
+  namespace {
+
+    constexpr int kMaxEvents = 256;
+    constexpr std::uint16_t kBufferGroup = 0;
+
+    // io_uring operations, stored in the upper half of the user data (the lower half is the file descriptor)
+    enum Operation : std::uint64_t { kAccept = 1, kRecv, kSend, kStop, kCancel };
+
+    std::uint64_t user_data(Operation operation, int fd) {
+      return (static_cast<std::uint64_t>(operation) << 32U) | static_cast<std::uint32_t>(fd);
+    }
+
+    void watch(int epoll_fd, int operation, int fd, std::uint32_t events) {
+      epoll_event event{};
+      event.events = events;
+      event.data.fd = fd;
+      if (epoll_ctl(epoll_fd, operation, fd, &event) == -1) {
+        throw std::runtime_error("failed to watch a socket with epoll");
+      }
+    }
+
+  }  // namespace
+
+  KvServer::KvServer(HashTable &table, int port, Backend backend) : table_{table} {
+    // io_uring completes operations on blocking descriptors asynchronously, but fails them on non-blocking ones
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (listen_fd_ == -1 || stop_fd_ == -1) {
+      close_sockets();
+      throw std::runtime_error("failed to create the server sockets");
+    }
+
+    const int enable = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<std::uint16_t>(port));
+    socklen_t length = sizeof(address);
+
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1
+        || listen(listen_fd_, SOMAXCONN) == -1
+        || getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address), &length) == -1) {
+      close_sockets();
+      throw std::runtime_error("failed to listen on port " + std::to_string(port));
+    }
+    port_ = ntohs(address.sin_port);
+
+    if (backend != Backend::kEpoll && setup_io_uring()) {
+      return;
+    }
+    if (backend == Backend::kIoUring) {
+      close_sockets();
+      throw std::runtime_error("io_uring is not available");
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1 || fcntl(listen_fd_, F_SETFL, O_NONBLOCK) == -1) {
+      close_sockets();
+      throw std::runtime_error("failed to set up epoll");
+    }
+    watch(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+    watch(epoll_fd_, EPOLL_CTL_ADD, stop_fd_, EPOLLIN);
+  }
+
+  KvServer::~KvServer() {
+    close_sockets();
+  }
+
+  void KvServer::close_sockets() {
+    for (const auto &[fd, connection] : connections_) {
+      close(fd);
+    }
+    connections_.clear();
+
+    for (int *fd : {&listen_fd_, &epoll_fd_, &stop_fd_}) {
+      if (*fd != -1) {
+        close(*fd);
+        *fd = -1;
+      }
+    }
+
+    ring_.reset();
+    if (buffer_ring_ != nullptr) {
+      munmap(buffer_ring_, kNumBuffers * sizeof(io_uring_buf));
+      buffer_ring_ = nullptr;
+    }
+  }
+
+  void KvServer::accept_connections() {
+    while (true) {
+      const int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd == -1) {
+        if (errno == EMFILE || errno == ENFILE) {
+          // the pending connection keeps the level-triggered socket readable, which would spin the loop
+          epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, listen_fd_, nullptr);
+          is_accept_paused_ = true;
+        }
+        // EAGAIN - no more pending connections; other errors are retried on the next event
+        return;
+      }
+
+      const int enable = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+      connections_.emplace(fd, Connection{});
+      watch(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN | EPOLLRDHUP);
+    }
+  }
+
+  void KvServer::receive(int fd, Connection &connection) {
+    char chunk[kReadChunkBytes];
+
+    // the socket is level-triggered, so the bytes left unread are reported again by the next epoll_wait
+    for (int reads = 0; reads < kMaxReadsPerEvent && !is_backlogged(connection); reads++) {
+      const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+      if (received > 0) {
+        connection.input.append(chunk, static_cast<std::size_t>(received));
+        continue;
+      }
+      if (received == -1 && errno == EINTR) {
+        continue;
+      }
+      if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        connection.is_closing = true;  // the requests received so far are still served
+      }
+      break;
+    }
+
+    serve(connection);
+  }
+
+  void KvServer::serve(Connection &connection) {
+    if (connection.output.size() + connection.sending.size() >= kMaxBufferedBytes) {
+      return;  // the requests are served once the client reads its responses
+    }
+
+    // the responses still being sent count towards the limit as well
+    bool is_closing = false;
+    const std::size_t max_output = kMaxBufferedBytes - connection.sending.size();
+    const std::size_t consumed =
+        memcached::Process(connection.input, table_, connection.output, max_output, is_closing);
+    connection.input.erase(0, consumed);
+    if (is_closing) {
+      connection.input.clear();  // the requests after a quit are never served
+    }
+    connection.is_closing = connection.is_closing || is_closing;
+  }
+
+  bool KvServer::is_backlogged(const Connection &connection) {
+    return connection.input.size() >= kMaxBufferedBytes
+        || connection.output.size() + connection.sending.size() >= kMaxBufferedBytes;
+  }
+
+  void KvServer::resume_accept() {
+    if (!is_accept_paused_) {
+      return;
+    }
+    is_accept_paused_ = false;
+
+    if (ring_) {
+      submit_accept();
+    } else {
+      watch(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN);
+    }
+  }
+
+  bool KvServer::send_output(int fd, Connection &connection) {
+    iovec vectors[kMaxIoVectors];
+
+    // sendmsg is writev with flags (MSG_NOSIGNAL: a closed peer is an error, not a SIGPIPE)
+    while (!connection.output.empty()) {
+      msghdr message{};
+      message.msg_iov = vectors;
+      message.msg_iovlen = static_cast<std::size_t>(connection.output.Gather(vectors, kMaxIoVectors));
+
+      const ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+      if (sent == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      connection.output.Consume(static_cast<std::size_t>(sent));
+    }
+    return true;
+  }
+
+  void KvServer::update(int fd, Connection &connection) {
+    while (true) {
+      if (!send_output(fd, connection)) {
+        close_connection(fd);
+        return;
+      }
+      if (!connection.output.empty() || connection.input.empty()) {
+        break;
+      }
+
+      // the requests held back by the output limit, the client may be waiting for them without sending more
+      const std::size_t pending = connection.input.size();
+      serve(connection);
+      if (connection.input.size() == pending) {
+        break;  // an incomplete request
+      }
+    }
+
+    const bool has_output = !connection.output.empty();
+    if (connection.is_closing && !has_output) {
+      close_connection(fd);
+      return;
+    }
+
+    watch(epoll_fd_, EPOLL_CTL_MOD, fd, has_output ? EPOLLOUT : EPOLLIN | EPOLLRDHUP);
+  }
+
+  void KvServer::close_connection(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(fd);
+    resume_accept();
+  }
+
+  void KvServer::Run() {
+    if (ring_) {
+      run_io_uring();
+    } else {
+      run_epoll();
+    }
+  }
+
+  void KvServer::run_epoll() {
+    epoll_event events[kMaxEvents];
+
+    while (true) {
+      const int num_events = epoll_wait(epoll_fd_, events, kMaxEvents, -1);
+      if (num_events == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("epoll_wait failed");
+      }
+
+      for (int index = 0; index < num_events; index++) {
+        const int fd = events[index].data.fd;
+
+        if (fd == stop_fd_) {
+          std::uint64_t value = 0;
+          static_cast<void>(read(stop_fd_, &value, sizeof(value)));
+          return;
+        }
+
+        if (fd == listen_fd_) {
+          accept_connections();
+          continue;
+        }
+
+        const auto found = connections_.find(fd);
+        if (found == connections_.end()) {
+          continue;
+        }
+
+        Connection &connection = found->second;
+        if ((events[index].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0
+            && connection.output.empty()) {
+          receive(fd, connection);
+        }
+        update(fd, connection);
+      }
+    }
+  }
+
+  void KvServer::Stop() {
+    const std::uint64_t value = 1;
+    static_cast<void>(write(stop_fd_, &value, sizeof(value)));
+  }
+
+  bool KvServer::setup_io_uring() {
+    try {
+      ring_ = std::make_unique<IoUring>(kRingEntries);
+
+      void *memory = mmap(nullptr, kNumBuffers * sizeof(io_uring_buf), PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (memory == MAP_FAILED) {
+        throw std::runtime_error("failed to allocate the buffer ring");
+      }
+      buffer_ring_ = static_cast<io_uring_buf_ring *>(memory);
+      ring_->RegisterBufferRing(buffer_ring_, kNumBuffers, kBufferGroup);
+    } catch (const std::runtime_error &) {
+      ring_.reset();
+      if (buffer_ring_ != nullptr) {
+        munmap(buffer_ring_, kNumBuffers * sizeof(io_uring_buf));
+        buffer_ring_ = nullptr;
+      }
+      return false;
+    }
+
+    buffers_.resize(kNumBuffers * kBufferBytes);
+    for (unsigned id = 0; id < kNumBuffers; id++) {
+      recycle_buffer(static_cast<std::uint16_t>(id));
+    }
+    return true;
+  }
+
+  void KvServer::recycle_buffer(std::uint16_t id) {
+    io_uring_buf &buffer = reinterpret_cast<io_uring_buf *>(buffer_ring_)[buffer_ring_tail_ & (kNumBuffers - 1)];
+    buffer.addr = reinterpret_cast<std::uint64_t>(&buffers_[id * kBufferBytes]);
+    buffer.len = kBufferBytes;
+    buffer.bid = id;
+
+    buffer_ring_tail_++;
+    __atomic_store_n(&buffer_ring_->tail, buffer_ring_tail_, __ATOMIC_RELEASE);
+  }
+
+  void KvServer::submit_accept() {
+    io_uring_sqe *sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = user_data(kAccept, listen_fd_);
+  }
+
+  void KvServer::submit_recv(int fd) {
+    io_uring_sqe *sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = user_data(kRecv, fd);
+    connections_[fd].is_receiving = true;
+  }
+
+  void KvServer::submit_cancel_recv(int fd) {
+    io_uring_sqe *sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = user_data(kRecv, fd);
+    sqe->user_data = user_data(kCancel, fd);
+    connections_[fd].is_cancelling = true;
+  }
+
+  void KvServer::submit_send(int fd, Connection &connection) {
+    if (connection.is_sending) {
+      return;
+    }
+
+    if (connection.sending.empty()) {
+      std::swap(connection.sending, connection.output);
+      if (connection.sending.empty()) {
+        return;
+      }
+    }
+
+    // the vectors must stay valid until the completion, so they live in the connection
+    connection.message = msghdr{};
+    connection.message.msg_iov = connection.vectors;
+    connection.message.msg_iovlen =
+        static_cast<std::size_t>(connection.sending.Gather(connection.vectors, kMaxIoVectors));
+
+    io_uring_sqe *sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&connection.message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data(kSend, fd);
+    connection.is_sending = true;
+  }
+
+  void KvServer::finish(int fd, Connection &connection) {
+    const bool has_output = !connection.output.empty() || !connection.sending.empty();
+    if (!connection.is_closing || connection.is_sending || has_output) {
+      return;
+    }
+
+    if (connection.is_receiving) {
+      // the recv completes with 0 bytes and without IORING_CQE_F_MORE, then the descriptor can be closed
+      if (!connection.is_shut_down) {
+        shutdown(fd, SHUT_RDWR);
+        connection.is_shut_down = true;
+      }
+      return;
+    }
+
+    close(fd);
+    connections_.erase(fd);
+    resume_accept();
+  }
+
+  bool KvServer::handle_completion(const io_uring_cqe &cqe) {
+    const auto operation = static_cast<Operation>(cqe.user_data >> 32U);
+    const auto fd = static_cast<int>(cqe.user_data & 0xFFFFFFFFU);
+    const bool has_more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    if (operation == kStop) {
+      return true;
+    }
+    if (operation == kCancel) {
+      return false;  // the cancelled recv completes on its own
+    }
+
+    if (operation == kAccept) {
+      if (cqe.res >= 0) {
+        const int enable = 1;
+        setsockopt(cqe.res, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        connections_.emplace(cqe.res, Connection{});
+        submit_recv(cqe.res);
+      }
+      if (!has_more) {
+        // re-arming right away would fail again until a descriptor is freed
+        if (cqe.res == -EMFILE || cqe.res == -ENFILE) {
+          is_accept_paused_ = true;
+        } else {
+          submit_accept();
+        }
+      }
+      return false;
+    }
+
+    const auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+      return false;
+    }
+    Connection &connection = found->second;
+
+    if (operation == kRecv) {
+      if (cqe.res > 0) {
+        const auto id = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (!connection.is_closing) {
+          connection.input.append(&buffers_[id * kBufferBytes], static_cast<std::size_t>(cqe.res));
+        }
+        recycle_buffer(id);
+        serve(connection);
+
+        if (has_more && !connection.is_cancelling && is_backlogged(connection)) {
+          submit_cancel_recv(fd);
+        }
+      } else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED) {
+        connection.is_closing = true;  // end of the stream or an error
+      }
+
+      if (!has_more) {
+        connection.is_receiving = false;
+        connection.is_cancelling = false;
+        if (!connection.is_closing && !is_backlogged(connection)) {
+          submit_recv(fd);  // e.g. the buffers ran out (ENOBUFS)
+        }
+      }
+    } else if (operation == kSend) {
+      connection.is_sending = false;
+      if (cqe.res < 0) {
+        connection.is_closing = true;
+        connection.output.clear();
+        connection.sending.clear();
+      } else {
+        connection.sending.Consume(static_cast<std::size_t>(cqe.res));
+
+        // the requests held back while the client was not reading
+        serve(connection);
+        if (!connection.is_receiving && !connection.is_closing && !is_backlogged(connection)) {
+          submit_recv(fd);
+        }
+      }
+    }
+
+    submit_send(fd, connection);
+    finish(fd, connection);
+    return false;
+  }
+
+  void KvServer::run_io_uring() {
+    submit_accept();
+
+    io_uring_sqe *sqe = ring_->GetSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = stop_fd_;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&stop_value_);
+    sqe->len = sizeof(stop_value_);
+    sqe->user_data = user_data(kStop, stop_fd_);
+
+    while (true) {
+      // submits everything prepared by the previous batch of completions and waits for the next one
+      ring_->SubmitAndWait(1);
+
+      bool is_stopped = false;
+      ring_->ForEachCqe([this, &is_stopped](const io_uring_cqe &cqe) {
+        is_stopped = handle_completion(cqe) || is_stopped;
+      });
+      if (is_stopped) {
+        return;
+      }
+    }
+  }
+
+  int KvServer::port() const {
+    return port_;
+  }
+
+  KvServer::Backend KvServer::backend() const {
+    return ring_ ? Backend::kIoUring : Backend::kEpoll;
+  }
+
+}  // namespace itis
@@ -0,0 +1,179 @@
+#include "lru_hash_table.hpp"
+
+#include <cmath>  // ceil
+#include <stdexcept>
+
+namespace itis {
+
+  int LruHashTable::hash(int key) const {
+    return static_cast<int>(static_cast<unsigned>(key) % static_cast<unsigned>(buckets_.size()));
+  }
+
+  LruHashTable::LruHashTable(int max_keys, std::size_t max_bytes, double load_factor)
+      : max_keys_{max_keys}, max_bytes_{max_bytes}, load_factor_{load_factor} {
+    if (max_keys <= 0) {
+      throw std::logic_error("hash table max number of keys must be greater than zero");
+    }
+
+    if (load_factor <= 0.0 || load_factor > 1.0) {
+      throw std::logic_error("hash table load factor must be in range [0...1]");
+    }
+
+    buckets_.resize(static_cast<std::size_t>(std::ceil(max_keys / load_factor)), nullptr);
+  }
+
+  LruHashTable::~LruHashTable() {
+    while (head_ != nullptr) {
+      Node *next = head_->next;
+      delete head_;
+      head_ = next;
+    }
+  }
+
+  LruHashTable::Node *LruHashTable::find(int key) const {
+    for (Node *node = buckets_[hash(key)]; node != nullptr; node = node->next_in_bucket) {
+      if (node->key == key) {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  void LruHashTable::link_front(Node *node) {
+    node->prev = nullptr;
+    node->next = head_;
+    if (head_ != nullptr) {
+      head_->prev = node;
+    }
+    head_ = node;
+    if (tail_ == nullptr) {
+      tail_ = node;
+    }
+  }
+
+  void LruHashTable::unlink(Node *node) {
+    (node->prev != nullptr ? node->prev->next : head_) = node->next;
+    (node->next != nullptr ? node->next->prev : tail_) = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+  }
+
+  void LruHashTable::erase(Node *node) {
+    Node **link = &buckets_[hash(node->key)];
+    while (*link != node) {
+      link = &(*link)->next_in_bucket;
+    }
+    *link = node->next_in_bucket;
+
+    unlink(node);
+    num_keys_--;
+    num_bytes_ -= node->value.size();
+    delete node;
+  }
+
+  void LruHashTable::evict() {
+    while (num_keys_ > max_keys_ || (max_bytes_ != kUnlimitedBytes && num_bytes_ > max_bytes_)) {
+      erase(tail_);
+      num_evictions_++;
+    }
+  }
+
+  std::optional<std::string> LruHashTable::Search(int key) {
+    Node *node = find(key);
+    if (node == nullptr) {
+      return std::nullopt;
+    }
+
+    if (node != head_) {
+      unlink(node);
+      link_front(node);
+    }
+    return node->value;
+  }
+
+  void LruHashTable::Put(int key, const std::string &value) {
+    if (max_bytes_ != kUnlimitedBytes && value.size() > max_bytes_) {
+      throw std::logic_error("value size exceeds the hash table bytes limit");
+    }
+
+    Node *node = find(key);
+    if (node != nullptr) {
+      num_bytes_ = num_bytes_ - node->value.size() + value.size();
+      node->value = value;
+      unlink(node);
+    } else {
+      Node *&bucket = buckets_[hash(key)];
+      node = new Node{key, value, bucket};
+      bucket = node;
+      num_keys_++;
+      num_bytes_ += value.size();
+    }
+    link_front(node);
+
+    // the new pair is at the head of the recency list, so it is evicted last
+    evict();
+  }
+
+  std::optional<std::string> LruHashTable::Remove(int key) {
+    Node *node = find(key);
+    if (node == nullptr) {
+      return std::nullopt;
+    }
+
+    std::string removed = std::move(node->value);
+    num_bytes_ -= removed.size();
+    node->value.clear();
+    erase(node);
+    return removed;
+  }
+
+  bool LruHashTable::ContainsKey(int key) const {
+    return find(key) != nullptr;
+  }
+
+  bool LruHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int LruHashTable::size() const {
+    return num_keys_;
+  }
+
+  int LruHashTable::capacity() const {
+    return static_cast<int>(buckets_.size());
+  }
+
+  int LruHashTable::max_keys() const {
+    return max_keys_;
+  }
+
+  std::size_t LruHashTable::max_bytes() const {
+    return max_bytes_;
+  }
+
+  std::size_t LruHashTable::bytes() const {
+    return num_bytes_;
+  }
+
+  int LruHashTable::evictions() const {
+    return num_evictions_;
+  }
+
+  std::unordered_set<int> LruHashTable::keys() const {
+    std::unordered_set<int> keys(num_keys_);
+    for (const Node *node = head_; node != nullptr; node = node->next) {
+      keys.insert(node->key);
+    }
+    return keys;
+  }
+
+  std::vector<std::string> LruHashTable::values() const {
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    for (const Node *node = head_; node != nullptr; node = node->next) {
+      values.push_back(node->value);
+    }
+    return values;
+  }
+
+}  // namespace itis
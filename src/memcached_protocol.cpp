@@ -0,0 +1,402 @@
+#include "memcached_protocol.hpp"
+
+#include <algorithm>  // min
+#include <charconv>   // from_chars
+#include <string>     // to_string
+#include <utility>    // move
+
+#include <sys/uio.h>
+
+namespace itis::memcached {
+
+  namespace {
+
+    constexpr std::string_view kVersion = "VERSION itis-hash-table 1.0";
+    constexpr std::size_t kMaxBatchKeys = 256;  // pending get keys looked up at once (bounds the discarded lookups)
+
+    std::vector<std::string_view> split(std::string_view line) {
+      std::vector<std::string_view> tokens;
+      std::size_t begin = 0;
+      while (begin < line.size()) {
+        if (line[begin] == ' ') {
+          begin++;
+          continue;
+        }
+        std::size_t end = line.find(' ', begin);
+        end = end == std::string_view::npos ? line.size() : end;
+        tokens.push_back(line.substr(begin, end - begin));
+        begin = end;
+      }
+      return tokens;
+    }
+
+    // the whole token must be a number
+    template <typename T>
+    bool parse_number(std::string_view token, T &value) {
+      const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+      return error == std::errc{} && end == token.data() + token.size();
+    }
+
+    void fail(Request &request, std::string error, bool is_fatal = false) {
+      request.command = Command::kError;
+      request.error = std::move(error);
+      request.is_fatal = is_fatal;
+    }
+
+    // first line of a VALUE block
+    void append_value_header(int key, std::size_t size, std::string &output) {
+      output += "VALUE ";
+      output += std::to_string(key);
+      output += " 0 ";
+      output += std::to_string(size);
+      output += "\r\n";
+    }
+
+    // keys of a run of consecutive gets: the keys of get i are keys[ends[i - 1]...ends[i])
+    struct PendingGets {
+      std::vector<int> keys;
+      std::vector<std::size_t> ends;
+      std::vector<std::size_t> offsets;  // input offset after every get
+    };
+
+    // serve the gets with one batched lookup until the output reaches the limit
+    // @return input offset after the last served get (the given offset if no get is pending)
+    std::size_t execute_gets(PendingGets &gets, const HashTable &table, Output &output, std::size_t max_output,
+                             std::size_t offset) {
+      if (gets.ends.empty()) {
+        return offset;
+      }
+
+      auto values = table.SearchBatch(gets.keys);
+      std::string header;
+      std::size_t index = 0;
+
+      for (std::size_t get = 0; get < gets.ends.size(); get++) {
+        for (; index < gets.ends[get]; index++) {
+          auto &value = values[index];
+          if (value) {
+            header.clear();
+            append_value_header(gets.keys[index], value->size(), header);
+            output.Append(header);
+            output.AppendValue(std::move(*value));
+            output.Append("\r\n");
+          }
+        }
+        output.Append("END\r\n");
+        offset = gets.offsets[get];
+
+        if (output.size() >= max_output) {
+          break;  // the following gets stay in the input
+        }
+      }
+
+      gets.keys.clear();
+      gets.ends.clear();
+      gets.offsets.clear();
+      return offset;
+    }
+
+  }  // namespace
+
+  void Output::Append(std::string_view text) {
+    if (text.empty()) {
+      return;
+    }
+
+    // extend the last segment if it ends where the text goes
+    if (!segments_.empty() && segments_.back().value == -1
+        && segments_.back().offset + segments_.back().size == text_.size()) {
+      segments_.back().size += text.size();
+    } else {
+      segments_.push_back(Segment{text_.size(), text.size(), -1});
+    }
+    text_ += text;
+    size_ += text.size();
+  }
+
+  void Output::AppendValue(std::string &&value) {
+    if (value.size() < kMinMovedValueBytes) {
+      Append(value);
+      return;
+    }
+
+    segments_.push_back(Segment{0, value.size(), static_cast<int>(values_.size())});
+    size_ += value.size();
+    values_.push_back(std::move(value));
+  }
+
+  int Output::Gather(iovec *vectors, int max_vectors) const {
+    int count = 0;
+    std::size_t offset = first_offset_;
+
+    for (std::size_t index = first_segment_; index < segments_.size() && count < max_vectors; index++) {
+      const Segment &segment = segments_[index];
+      const char *data = segment.value == -1 ? text_.data() + segment.offset : values_[segment.value].data();
+      vectors[count].iov_base = const_cast<char *>(data + offset);
+      vectors[count].iov_len = segment.size - offset;
+      count++;
+      offset = 0;
+    }
+    return count;
+  }
+
+  void Output::Consume(std::size_t bytes) {
+    bytes = std::min(bytes, size_);
+    size_ -= bytes;
+
+    while (bytes > 0) {
+      const std::size_t left = segments_[first_segment_].size - first_offset_;
+      if (bytes < left) {
+        first_offset_ += bytes;
+        return;
+      }
+      bytes -= left;
+      first_segment_++;
+      first_offset_ = 0;
+    }
+
+    if (size_ == 0) {
+      clear();  // keeps the capacity of the buffers for the next responses
+    }
+  }
+
+  void Output::clear() {
+    text_.clear();
+    values_.clear();
+    segments_.clear();
+    first_segment_ = 0;
+    first_offset_ = 0;
+    size_ = 0;
+  }
+
+  bool Output::empty() const {
+    return size_ == 0;
+  }
+
+  std::size_t Output::size() const {
+    return size_;
+  }
+
+  std::string Output::str() const {
+    std::string result;
+    result.reserve(size_);
+
+    std::size_t offset = first_offset_;
+    for (std::size_t index = first_segment_; index < segments_.size(); index++) {
+      const Segment &segment = segments_[index];
+      const std::string &source = segment.value == -1 ? text_ : values_[segment.value];
+      result.append(source, segment.offset + offset, segment.size - offset);
+      offset = 0;
+    }
+    return result;
+  }
+
+  ParseStatus Parse(std::string_view input, Request &request, std::size_t &consumed) {
+    request = Request{};
+
+    const std::size_t newline = input.substr(0, kMaxLineBytes + 2).find('\n');
+    if (newline == std::string_view::npos) {
+      if (input.size() <= kMaxLineBytes) {
+        return ParseStatus::kIncomplete;
+      }
+      consumed = input.size();
+      fail(request, "CLIENT_ERROR line is too long", true);
+      return ParseStatus::kParsed;
+    }
+
+    std::string_view line = input.substr(0, newline);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    consumed = newline + 1;
+
+    const auto tokens = split(line);
+    if (tokens.empty()) {
+      fail(request, "ERROR");
+      return ParseStatus::kParsed;
+    }
+
+    const std::string_view name = tokens[0];
+    if (name == "get" || name == "gets") {
+      if (tokens.size() < 2) {
+        fail(request, "ERROR");
+        return ParseStatus::kParsed;
+      }
+
+      request.command = Command::kGet;
+      request.keys.resize(tokens.size() - 1);
+      for (std::size_t index = 1; index < tokens.size(); index++) {
+        if (!parse_number(tokens[index], request.keys[index - 1])) {
+          fail(request, "CLIENT_ERROR bad key format");
+          break;
+        }
+      }
+      return ParseStatus::kParsed;
+    }
+
+    if (name == "set") {
+      int key = 0;
+      unsigned flags = 0;
+      long long expiration = 0;
+      std::size_t bytes = 0;
+      const bool has_noreply = tokens.size() == 6 && tokens[5] == "noreply";
+      if ((tokens.size() != 5 && !has_noreply) || !parse_number(tokens[2], flags)
+          || !parse_number(tokens[3], expiration) || !parse_number(tokens[4], bytes)) {
+        // the length of the data block is unknown, so the stream cannot be resynchronized
+        fail(request, "CLIENT_ERROR bad command line format", true);
+        return ParseStatus::kParsed;
+      }
+
+      if (bytes > kMaxValueBytes) {
+        fail(request, "SERVER_ERROR object too large for cache", true);
+        return ParseStatus::kParsed;
+      }
+
+      const std::size_t total = consumed + bytes + 2;
+      if (input.size() < total) {
+        return ParseStatus::kIncomplete;
+      }
+
+      if (input.substr(consumed + bytes, 2) != "\r\n") {
+        consumed = total;
+        fail(request, "CLIENT_ERROR bad data chunk", true);
+        return ParseStatus::kParsed;
+      }
+
+      if (!parse_number(tokens[1], key)) {
+        consumed = total;
+        fail(request, "CLIENT_ERROR bad key format");
+        return ParseStatus::kParsed;
+      }
+
+      request.command = Command::kSet;
+      request.keys.push_back(key);
+      request.value.assign(input.substr(consumed, bytes));
+      request.noreply = has_noreply;
+      consumed = total;
+      return ParseStatus::kParsed;
+    }
+
+    if (name == "delete") {
+      int key = 0;
+      const bool has_noreply = tokens.size() == 3 && tokens[2] == "noreply";
+      if (tokens.size() != 2 && !has_noreply) {
+        fail(request, "CLIENT_ERROR bad command line format");
+        return ParseStatus::kParsed;
+      }
+      if (!parse_number(tokens[1], key)) {
+        fail(request, "CLIENT_ERROR bad key format");
+        return ParseStatus::kParsed;
+      }
+
+      request.command = Command::kDelete;
+      request.keys.push_back(key);
+      request.noreply = has_noreply;
+      return ParseStatus::kParsed;
+    }
+
+    if (name == "version" && tokens.size() == 1) {
+      request.command = Command::kVersion;
+      return ParseStatus::kParsed;
+    }
+
+    if (name == "quit" && tokens.size() == 1) {
+      request.command = Command::kQuit;
+      return ParseStatus::kParsed;
+    }
+
+    fail(request, "ERROR");
+    return ParseStatus::kParsed;
+  }
+
+  void AppendValue(int key, const std::string &value, std::string &output) {
+    append_value_header(key, value.size(), output);
+    output += value;
+    output += "\r\n";
+  }
+
+  void Execute(const Request &request, HashTable &table, std::string &output) {
+    switch (request.command) {
+      case Command::kGet: {
+        for (const int key : request.keys) {
+          const auto value = table.Search(key);
+          if (value) {
+            AppendValue(key, *value, output);
+          }
+        }
+        output += "END\r\n";
+        break;
+      }
+
+      case Command::kSet:
+        table.Put(request.keys.front(), request.value);
+        if (!request.noreply) {
+          output += "STORED\r\n";
+        }
+        break;
+
+      case Command::kDelete: {
+        const bool is_deleted = table.Remove(request.keys.front()).has_value();
+        if (!request.noreply) {
+          output += is_deleted ? "DELETED\r\n" : "NOT_FOUND\r\n";
+        }
+        break;
+      }
+
+      case Command::kVersion:
+        output += kVersion;
+        output += "\r\n";
+        break;
+
+      case Command::kQuit:
+        break;
+
+      case Command::kError:
+        output += request.error;
+        output += "\r\n";
+        break;
+    }
+  }
+
+  std::size_t Process(std::string_view input, HashTable &table, Output &output, std::size_t max_output,
+                      bool &is_closing) {
+    std::size_t offset = 0;  // end of the served requests
+    std::size_t parsed = 0;  // end of the parsed requests (the pending gets lie in between)
+    Request request;
+    PendingGets gets;
+    std::string response;
+
+    // pending gets have not appended anything yet, so the check holds for them as well
+    while (!is_closing && parsed < input.size() && output.size() < max_output) {
+      std::size_t consumed = 0;
+      if (Parse(input.substr(parsed), request, consumed) == ParseStatus::kIncomplete) {
+        break;
+      }
+      parsed += consumed;
+
+      if (request.command == Command::kGet) {
+        gets.keys.insert(gets.keys.end(), request.keys.begin(), request.keys.end());
+        gets.ends.push_back(gets.keys.size());
+        gets.offsets.push_back(parsed);
+        if (gets.keys.size() < kMaxBatchKeys) {
+          continue;
+        }
+      }
+
+      // the other requests may change the table, so the gets received before them are served first
+      offset = execute_gets(gets, table, output, max_output, offset);
+      if (request.command == Command::kGet || output.size() >= max_output) {
+        continue;  // a full batch has been served, or the request stays in the input past the output limit
+      }
+      offset = parsed;
+
+      response.clear();
+      Execute(request, table, response);
+      output.Append(response);
+      is_closing = request.command == Command::kQuit || request.is_fatal;
+    }
+
+    return execute_gets(gets, table, output, max_output, offset);
+  }
+
+}  // namespace itis::memcached
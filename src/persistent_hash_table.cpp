@@ -0,0 +1,224 @@
+#include "persistent_hash_table.hpp"
+
+#include <cassert>
+#include <utility>  // move
+
+namespace itis {
+
+  namespace {
+
+    constexpr std::uint32_t kFragmentMask = (1U << PersistentHashTable::kBitsPerLevel) - 1;
+
+    std::uint32_t bit(std::uint32_t hash, int shift) {
+      return 1U << ((hash >> static_cast<unsigned>(shift)) & kFragmentMask);
+    }
+
+    // position of the bit's entry in the compact array: number of the lower bits set in the map
+    int index(std::uint32_t map, std::uint32_t bit) {
+#if defined(__GNUC__)
+      return __builtin_popcount(map & (bit - 1));
+#else
+      int count = 0;
+      for (std::uint32_t rest = map & (bit - 1); rest != 0; rest &= rest - 1) {
+        count++;
+      }
+      return count;
+#endif
+    }
+
+  }  // namespace
+
+  std::uint32_t PersistentHashTable::hash(int key) {
+    // every step (xor-shift, multiplication by an odd constant) is invertible
+    auto hash = static_cast<std::uint32_t>(key);
+    hash ^= hash >> 16U;
+    hash *= 0x7feb352dU;
+    hash ^= hash >> 15U;
+    hash *= 0x846ca68bU;
+    hash ^= hash >> 16U;
+    return hash;
+  }
+
+  PersistentHashTable::PersistentHashTable() : root_{std::make_shared<const Node>()} {}
+
+  PersistentHashTable::PersistentHashTable(NodePtr root, int num_keys) : root_{std::move(root)}, num_keys_{num_keys} {}
+
+  PersistentHashTable::NodePtr PersistentHashTable::merge(std::pair<int, std::string> first, std::uint32_t first_hash,
+                                                          std::pair<int, std::string> second,
+                                                          std::uint32_t second_hash, int shift) {
+    // the hashes are different, so they differ in one of the fragments before the bits run out
+    assert(shift < 32);
+
+    auto node = std::make_shared<Node>();
+    const std::uint32_t first_bit = bit(first_hash, shift);
+    const std::uint32_t second_bit = bit(second_hash, shift);
+
+    if (first_bit == second_bit) {
+      node->node_map = first_bit;
+      node->children.push_back(
+          merge(std::move(first), first_hash, std::move(second), second_hash, shift + kBitsPerLevel));
+      return node;
+    }
+
+    node->data_map = first_bit | second_bit;
+    if (first_bit < second_bit) {
+      node->pairs.push_back(std::move(first));
+      node->pairs.push_back(std::move(second));
+    } else {
+      node->pairs.push_back(std::move(second));
+      node->pairs.push_back(std::move(first));
+    }
+    return node;
+  }
+
+  PersistentHashTable::NodePtr PersistentHashTable::put(const NodePtr &node, int key, std::uint32_t hash, int shift,
+                                                        const std::string &value, bool &inserted) {
+    const std::uint32_t bit = itis::bit(hash, shift);
+
+    if ((node->node_map & bit) != 0) {
+      const int child = index(node->node_map, bit);
+      NodePtr new_child = put(node->children[child], key, hash, shift + kBitsPerLevel, value, inserted);
+
+      auto copy = std::make_shared<Node>(*node);
+      copy->children[child] = std::move(new_child);
+      return copy;
+    }
+
+    auto copy = std::make_shared<Node>(*node);
+
+    if ((node->data_map & bit) == 0) {
+      copy->data_map |= bit;
+      copy->pairs.emplace(copy->pairs.begin() + index(copy->data_map, bit), key, value);
+      inserted = true;
+      return copy;
+    }
+
+    const int pair = index(node->data_map, bit);
+    if (node->pairs[pair].first == key) {
+      copy->pairs[pair].second = value;
+      return copy;
+    }
+
+    // two different keys share the fragment: push both of them one level down
+    NodePtr child = merge(std::move(copy->pairs[pair]), PersistentHashTable::hash(node->pairs[pair].first),
+                          std::make_pair(key, value), hash, shift + kBitsPerLevel);
+    copy->pairs.erase(copy->pairs.begin() + pair);
+    copy->data_map ^= bit;
+    copy->node_map |= bit;
+    copy->children.insert(copy->children.begin() + index(copy->node_map, bit), std::move(child));
+    inserted = true;
+    return copy;
+  }
+
+  PersistentHashTable::NodePtr PersistentHashTable::remove(const NodePtr &node, int key, std::uint32_t hash, int shift,
+                                                           bool &removed) {
+    const std::uint32_t bit = itis::bit(hash, shift);
+
+    if ((node->data_map & bit) != 0) {
+      const int pair = index(node->data_map, bit);
+      if (node->pairs[pair].first != key) {
+        return node;
+      }
+
+      auto copy = std::make_shared<Node>(*node);
+      copy->pairs.erase(copy->pairs.begin() + pair);
+      copy->data_map ^= bit;
+      removed = true;
+      return copy;
+    }
+
+    if ((node->node_map & bit) == 0) {
+      return node;
+    }
+
+    const int child = index(node->node_map, bit);
+    NodePtr new_child = remove(node->children[child], key, hash, shift + kBitsPerLevel, removed);
+    if (!removed) {
+      return node;
+    }
+
+    auto copy = std::make_shared<Node>(*node);
+
+    // keep the trie canonical: a child with a single pair is replaced with the pair itself
+    if (new_child->children.empty() && new_child->pairs.size() == 1) {
+      copy->children.erase(copy->children.begin() + child);
+      copy->node_map ^= bit;
+      copy->data_map |= bit;
+      copy->pairs.insert(copy->pairs.begin() + index(copy->data_map, bit), new_child->pairs.front());
+      return copy;
+    }
+
+    copy->children[child] = std::move(new_child);
+    return copy;
+  }
+
+  const std::string *PersistentHashTable::lookup(int key) const {
+    const std::uint32_t hash = PersistentHashTable::hash(key);
+    const Node *node = root_.get();
+
+    for (int shift = 0;; shift += kBitsPerLevel) {
+      const std::uint32_t bit = itis::bit(hash, shift);
+
+      if ((node->data_map & bit) != 0) {
+        const auto &pair = node->pairs[index(node->data_map, bit)];
+        return pair.first == key ? &pair.second : nullptr;
+      }
+
+      if ((node->node_map & bit) == 0) {
+        return nullptr;
+      }
+      node = node->children[index(node->node_map, bit)].get();
+    }
+  }
+
+  std::optional<std::string> PersistentHashTable::Search(int key) const {
+    const std::string *value = lookup(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  PersistentHashTable PersistentHashTable::Put(int key, const std::string &value) const {
+    bool inserted = false;
+    NodePtr root = put(root_, key, hash(key), 0, value, inserted);
+    return PersistentHashTable(std::move(root), num_keys_ + (inserted ? 1 : 0));
+  }
+
+  PersistentHashTable PersistentHashTable::Remove(int key) const {
+    bool removed = false;
+    NodePtr root = remove(root_, key, hash(key), 0, removed);
+    if (!removed) {
+      return *this;
+    }
+    return PersistentHashTable(std::move(root), num_keys_ - 1);
+  }
+
+  bool PersistentHashTable::ContainsKey(int key) const {
+    return lookup(key) != nullptr;
+  }
+
+  bool PersistentHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int PersistentHashTable::size() const {
+    return num_keys_;
+  }
+
+  std::unordered_set<int> PersistentHashTable::keys() const {
+    std::unordered_set<int> keys(num_keys_);
+    auto insert = [&keys](const std::pair<int, std::string> &pair) { keys.insert(pair.first); };
+    for_each_pair(*root_, insert);
+    return keys;
+  }
+
+  std::vector<std::string> PersistentHashTable::values() const {
+    std::vector<std::string> values;
+    values.reserve(num_keys_);
+    auto insert = [&values](const std::pair<int, std::string> &pair) { values.push_back(pair.second); };
+    for_each_pair(*root_, insert);
+    return values;
+  }
+
+}  // namespace itis
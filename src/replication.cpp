@@ -0,0 +1,387 @@
+#include "replication.hpp"
+
+#include <algorithm>  // max
+#include <cerrno>
+#include <cstring>  // memcpy
+#include <limits>
+#include <mutex>  // unique_lock
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>  // move
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace itis {
+
+  namespace {
+
+    constexpr char kHelloMagic[8] = {'I', 'T', 'I', 'S', 'R', 'E', 'P', '2'};
+    constexpr std::size_t kHelloSize = sizeof(kHelloMagic) + 8 + 8;  // magic, sequence, primary ID
+    constexpr std::size_t kFrameHeaderSize = 1 + 8 + 4 + 4;      // type, sequence, key, payload length
+    constexpr int kHelloTimeoutMs = 5000;
+
+    // frame types, the mutations share their values with WriteAheadLog::RecordType
+    enum class FrameType : std::uint8_t { kPut = 1, kRemove = 2, kSnapshot = 3, kSnapshotPart = 4 };
+
+    void encode(FrameType type, std::uint64_t sequence, int key, std::string_view payload, std::string &output) {
+      if (payload.size() > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::logic_error("replication frame payload must be shorter than 4 GiB");
+      }
+
+      char header[kFrameHeaderSize];
+      const auto length = static_cast<std::uint32_t>(payload.size());
+      std::memcpy(&header[0], &type, 1);
+      std::memcpy(&header[1], &sequence, 8);
+      std::memcpy(&header[9], &key, 4);
+      std::memcpy(&header[13], &length, 4);
+      output.append(header, kFrameHeaderSize);
+      output += payload;
+    }
+
+    void send_all(int fd, const char *data, std::size_t size) {
+      std::size_t sent = 0;
+      while (sent < size) {
+        const ssize_t result = send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (result == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          throw std::runtime_error("failed to send to the replication stream");
+        }
+        sent += static_cast<std::size_t>(result);
+      }
+    }
+
+    // the socket may be non-blocking, so a missing byte is waited for with poll
+    void receive_all(int fd, char *data, std::size_t size) {
+      std::size_t received = 0;
+      while (received < size) {
+        const ssize_t result = recv(fd, data + received, size - received, 0);
+        if (result > 0) {
+          received += static_cast<std::size_t>(result);
+          continue;
+        }
+        if (result == -1 && errno == EINTR) {
+          continue;
+        }
+
+        pollfd descriptor{fd, POLLIN, 0};
+        if (result == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) || poll(&descriptor, 1, kHelloTimeoutMs) <= 0) {
+          throw std::runtime_error("failed to receive from the replication stream");
+        }
+      }
+    }
+
+    std::uint64_t random_id() {
+      std::random_device device;
+      std::uint64_t id = 0;
+      while (id == 0) {
+        id = (static_cast<std::uint64_t>(device()) << 32U) ^ device();
+      }
+      return id;
+    }
+
+  }  // namespace
+
+  ReplicationPrimary::ReplicationPrimary(int capacity, std::size_t log_records)
+      : table_{capacity}, id_{random_id()}, log_records_{log_records} {
+    if (log_records == 0) {
+      throw std::logic_error("replication log must keep at least one record");
+    }
+  }
+
+  ReplicationPrimary::~ReplicationPrimary() {
+    for (const auto &follower : followers_) {
+      close(follower.fd);
+    }
+  }
+
+  void ReplicationPrimary::Put(int key, const std::string &value) {
+    if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::logic_error("replicated values must be shorter than 4 GiB");
+    }
+    table_.Put(key, value);
+    ship(WriteAheadLog::RecordType::kPut, key, value);
+  }
+
+  std::optional<std::string> ReplicationPrimary::Remove(int key) {
+    auto removed = table_.Remove(key);
+    if (removed) {
+      ship(WriteAheadLog::RecordType::kRemove, key, {});
+    }
+    return removed;
+  }
+
+  std::optional<std::string> ReplicationPrimary::Search(int key) const {
+    return table_.Search(key);
+  }
+
+  void ReplicationPrimary::ship(WriteAheadLog::RecordType type, int key, const std::string &value) {
+    sequence_++;
+    log_.push_back(Record{sequence_, type, key, value});
+    if (log_.size() > log_records_) {
+      log_.pop_front();
+    }
+
+    std::string frame;
+    encode(static_cast<FrameType>(type), sequence_, key, value, frame);
+
+    for (auto follower = followers_.begin(); follower != followers_.end();) {
+      follower->output += frame;
+      if (send_output(*follower)) {
+        ++follower;
+        continue;
+      }
+      close(follower->fd);
+      follower = followers_.erase(follower);
+    }
+  }
+
+  bool ReplicationPrimary::send_output(Follower &follower) {
+    while (follower.output_offset < follower.output.size()) {
+      const ssize_t sent = send(follower.fd, follower.output.data() + follower.output_offset,
+                                follower.output.size() - follower.output_offset, MSG_NOSIGNAL);
+      if (sent == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // a follower that does not keep up is cut off instead of growing the buffer without a limit; the
+        // snapshot it starts from is sent whole however long it is, only the mutations behind it are limited
+        const std::size_t snapshot_offset = std::max(follower.snapshot_end, follower.output_offset);
+        return (errno == EAGAIN || errno == EWOULDBLOCK)
+            && follower.output.size() - snapshot_offset <= kMaxBacklogBytes;
+      }
+      follower.output_offset += static_cast<std::size_t>(sent);
+    }
+
+    follower.output.clear();
+    follower.output_offset = 0;
+    follower.snapshot_end = 0;
+    return true;
+  }
+
+  void ReplicationPrimary::AddFollower(int fd) {
+    char hello[kHelloSize];
+    std::uint64_t from = 0;
+    std::uint64_t primary_id = 0;
+    try {
+      receive_all(fd, hello, kHelloSize);
+      if (std::memcmp(hello, kHelloMagic, sizeof(kHelloMagic)) != 0) {
+        throw std::runtime_error("invalid replication hello");
+      }
+    } catch (const std::runtime_error &) {
+      close(fd);
+      throw;
+    }
+    std::memcpy(&from, &hello[sizeof(kHelloMagic)], 8);
+    std::memcpy(&primary_id, &hello[sizeof(kHelloMagic) + 8], 8);
+
+    Follower follower;
+    follower.fd = fd;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // the sequence number of a follower of another primary (e.g. before a restart) means nothing here
+    const bool is_own = primary_id == id_;
+    const bool has_log = !log_.empty() && log_.front().sequence <= from + 1;
+    if (is_own && from < sequence_ && has_log) {
+      // the follower only misses the tail of the log
+      for (auto record = log_.begin() + static_cast<std::ptrdiff_t>(from + 1 - log_.front().sequence);
+           record != log_.end(); ++record) {
+        encode(static_cast<FrameType>(record->type), record->sequence, record->key, record->value, follower.output);
+      }
+    } else if (!is_own || from != sequence_) {
+      // new, too far behind or following another primary: start over from the current state
+      std::ostringstream stream;
+      stream.write(reinterpret_cast<const char *>(&id_), sizeof(id_));
+      table_.Save(stream);
+      const std::string snapshot = stream.str();
+
+      // a frame length has 32 bits, so a long snapshot goes in parts
+      std::string_view rest = snapshot;
+      while (rest.size() > kSnapshotPartBytes) {
+        encode(FrameType::kSnapshotPart, sequence_, 0, rest.substr(0, kSnapshotPartBytes), follower.output);
+        rest.remove_prefix(kSnapshotPartBytes);
+      }
+      encode(FrameType::kSnapshot, sequence_, 0, rest, follower.output);
+      follower.snapshot_end = follower.output.size();
+    }
+
+    if (!send_output(follower)) {
+      close(fd);
+      return;
+    }
+    followers_.push_back(std::move(follower));
+  }
+
+  int ReplicationPrimary::Flush() {
+    int num_lagging = 0;
+    for (auto follower = followers_.begin(); follower != followers_.end();) {
+      if (!send_output(*follower)) {
+        close(follower->fd);
+        follower = followers_.erase(follower);
+        continue;
+      }
+      num_lagging += follower->output.empty() ? 0 : 1;
+      ++follower;
+    }
+    return num_lagging;
+  }
+
+  std::uint64_t ReplicationPrimary::sequence() const {
+    return sequence_;
+  }
+
+  int ReplicationPrimary::num_followers() const {
+    return static_cast<int>(followers_.size());
+  }
+
+  std::uint64_t ReplicationPrimary::id() const {
+    return id_;
+  }
+
+  const HashTable &ReplicationPrimary::table() const {
+    return table_;
+  }
+
+  ReplicationFollower::ReplicationFollower(int capacity) {
+    table_.emplace(capacity);
+  }
+
+  ReplicationFollower::~ReplicationFollower() {
+    Disconnect();
+  }
+
+  void ReplicationFollower::Connect(int fd) {
+    Disconnect();
+    fd_ = fd;
+
+    char hello[kHelloSize];
+    std::memcpy(hello, kHelloMagic, sizeof(kHelloMagic));
+    std::memcpy(&hello[sizeof(kHelloMagic)], &sequence_, 8);
+    std::memcpy(&hello[sizeof(kHelloMagic) + 8], &primary_id_, 8);
+    send_all(fd_, hello, kHelloSize);
+  }
+
+  void ReplicationFollower::Disconnect() {
+    if (fd_ != -1) {
+      close(fd_);
+      fd_ = -1;
+    }
+    input_.clear();  // a partial frame (or snapshot) is sent again after reconnecting
+    snapshot_.clear();
+  }
+
+  bool ReplicationFollower::Poll() {
+    if (fd_ == -1) {
+      return false;
+    }
+
+    bool is_open = true;
+    char chunk[64 * 1024];
+    while (true) {
+      const ssize_t received = recv(fd_, chunk, sizeof(chunk), MSG_DONTWAIT);
+      if (received > 0) {
+        input_.append(chunk, static_cast<std::size_t>(received));
+        continue;
+      }
+      if (received == -1 && errno == EINTR) {
+        continue;
+      }
+      is_open = received == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+      break;
+    }
+
+    apply();
+    return is_open;
+  }
+
+  void ReplicationFollower::apply() {
+    std::unique_lock lock(mutex_);
+
+    std::size_t offset = 0;
+    while (input_.size() - offset >= kFrameHeaderSize) {
+      FrameType type{};
+      std::uint64_t sequence = 0;
+      int key = 0;
+      std::uint32_t length = 0;
+      std::memcpy(&type, &input_[offset], 1);
+      std::memcpy(&sequence, &input_[offset + 1], 8);
+      std::memcpy(&key, &input_[offset + 9], 4);
+      std::memcpy(&length, &input_[offset + 13], 4);
+
+      if (input_.size() - offset - kFrameHeaderSize < length) {
+        break;  // the rest of the frame has not arrived yet
+      }
+      const char *payload = &input_[offset + kFrameHeaderSize];
+      offset += kFrameHeaderSize + length;
+
+      if (type == FrameType::kSnapshotPart) {
+        snapshot_.append(payload, length);
+        continue;
+      }
+      if (type == FrameType::kSnapshot) {
+        snapshot_.append(payload, length);
+        std::uint64_t primary_id = 0;
+        if (snapshot_.size() < sizeof(primary_id)) {
+          throw std::runtime_error("invalid replication snapshot");
+        }
+        std::memcpy(&primary_id, snapshot_.data(), sizeof(primary_id));
+
+        std::istringstream snapshot(snapshot_.substr(sizeof(primary_id)));
+        snapshot_.clear();
+        snapshot_.shrink_to_fit();
+        auto table = HashTable::Load(snapshot);
+        table_.emplace(std::move(table));
+        sequence_ = sequence;
+        primary_id_ = primary_id;
+        continue;
+      }
+
+      if (sequence != sequence_ + 1) {
+        throw std::runtime_error("replication stream skips from " + std::to_string(sequence_) + " to "
+                                 + std::to_string(sequence));
+      }
+      if (type == FrameType::kPut) {
+        table_->Put(key, std::string(payload, length));
+      } else if (type == FrameType::kRemove) {
+        table_->Remove(key);
+      } else {
+        throw std::runtime_error("invalid replication frame");
+      }
+      sequence_ = sequence;
+    }
+    input_.erase(0, offset);
+  }
+
+  // the table is searched through a const reference, so the readers sharing the lock do not modify it
+  std::optional<std::string> ReplicationFollower::Search(int key) const {
+    std::shared_lock lock(mutex_);
+    return table_->Search(key);
+  }
+
+  bool ReplicationFollower::ContainsKey(int key) const {
+    std::shared_lock lock(mutex_);
+    return table_->ContainsKey(key);
+  }
+
+  int ReplicationFollower::size() const {
+    std::shared_lock lock(mutex_);
+    return table_->size();
+  }
+
+  std::uint64_t ReplicationFollower::sequence() const {
+    std::shared_lock lock(mutex_);
+    return sequence_;
+  }
+
+  std::uint64_t ReplicationFollower::primary_id() const {
+    std::shared_lock lock(mutex_);
+    return primary_id_;
+  }
+
+}  // namespace itis
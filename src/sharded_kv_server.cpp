@@ -0,0 +1,458 @@
+#include "sharded_kv_server.hpp"
+
+#include <algorithm>  // max
+#include <cerrno>
+#include <stdexcept>
+#include <string>  // to_string
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace itis {
+
+  namespace {
+
+    constexpr int kMaxEvents = 256;
+    constexpr std::uint64_t kListenTag = 0;
+    constexpr std::uint64_t kWakeTag = 1;
+
+    void watch(int epoll_fd, int operation, int fd, std::uint32_t events, std::uint64_t tag) {
+      epoll_event event{};
+      event.events = events;
+      event.data.u64 = tag;
+      if (epoll_ctl(epoll_fd, operation, fd, &event) == -1) {
+        throw std::runtime_error("failed to watch a socket with epoll");
+      }
+    }
+
+    void wake(int fd) {
+      const std::uint64_t value = 1;
+      static_cast<void>(write(fd, &value, sizeof(value)));
+    }
+
+  }  // namespace
+
+  ShardedKvServer::ShardedKvServer(int num_shards, int port) : num_shards_{num_shards} {
+    if (num_shards <= 0) {
+      throw std::logic_error("number of shards must be greater than zero");
+    }
+
+    const std::size_t capacity =
+        std::max(kMinQueueCapacity, kQueueCapacity / static_cast<std::size_t>(std::max(num_shards - 1, 1)));
+    for (int from = 0; from < num_shards; from++) {
+      for (int to = 0; to < num_shards; to++) {
+        queues_.push_back(from == to ? nullptr : std::make_unique<SpscQueue<Message>>(capacity));
+      }
+    }
+
+    for (int index = 0; index < num_shards; index++) {
+      auto worker = std::make_unique<Worker>();
+      worker->index = index;
+      worker->outboxes.resize(num_shards);
+      worker->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      worker->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+      worker->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      Worker &created = *worker;
+      workers_.push_back(std::move(worker));
+
+      if (created.listen_fd == -1 || created.epoll_fd == -1 || created.wake_fd == -1) {
+        throw std::runtime_error("failed to create the server sockets");
+      }
+
+      // every worker listens on the same port, the kernel balances the connections between them
+      const int enable = 1;
+      setsockopt(created.listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+      setsockopt(created.listen_fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+
+      sockaddr_in address{};
+      address.sin_family = AF_INET;
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      address.sin_port = htons(static_cast<std::uint16_t>(index == 0 ? port : port_));
+      socklen_t length = sizeof(address);
+
+      if (bind(created.listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1
+          || listen(created.listen_fd, SOMAXCONN) == -1
+          || getsockname(created.listen_fd, reinterpret_cast<sockaddr *>(&address), &length) == -1) {
+        throw std::runtime_error("failed to listen on port " + std::to_string(port));
+      }
+      port_ = ntohs(address.sin_port);
+
+      watch(created.epoll_fd, EPOLL_CTL_ADD, created.listen_fd, EPOLLIN, kListenTag);
+      watch(created.epoll_fd, EPOLL_CTL_ADD, created.wake_fd, EPOLLIN, kWakeTag);
+    }
+  }
+
+  ShardedKvServer::Worker::~Worker() {
+    for (const auto &[id, connection] : connections) {
+      close(connection.fd);
+    }
+    for (const int fd : {listen_fd, epoll_fd, wake_fd}) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+  }
+
+  // the workers close their sockets themselves, also when the constructor throws halfway through
+  ShardedKvServer::~ShardedKvServer() {
+    Stop();
+  }
+
+  int ShardedKvServer::ShardOf(int key, int num_shards) {
+    // Fibonacci hashing spreads sequential keys over the shards, the high bits are the best mixed ones
+    const auto hash = static_cast<std::uint32_t>(static_cast<std::uint32_t>(key) * 2654435769U);
+    return static_cast<int>((static_cast<std::uint64_t>(hash) * static_cast<std::uint64_t>(num_shards)) >> 32U);
+  }
+
+  SpscQueue<ShardedKvServer::Message> &ShardedKvServer::queue(int from, int to) {
+    return *queues_[from * num_shards_ + to];
+  }
+
+  void ShardedKvServer::Start() {
+    is_stopping_ = false;
+    const auto num_cpus = std::thread::hardware_concurrency();
+
+    for (auto &worker : workers_) {
+      worker->thread = std::thread([this, &self = *worker] { run(self); });
+
+      if (num_cpus > 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(static_cast<unsigned>(worker->index) % num_cpus, &cpus);
+        pthread_setaffinity_np(worker->thread.native_handle(), sizeof(cpus), &cpus);
+      }
+    }
+  }
+
+  void ShardedKvServer::Stop() {
+    is_stopping_ = true;
+    for (auto &worker : workers_) {
+      wake(worker->wake_fd);
+    }
+    for (auto &worker : workers_) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+  }
+
+  void ShardedKvServer::run(Worker &worker) {
+    epoll_event events[kMaxEvents];
+    bool has_backlog = false;
+
+    while (!is_stopping_) {
+      // a full queue is retried shortly instead of waiting for the next event
+      const int num_events = epoll_wait(worker.epoll_fd, events, kMaxEvents, has_backlog ? 1 : -1);
+
+      for (int index = 0; index < std::max(num_events, 0); index++) {
+        const std::uint64_t tag = events[index].data.u64;
+
+        if (tag == kListenTag) {
+          accept_connections(worker);
+        } else if (tag == kWakeTag) {
+          std::uint64_t value = 0;
+          static_cast<void>(read(worker.wake_fd, &value, sizeof(value)));
+        } else {
+          const auto found = worker.connections.find(tag);
+          if (found == worker.connections.end()) {
+            continue;
+          }
+
+          // a connection with a pending output is only written to until the socket drains
+          Connection &connection = found->second;
+          const bool is_readable = (events[index].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0;
+          if (is_readable && connection.output_offset == connection.output.size()) {
+            receive(worker, tag, connection);
+          }
+          worker.dirty.push_back(tag);
+        }
+      }
+
+      // messages from the other workers are drained on every iteration, whatever woke the worker up
+      Message message;
+      for (int from = 0; from < num_shards_; from++) {
+        if (from == worker.index) {
+          continue;
+        }
+        auto &inbound = queue(from, worker.index);
+        while (inbound.TryPop(message)) {
+          handle(worker, message);
+        }
+      }
+
+      has_backlog = send_messages(worker);
+
+      std::vector<std::uint64_t> dirty;
+      dirty.swap(worker.dirty);
+      for (const std::uint64_t id : dirty) {
+        flush(worker, id);
+      }
+    }
+  }
+
+  void ShardedKvServer::accept_connections(Worker &worker) {
+    while (true) {
+      const int fd = accept4(worker.listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd == -1) {
+        if (errno == EMFILE || errno == ENFILE) {
+          // the pending connection keeps the level-triggered socket readable, which would spin the loop
+          epoll_ctl(worker.epoll_fd, EPOLL_CTL_DEL, worker.listen_fd, nullptr);
+          worker.is_accept_paused = true;
+        }
+        // EAGAIN - no more pending connections; other errors are retried on the next event
+        return;
+      }
+
+      const int enable = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+      const std::uint64_t id = worker.next_connection++;
+      Connection &connection = worker.connections[id];
+      connection.fd = fd;
+      connection.events = EPOLLIN | EPOLLRDHUP;
+      watch(worker.epoll_fd, EPOLL_CTL_ADD, fd, connection.events, id);
+    }
+  }
+
+  void ShardedKvServer::receive(Worker &worker, std::uint64_t id, Connection &connection) {
+    char chunk[kReadChunkBytes];
+
+    // the socket is level-triggered, so the bytes left unread are reported again by the next epoll_wait
+    for (int reads = 0; reads < kMaxReadsPerEvent && connection.input.size() < kMaxBufferedBytes; reads++) {
+      const ssize_t received = recv(connection.fd, chunk, sizeof(chunk), 0);
+      if (received > 0) {
+        connection.input.append(chunk, static_cast<std::size_t>(received));
+        continue;
+      }
+      if (received == -1 && errno == EINTR) {
+        continue;
+      }
+      if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        connection.is_closing = true;
+      }
+      break;
+    }
+
+    std::size_t offset = 0;
+    memcached::Request request;
+    while (offset < connection.input.size()) {
+      std::size_t consumed = 0;
+      const std::string_view input(connection.input);
+      if (memcached::Parse(input.substr(offset), request, consumed) == memcached::ParseStatus::kIncomplete) {
+        break;
+      }
+      offset += consumed;
+      dispatch(worker, id, connection, request);
+
+      if (request.command == memcached::Command::kQuit || request.is_fatal) {
+        connection.is_closing = true;
+        offset = connection.input.size();
+      }
+    }
+    connection.input.erase(0, offset);
+  }
+
+  void ShardedKvServer::dispatch(Worker &worker, std::uint64_t id, Connection &connection,
+                                 const memcached::Request &request) {
+    Response response;
+    const std::uint64_t sequence = connection.first_sequence + connection.responses.size();
+
+    const bool is_key_command = request.command == memcached::Command::kGet
+                             || request.command == memcached::Command::kSet
+                             || request.command == memcached::Command::kDelete;
+    if (!is_key_command) {
+      // the other commands do not touch the shard
+      memcached::Execute(request, worker.shard, response.suffix);
+      connection.responses.push_back(std::move(response));
+      return;
+    }
+
+    response.parts.resize(request.keys.size());
+    if (request.command == memcached::Command::kGet) {
+      response.suffix = "END\r\n";
+    }
+
+    for (std::uint32_t part = 0; part < request.keys.size(); part++) {
+      const int key = request.keys[part];
+      const int owner = ShardOf(key, num_shards_);
+
+      if (owner == worker.index) {
+        std::string &text = response.parts[part];
+        if (request.command == memcached::Command::kGet) {
+          const auto value = worker.shard.Search(key);
+          if (value) {
+            memcached::AppendValue(key, *value, text);
+          }
+        } else if (request.command == memcached::Command::kSet) {
+          worker.shard.Put(key, request.value);
+          text = request.noreply ? "" : "STORED\r\n";
+        } else {
+          const bool is_deleted = worker.shard.Remove(key).has_value();
+          text = request.noreply ? "" : is_deleted ? "DELETED\r\n" : "NOT_FOUND\r\n";
+        }
+        continue;
+      }
+
+      Message message;
+      message.kind = request.command == memcached::Command::kGet   ? Message::Kind::kGet
+                   : request.command == memcached::Command::kSet ? Message::Kind::kSet
+                                                                 : Message::Kind::kDelete;
+      message.noreply = request.noreply;
+      message.origin = worker.index;
+      message.key = key;
+      message.value = request.command == memcached::Command::kSet ? request.value : std::string{};
+      message.connection = id;
+      message.sequence = sequence;
+      message.part = part;
+      worker.outboxes[owner].push_back(std::move(message));
+      response.outstanding++;
+    }
+
+    connection.responses.push_back(std::move(response));
+  }
+
+  void ShardedKvServer::handle(Worker &worker, Message &message) {
+    if (message.kind == Message::Kind::kReply) {
+      const auto found = worker.connections.find(message.connection);
+      if (found == worker.connections.end()) {
+        return;  // the connection has been closed meanwhile
+      }
+
+      Connection &connection = found->second;
+      Response &response = connection.responses[message.sequence - connection.first_sequence];
+      response.parts[message.part] = std::move(message.value);
+      response.outstanding--;
+      worker.dirty.push_back(message.connection);
+      return;
+    }
+
+    std::string text;
+    if (message.kind == Message::Kind::kGet) {
+      const auto value = worker.shard.Search(message.key);
+      if (value) {
+        memcached::AppendValue(message.key, *value, text);
+      }
+    } else if (message.kind == Message::Kind::kSet) {
+      worker.shard.Put(message.key, message.value);
+      text = message.noreply ? "" : "STORED\r\n";
+    } else {
+      const bool is_deleted = worker.shard.Remove(message.key).has_value();
+      text = message.noreply ? "" : is_deleted ? "DELETED\r\n" : "NOT_FOUND\r\n";
+    }
+
+    const int origin = message.origin;
+    message.kind = Message::Kind::kReply;
+    message.value = std::move(text);
+    worker.outboxes[origin].push_back(std::move(message));
+  }
+
+  bool ShardedKvServer::send_messages(Worker &worker) {
+    bool has_backlog = false;
+
+    for (int to = 0; to < num_shards_; to++) {
+      auto &outbox = worker.outboxes[to];
+      if (outbox.empty()) {
+        continue;
+      }
+
+      std::size_t sent = 0;
+      auto &outbound = queue(worker.index, to);
+      while (sent < outbox.size() && outbound.TryPush(std::move(outbox[sent]))) {
+        sent++;
+      }
+      outbox.erase(outbox.begin(), outbox.begin() + static_cast<std::ptrdiff_t>(sent));
+      has_backlog = has_backlog || !outbox.empty();
+
+      // one wake-up per batch of messages
+      if (sent > 0) {
+        wake(workers_[to]->wake_fd);
+      }
+    }
+    return has_backlog;
+  }
+
+  void ShardedKvServer::flush(Worker &worker, std::uint64_t id) {
+    const auto found = worker.connections.find(id);
+    if (found == worker.connections.end()) {
+      return;
+    }
+    Connection &connection = found->second;
+
+    // responses are sent strictly in the order of the requests
+    while (!connection.responses.empty() && connection.responses.front().outstanding == 0) {
+      const Response &response = connection.responses.front();
+      for (const auto &part : response.parts) {
+        connection.output += part;
+      }
+      connection.output += response.suffix;
+      connection.responses.pop_front();
+      connection.first_sequence++;
+    }
+
+    while (connection.output_offset < connection.output.size()) {
+      const ssize_t sent = send(connection.fd, connection.output.data() + connection.output_offset,
+                                connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+      if (sent == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          close_connection(worker, id);
+          return;
+        }
+        break;
+      }
+      connection.output_offset += static_cast<std::size_t>(sent);
+    }
+
+    const bool has_output = connection.output_offset < connection.output.size();
+    if (!has_output) {
+      connection.output.clear();
+      connection.output_offset = 0;
+    }
+
+    if (connection.is_closing && !has_output && connection.responses.empty()) {
+      close_connection(worker, id);
+      return;
+    }
+
+    // with a pending output the connection waits for the socket to drain instead of reading more requests
+    const std::uint32_t events = has_output ? EPOLLOUT : connection.is_closing ? 0U : EPOLLIN | EPOLLRDHUP;
+    if (events != connection.events) {
+      watch(worker.epoll_fd, EPOLL_CTL_MOD, connection.fd, events, id);
+      connection.events = events;
+    }
+  }
+
+  void ShardedKvServer::close_connection(Worker &worker, std::uint64_t id) {
+    const auto found = worker.connections.find(id);
+    epoll_ctl(worker.epoll_fd, EPOLL_CTL_DEL, found->second.fd, nullptr);
+    close(found->second.fd);
+    worker.connections.erase(found);
+
+    if (worker.is_accept_paused) {
+      worker.is_accept_paused = false;
+      watch(worker.epoll_fd, EPOLL_CTL_ADD, worker.listen_fd, EPOLLIN, kListenTag);
+    }
+  }
+
+  int ShardedKvServer::port() const {
+    return port_;
+  }
+
+  int ShardedKvServer::num_shards() const {
+    return num_shards_;
+  }
+
+  int ShardedKvServer::shard_size(int shard) const {
+    return workers_.at(shard)->shard.size();
+  }
+
+}  // namespace itis
@@ -0,0 +1,489 @@
+#include "shared_hash_table.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>  // memcpy, memset
+#include <limits>
+#include <new>  // placement new
+#include <stdexcept>
+#include <thread>   // yield
+#include <utility>  // move
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "hash_table.hpp"  // utils::hash
+
+namespace itis {
+
+  namespace {
+
+    constexpr std::uint64_t kMagic = 0x3354'4853'5349'5449ULL;  // "ITISSHT3" read as little-endian bytes
+    constexpr int kMaxOptimisticReads = 16;                       // retries of a lookup before it takes the mutex
+    constexpr int kNumSizeClasses = 40;
+    constexpr std::size_t kMinBlockBytes = 16;  // blocks are powers of two starting from 16 bytes
+    constexpr std::size_t kHeaderAlignment = 64;
+
+    // element of a bucket chain
+    struct Entry {
+      std::uint64_t next;   // offset of the next entry of the chain, 0 - the last one
+      std::uint64_t value;  // offset of the value bytes, 0 - empty value
+      std::uint32_t value_size;
+      int key;
+    };
+
+    int size_class(std::size_t bytes) {
+      int result = 0;
+      while ((kMinBlockBytes << static_cast<unsigned>(result)) < bytes) {
+        result++;
+      }
+      return result;
+    }
+
+    std::size_t class_bytes(int size_class) {
+      return kMinBlockBytes << static_cast<unsigned>(size_class);
+    }
+
+    bool is_valid_name(const std::string &name) {
+      return name.size() > 1 && name.front() == '/' && name.find('/', 1) == std::string::npos;
+    }
+
+    // process-shared robust mutex: the lock of a process that died holding it passes to the next locker
+    void init_mutex(pthread_mutex_t &mutex) {
+      pthread_mutexattr_t attributes;
+      if (pthread_mutexattr_init(&attributes) != 0) {
+        throw std::runtime_error("failed to initialize shared memory mutex attributes");
+      }
+      const bool is_initialized = pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED) == 0
+                               && pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST) == 0
+                               && pthread_mutex_init(&mutex, &attributes) == 0;
+      pthread_mutexattr_destroy(&attributes);
+      if (!is_initialized) {
+        throw std::runtime_error("failed to initialize shared memory mutex");
+      }
+    }
+
+    class Lock final {
+     private:
+      pthread_mutex_t &mutex_;
+
+     public:
+      explicit Lock(pthread_mutex_t &mutex) : mutex_{mutex} {
+        const int result = pthread_mutex_lock(&mutex_);
+        if (result == EOWNERDEAD) {
+          // the owner died inside an operation, which may be left half-applied (e.g. a leaked block or keys lost
+          // by an interrupted grow), but the other processes keep working instead of waiting forever
+          pthread_mutex_consistent(&mutex_);
+        } else if (result != 0) {
+          throw std::runtime_error(std::string("failed to lock shared memory mutex: ") + std::strerror(result));
+        }
+      }
+
+      ~Lock() {
+        pthread_mutex_unlock(&mutex_);
+      }
+
+      Lock(const Lock &) = delete;
+      Lock &operator=(const Lock &) = delete;
+    };
+
+    // writer side of the seqlock (under the mutex): the sequence is odd while the table is being changed
+    class WriteSection final {
+     private:
+      std::atomic<std::uint64_t> &sequence_;
+      const std::uint64_t start_;
+
+     public:
+      explicit WriteSection(std::atomic<std::uint64_t> &sequence)
+          : sequence_{sequence}, start_{sequence.load(std::memory_order_relaxed) | 1U} {
+        // an odd sequence is left by a writer that died, the readers keep retrying until this write ends
+        sequence_.store(start_, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+      }
+
+      ~WriteSection() {
+        sequence_.store(start_ + 1, std::memory_order_release);
+      }
+
+      WriteSection(const WriteSection &) = delete;
+      WriteSection &operator=(const WriteSection &) = delete;
+    };
+
+  }  // namespace
+
+  // beginning of the segment; offset 0 is never a valid block, so it serves as the null offset
+  struct SharedHashTable::Header {
+    std::atomic<std::uint64_t> magic;  // set last by Create, so Open never sees a half-initialized table
+    std::uint64_t segment_bytes;
+    pthread_mutex_t lock;                 // taken by the writers
+    std::atomic<std::uint64_t> sequence;  // odd while a writer is changing the table
+
+    std::uint64_t buckets;  // offset of the array of chain heads
+    int capacity;
+    int num_keys;
+
+    std::uint64_t top;                            // beginning of the never allocated tail of the segment
+    std::uint64_t free_lists[kNumSizeClasses];  // heads of the lists of the free blocks of every size class
+  };
+
+  SharedHashTable::SharedHashTable(std::string name, void *segment, std::size_t segment_bytes)
+      : name_{std::move(name)}, header_{static_cast<Header *>(segment)}, segment_bytes_{segment_bytes} {}
+
+  SharedHashTable::SharedHashTable(SharedHashTable &&other) noexcept
+      : name_{std::move(other.name_)}, header_{other.header_}, segment_bytes_{other.segment_bytes_} {
+    other.header_ = nullptr;
+  }
+
+  SharedHashTable::~SharedHashTable() {
+    if (header_ != nullptr) {
+      munmap(header_, segment_bytes_);
+    }
+  }
+
+  SharedHashTable SharedHashTable::Create(const std::string &name, std::size_t segment_bytes, int capacity) {
+    if (!is_valid_name(name)) {
+      throw std::logic_error("shared memory name must look like \"/name\"");
+    }
+    if (capacity <= 0) {
+      throw std::logic_error("hash table capacity must be greater than zero");
+    }
+
+    const std::size_t header_bytes = (sizeof(Header) + kHeaderAlignment - 1) / kHeaderAlignment * kHeaderAlignment;
+    const std::size_t buckets_bytes = class_bytes(size_class(sizeof(std::uint64_t) * capacity));
+    if (segment_bytes < header_bytes + buckets_bytes) {
+      throw std::logic_error("shared memory segment is too small for the buckets");
+    }
+
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) {
+      throw std::runtime_error("failed to create shared memory segment " + name);
+    }
+
+    // the new pages of the segment are zero-filled, so the buckets and the free lists start empty
+    void *segment = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(segment_bytes)) == 0) {
+      segment = mmap(nullptr, segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (segment == MAP_FAILED) {
+      shm_unlink(name.c_str());
+      throw std::runtime_error("failed to map shared memory segment " + name);
+    }
+
+    auto *header = new (segment) Header{};
+    header->segment_bytes = segment_bytes;
+    header->top = header_bytes;
+    header->capacity = capacity;
+
+    auto table = SharedHashTable(name, segment, segment_bytes);
+    try {
+      init_mutex(header->lock);
+    } catch (...) {
+      shm_unlink(name.c_str());
+      throw;
+    }
+    header->buckets = table.allocate(buckets_bytes);
+    header->magic.store(kMagic, std::memory_order_release);
+    return table;
+  }
+
+  SharedHashTable SharedHashTable::Open(const std::string &name) {
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+      throw std::runtime_error("failed to open shared memory segment " + name);
+    }
+
+    struct stat status {};
+    void *segment = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(Header)) {
+      segment = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (segment == MAP_FAILED) {
+      throw std::runtime_error("failed to map shared memory segment " + name);
+    }
+
+    const auto segment_bytes = static_cast<std::size_t>(status.st_size);
+    auto table = SharedHashTable(name, segment, segment_bytes);
+    if (table.header_->magic.load(std::memory_order_acquire) != kMagic
+        || table.header_->segment_bytes != segment_bytes) {
+      throw std::runtime_error("shared memory segment " + name + " does not hold a hash table");
+    }
+    return table;
+  }
+
+  bool SharedHashTable::Unlink(const std::string &name) {
+    return shm_unlink(name.c_str()) == 0;
+  }
+
+  std::uint64_t SharedHashTable::allocate(std::size_t bytes) {
+    const int block_class = size_class(bytes);
+    std::uint64_t &free_list = header_->free_lists[block_class];
+
+    if (free_list != 0) {
+      const std::uint64_t block = free_list;
+      free_list = *at<std::uint64_t>(block);
+      return block;
+    }
+
+    if (header_->top + class_bytes(block_class) > header_->segment_bytes) {
+      return 0;
+    }
+    const std::uint64_t block = header_->top;
+    header_->top += class_bytes(block_class);
+    return block;
+  }
+
+  void SharedHashTable::deallocate(std::uint64_t offset, std::size_t bytes) {
+    std::uint64_t &free_list = header_->free_lists[size_class(bytes)];
+    *at<std::uint64_t>(offset) = free_list;
+    free_list = offset;
+  }
+
+  std::uint64_t SharedHashTable::find(int key) const {
+    const auto *buckets = at<std::uint64_t>(header_->buckets);
+    for (std::uint64_t entry = buckets[utils::hash(key, header_->capacity)]; entry != 0;
+         entry = at<Entry>(entry)->next) {
+      if (at<Entry>(entry)->key == key) {
+        return entry;
+      }
+    }
+    return 0;
+  }
+
+  bool SharedHashTable::is_valid(std::uint64_t offset, std::size_t bytes) const {
+    return offset >= sizeof(Header) && offset <= segment_bytes_ && bytes <= segment_bytes_ - offset;
+  }
+
+  bool SharedHashTable::find_unlocked(int key, std::uint64_t &entry) const {
+    const int capacity = header_->capacity;
+    const std::uint64_t buckets = header_->buckets;
+    if (capacity <= 0 || !is_valid(buckets, sizeof(std::uint64_t) * capacity)) {
+      return false;
+    }
+
+    // a chain longer than the segment can hold has run into recycled blocks
+    const std::size_t max_steps = segment_bytes_ / sizeof(Entry);
+    entry = at<std::uint64_t>(buckets)[utils::hash(key, capacity)];
+    for (std::size_t steps = 0; entry != 0; steps++) {
+      if (steps == max_steps || !is_valid(entry, sizeof(Entry))) {
+        return false;
+      }
+      const Entry &current = *at<Entry>(entry);
+      if (current.key == key) {
+        return true;
+      }
+      entry = current.next;
+    }
+    return true;
+  }
+
+  template <typename Reader>
+  void SharedHashTable::read(const Reader &reader) const {
+    auto &sequence = header_->sequence;
+
+    for (int attempt = 0; attempt < kMaxOptimisticReads; attempt++) {
+      const std::uint64_t before = sequence.load(std::memory_order_acquire);
+      if (before % 2 == 0 && reader()) {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) {
+          return;
+        }
+      }
+      std::this_thread::yield();
+    }
+
+    Lock lock(header_->lock);
+    const std::uint64_t current = sequence.load(std::memory_order_relaxed);
+    if (current % 2 != 0) {
+      sequence.store(current + 1, std::memory_order_release);  // the writer died, the table is as it left it
+    }
+    reader();
+  }
+
+  void SharedHashTable::grow() {
+    const int capacity = header_->capacity * kGrowthCoefficient;
+    const std::uint64_t buckets = allocate(sizeof(std::uint64_t) * capacity);
+    if (buckets == 0) {
+      return;  // longer chains are still better than failing the Put
+    }
+
+    auto *new_buckets = at<std::uint64_t>(buckets);
+    std::memset(new_buckets, 0, sizeof(std::uint64_t) * capacity);
+
+    auto *old_buckets = at<std::uint64_t>(header_->buckets);
+    for (int index = 0; index < header_->capacity; index++) {
+      std::uint64_t entry = old_buckets[index];
+      while (entry != 0) {
+        Entry &current = *at<Entry>(entry);
+        const std::uint64_t next = current.next;
+        std::uint64_t &head = new_buckets[utils::hash(current.key, capacity)];
+        current.next = head;
+        head = entry;
+        entry = next;
+      }
+    }
+
+    deallocate(header_->buckets, sizeof(std::uint64_t) * header_->capacity);
+    header_->buckets = buckets;
+    header_->capacity = capacity;
+  }
+
+  std::optional<std::string> SharedHashTable::Search(int key) const {
+    std::optional<std::string> value;
+    read([this, key, &value] {
+      std::uint64_t entry = 0;
+      if (!find_unlocked(key, entry)) {
+        return false;
+      }
+      if (entry == 0) {
+        value.reset();
+        return true;
+      }
+
+      const Entry found = *at<Entry>(entry);
+      if (found.value_size != 0 && !is_valid(found.value, found.value_size)) {
+        return false;
+      }
+      value.emplace(at<const char>(found.value), found.value_size);
+      return true;
+    });
+    return value;
+  }
+
+  void SharedHashTable::Put(int key, const std::string &value) {
+    if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::logic_error("shared hash table values must be shorter than 4 GiB");
+    }
+    Lock lock(header_->lock);
+    WriteSection section(header_->sequence);
+
+    const std::uint64_t existing = find(key);
+    const bool is_reused = existing != 0 && at<Entry>(existing)->value_size != 0 && !value.empty()
+                        && size_class(at<Entry>(existing)->value_size) == size_class(value.size());
+
+    // allocate everything first, so that a full segment leaves the table unchanged
+    std::uint64_t value_block = is_reused ? at<Entry>(existing)->value : 0;
+    if (!is_reused && !value.empty()) {
+      value_block = allocate(value.size());
+      if (value_block == 0) {
+        throw std::runtime_error("shared memory segment " + name_ + " is full");
+      }
+    }
+
+    std::uint64_t entry = existing;
+    if (entry == 0) {
+      entry = allocate(sizeof(Entry));
+      if (entry == 0) {
+        if (value_block != 0) {
+          deallocate(value_block, value.size());
+        }
+        throw std::runtime_error("shared memory segment " + name_ + " is full");
+      }
+
+      std::uint64_t &head = at<std::uint64_t>(header_->buckets)[utils::hash(key, header_->capacity)];
+      *at<Entry>(entry) = Entry{head, 0, 0, key};
+      head = entry;
+      header_->num_keys++;
+    }
+
+    Entry &target = *at<Entry>(entry);
+    const Entry previous = target;
+    if (!value.empty()) {
+      std::memcpy(at<char>(value_block), value.data(), value.size());
+    }
+    target.value = value_block;
+    target.value_size = static_cast<std::uint32_t>(value.size());
+    if (!is_reused && previous.value_size != 0) {
+      deallocate(previous.value, previous.value_size);
+    }
+
+    if (static_cast<double>(header_->num_keys) / header_->capacity >= kLoadFactor) {
+      grow();
+    }
+  }
+
+  std::optional<std::string> SharedHashTable::Remove(int key) {
+    Lock lock(header_->lock);
+    WriteSection section(header_->sequence);
+
+    std::uint64_t *link = &at<std::uint64_t>(header_->buckets)[utils::hash(key, header_->capacity)];
+    while (*link != 0 && at<Entry>(*link)->key != key) {
+      link = &at<Entry>(*link)->next;
+    }
+    if (*link == 0) {
+      return std::nullopt;
+    }
+
+    const std::uint64_t entry = *link;
+    const Entry removed = *at<Entry>(entry);
+    *link = removed.next;
+
+    auto value = std::string(at<const char>(removed.value), removed.value_size);
+    if (removed.value_size != 0) {
+      deallocate(removed.value, removed.value_size);
+    }
+    deallocate(entry, sizeof(Entry));
+    header_->num_keys--;
+    return value;
+  }
+
+  bool SharedHashTable::ContainsKey(int key) const {
+    std::uint64_t entry = 0;
+    read([this, key, &entry] { return find_unlocked(key, entry); });
+    return entry != 0;
+  }
+
+  bool SharedHashTable::empty() const {
+    return size() == 0;
+  }
+
+  int SharedHashTable::size() const {
+    int num_keys = 0;
+    read([this, &num_keys] {
+      num_keys = header_->num_keys;
+      return true;
+    });
+    return num_keys;
+  }
+
+  int SharedHashTable::capacity() const {
+    int capacity = 0;
+    read([this, &capacity] {
+      capacity = header_->capacity;
+      return true;
+    });
+    return capacity;
+  }
+
+  std::unordered_set<int> SharedHashTable::keys() const {
+    Lock lock(header_->lock);
+
+    std::unordered_set<int> keys;
+    keys.reserve(header_->num_keys);
+    const auto *buckets = at<std::uint64_t>(header_->buckets);
+    for (int index = 0; index < header_->capacity; index++) {
+      for (std::uint64_t entry = buckets[index]; entry != 0; entry = at<Entry>(entry)->next) {
+        keys.insert(at<Entry>(entry)->key);
+      }
+    }
+    return keys;
+  }
+
+  std::size_t SharedHashTable::bytes_used() const {
+    Lock lock(header_->lock);
+    return header_->top;
+  }
+
+  std::size_t SharedHashTable::segment_bytes() const {
+    return segment_bytes_;
+  }
+
+  const std::string &SharedHashTable::name() const {
+    return name_;
+  }
+
+}  // namespace itis
@@ -0,0 +1,92 @@
+#include "timer_wheel.hpp"
+
+#include <algorithm>  // min
+
+namespace itis {
+
+  TimerWheel::TimerWheel(std::chrono::milliseconds now) : now_{now.count()} {}
+
+  void TimerWheel::schedule(const Timer &timer) {
+    const std::int64_t deadline = timer.second.count();
+    const std::int64_t delta = deadline - now_;
+
+    for (int level = 0; level < kLevels; level++) {
+      if (delta < (std::int64_t{1} << (kBitsPerLevel * (level + 1)))) {
+        const auto slot = (deadline >> (kBitsPerLevel * level)) & (kSlotsPerLevel - 1);
+        levels_[level][slot].push_back(timer);
+        level_sizes_[level]++;
+        return;
+      }
+    }
+    overflow_.push_back(timer);
+  }
+
+  void TimerWheel::Schedule(int key, std::chrono::milliseconds deadline) {
+    // the slot of the current tick has already been processed
+    if (deadline.count() <= now_) {
+      due_.emplace_back(key, deadline);
+    } else {
+      schedule({key, deadline});
+    }
+    num_timers_++;
+  }
+
+  std::vector<TimerWheel::Timer> TimerWheel::Advance(std::chrono::milliseconds now) {
+    std::vector<Timer> expired;
+    expired.swap(due_);
+    num_timers_ -= static_cast<int>(expired.size());
+
+    while (now_ < now.count() && num_timers_ > 0) {
+      // nothing can fire or cascade before the next turn of the first non-empty level: skip to it
+      int level = 0;
+      while (level < kLevels && level_sizes_[level] == 0) {
+        level++;
+      }
+      if (level > 0) {
+        const std::int64_t next_turn = ((now_ >> (kBitsPerLevel * level)) + 1) << (kBitsPerLevel * level);
+        now_ = std::min(next_turn, now.count()) - 1;
+      }
+
+      now_++;
+
+      // entering a new turn of a level: move the timers of its current slot down to the finer levels
+      for (int level = 1; level < kLevels; level++) {
+        if ((now_ & ((std::int64_t{1} << (kBitsPerLevel * level)) - 1)) != 0) {
+          break;
+        }
+
+        Slot cascading;
+        cascading.swap(levels_[level][(now_ >> (kBitsPerLevel * level)) & (kSlotsPerLevel - 1)]);
+        level_sizes_[level] -= static_cast<int>(cascading.size());
+        for (const auto &timer : cascading) {
+          schedule(timer);
+        }
+
+        if (level == kLevels - 1) {
+          Slot overflow;
+          overflow.swap(overflow_);
+          for (const auto &timer : overflow) {
+            schedule(timer);
+          }
+        }
+      }
+
+      Slot &slot = levels_[0][now_ & (kSlotsPerLevel - 1)];
+      num_timers_ -= static_cast<int>(slot.size());
+      level_sizes_[0] -= static_cast<int>(slot.size());
+      expired.insert(expired.end(), slot.begin(), slot.end());
+      slot.clear();
+    }
+
+    // nothing is pending: jump straight to the given time
+    if (now_ < now.count()) {
+      now_ = now.count();
+    }
+    return expired;
+  }
+
+  int TimerWheel::size() const {
+    return num_timers_;
+  }
+
+}  // namespace itis
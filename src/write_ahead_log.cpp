@@ -0,0 +1,224 @@
+#include "write_ahead_log.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>  // memcpy
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace itis {
+
+  namespace {
+
+    constexpr std::size_t kHeaderSize = 4 + 1 + 4 + 4;  // crc, type, key, value length
+
+    // CRC-32 (IEEE 802.3), one table lookup per byte
+    std::uint32_t crc32(const char *data, std::size_t size) {
+      static const auto table = [] {
+        std::array<std::uint32_t, 256> table{};
+        for (std::uint32_t byte = 0; byte < 256; byte++) {
+          std::uint32_t crc = byte;
+          for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1U) != 0 ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+          }
+          table[byte] = crc;
+        }
+        return table;
+      }();
+
+      std::uint32_t crc = 0xFFFFFFFFU;
+      for (std::size_t index = 0; index < size; index++) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[index])) & 0xFFU] ^ (crc >> 8U);
+      }
+      return crc ^ 0xFFFFFFFFU;
+    }
+
+    void write_all(int fd, const std::string &data) {
+      std::size_t written = 0;
+      while (written < data.size()) {
+        const ssize_t result = write(fd, data.data() + written, data.size() - written);
+        if (result == -1) {
+          if (errno == EINTR) {
+            continue;
+          }
+          throw std::runtime_error("failed to write the write-ahead log");
+        }
+        written += static_cast<std::size_t>(result);
+      }
+    }
+
+  }  // namespace
+
+  WriteAheadLog::WriteAheadLog(const std::string &path, std::size_t group_commit_bytes)
+      : group_commit_bytes_{group_commit_bytes} {
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1) {
+      throw std::runtime_error("failed to open the write-ahead log " + path);
+    }
+  }
+
+  WriteAheadLog::~WriteAheadLog() {
+    try {
+      Sync();
+    } catch (const std::runtime_error &) {
+      // nothing else can be done about the unflushed records here
+    }
+    close(fd_);
+  }
+
+  std::vector<WriteAheadLog::Record> WriteAheadLog::Recover() {
+    std::string data;
+    char chunk[1 << 16];
+    for (off_t offset = 0;;) {
+      const ssize_t result = pread(fd_, chunk, sizeof(chunk), offset);
+      if (result == -1 && errno == EINTR) {
+        continue;
+      }
+      if (result == -1) {
+        throw std::runtime_error("failed to read the write-ahead log");
+      }
+      if (result == 0) {
+        break;
+      }
+      data.append(chunk, static_cast<std::size_t>(result));
+      offset += result;
+    }
+
+    std::vector<Record> records;
+    std::size_t offset = 0;
+    while (data.size() - offset >= kHeaderSize) {
+      std::uint32_t crc = 0;
+      std::uint8_t type = 0;
+      int key = 0;
+      std::uint32_t length = 0;
+      std::memcpy(&crc, &data[offset], 4);
+      std::memcpy(&type, &data[offset + 4], 1);
+      std::memcpy(&key, &data[offset + 5], 4);
+      std::memcpy(&length, &data[offset + 9], 4);
+
+      const bool is_complete = data.size() - offset - kHeaderSize >= length;
+      if (!is_complete || crc32(&data[offset + 4], kHeaderSize - 4 + length) != crc
+          || (type != static_cast<std::uint8_t>(RecordType::kPut)
+              && type != static_cast<std::uint8_t>(RecordType::kRemove))) {
+        break;
+      }
+
+      records.push_back(Record{static_cast<RecordType>(type), key, data.substr(offset + kHeaderSize, length)});
+      offset += kHeaderSize + length;
+    }
+
+    // a crash in the middle of a write leaves a partial record, new records must not be appended after it
+    if (offset < data.size() && ftruncate(fd_, static_cast<off_t>(offset)) == -1) {
+      throw std::runtime_error("failed to truncate the write-ahead log");
+    }
+    return records;
+  }
+
+  std::uint64_t WriteAheadLog::Append(RecordType type, int key, const std::string &value) {
+    if (value.size() > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::logic_error("write-ahead log values must be shorter than 4 GiB");
+    }
+
+    char header[kHeaderSize];
+    const auto length = static_cast<std::uint32_t>(value.size());
+    const auto type_byte = static_cast<std::uint8_t>(type);
+    std::memcpy(&header[4], &type_byte, 1);
+    std::memcpy(&header[5], &key, 4);
+    std::memcpy(&header[9], &length, 4);
+
+    // crc32 of the rest of the header continued over the value
+    std::string record(header, kHeaderSize);
+    record += value;
+    const std::uint32_t crc = crc32(&record[4], record.size() - 4);
+    std::memcpy(&record[0], &crc, 4);
+
+    std::uint64_t lsn = 0;
+    bool is_full = false;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      buffer_ += record;
+      lsn = next_lsn_++;
+      is_full = buffer_.size() >= group_commit_bytes_;
+    }
+
+    if (is_full) {
+      Commit(lsn);
+    }
+    return lsn;
+  }
+
+  void WriteAheadLog::Commit(std::uint64_t lsn) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (durable_lsn_ < lsn) {
+      if (is_broken_) {
+        throw std::runtime_error("write-ahead log is broken by a failed write");
+      }
+      if (is_flushing_) {
+        flushed_.wait(lock);
+        continue;
+      }
+
+      // become the leader: flush everything appended so far, including the records of the waiting committers
+      is_flushing_ = true;
+      std::string batch;
+      batch.swap(buffer_);
+      const std::uint64_t batch_lsn = next_lsn_ - 1;
+      lock.unlock();
+
+      bool is_written = true;
+      try {
+        write_all(fd_, batch);
+        is_written = fdatasync(fd_) == 0;
+      } catch (const std::runtime_error &) {
+        is_written = false;
+      }
+
+      lock.lock();
+      is_flushing_ = false;
+      flushed_.notify_all();
+      if (!is_written) {
+        // the batch may be partially written, the following records must not be appended after it
+        is_broken_ = true;
+        throw std::runtime_error("failed to sync the write-ahead log");
+      }
+      durable_lsn_ = batch_lsn;
+      num_syncs_++;
+    }
+  }
+
+  void WriteAheadLog::Sync() {
+    std::uint64_t lsn = 0;
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      lsn = next_lsn_ - 1;
+    }
+    Commit(lsn);
+  }
+
+  void WriteAheadLog::Truncate() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushed_.wait(lock, [this] { return !is_flushing_; });
+
+    if (ftruncate(fd_, 0) == -1) {
+      throw std::runtime_error("failed to truncate the write-ahead log");
+    }
+    buffer_.clear();
+    durable_lsn_ = next_lsn_ - 1;
+    flushed_.notify_all();
+  }
+
+  std::uint64_t WriteAheadLog::durable_lsn() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return durable_lsn_;
+  }
+
+  std::uint64_t WriteAheadLog::num_syncs() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return num_syncs_;
+  }
+
+}  // namespace itis
@@ -0,0 +1,189 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include "aggregate_table.hpp"
+#include "test_data.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  struct Stats {
+    long count;
+    long sum;
+  };
+
+  struct Row {
+    int key;
+    long amount;
+  };
+
+  void add(Stats &stats, const Row &row) {
+    stats.count++;
+    stats.sum += row.amount;
+  }
+
+  void combine(Stats &into, const Stats &from) {
+    into.count += from.count;
+    into.sum += from.sum;
+  }
+
+  std::vector<Row> make_rows(int num_rows, int num_keys) {
+    const auto keys = test_data::scattered_keys(num_rows, num_keys, -num_keys / 2, 7919);
+    std::vector<Row> rows;
+    for (int index = 0; index < num_rows; index++) {
+      rows.push_back(Row{keys[index], index % 100});
+    }
+    return rows;
+  }
+
+  std::map<int, std::pair<long, long>> expected_stats(const std::vector<Row> &rows) {
+    std::map<int, std::pair<long, long>> expected;
+    for (const auto &row : rows) {
+      expected[row.key].first++;
+      expected[row.key].second += row.amount;
+    }
+    return expected;
+  }
+
+}  // namespace
+
+SCENARIO("aggregating by key") {
+
+  GIVEN("empty aggregate table") {
+    auto table = AggregateTable<int, Stats>(2);
+
+    WHEN("rows are upserted") {
+      const auto rows = make_rows(10000, 1000);
+      for (const auto &row : rows) {
+        table.Upsert(row.key, [&](Stats &stats) { add(stats, row); });
+      }
+
+      THEN("every key should have the count and the sum of its rows") {
+        const auto expected = expected_stats(rows);
+        REQUIRE(table.size() == static_cast<int>(expected.size()));
+        for (const auto &[key, stats] : expected) {
+          const auto found = table.Search(key);
+          REQUIRE(found.has_value());
+          CHECK(found->count == stats.first);
+          CHECK(found->sum == stats.second);
+        }
+        CHECK_FALSE(table.ContainsKey(1000000));
+        CHECK(table.capacity() >= table.size() / AggregateTable<int, Stats>::kLoadFactor);
+      }
+    }
+
+    WHEN("a new key is upserted") {
+      const auto &stats = table.Upsert(5, [](Stats &) {});
+
+      THEN("its aggregate should be value-initialized") {
+        CHECK(stats.count == 0);
+        CHECK(stats.sum == 0);
+        CHECK(table.size() == 1);
+      }
+    }
+  }
+
+  GIVEN("two partial aggregations") {
+    auto left = AggregateTable<int, Stats>();
+    auto right = AggregateTable<int, Stats>();
+    left.Upsert(1, [](Stats &stats) { stats = {1, 10}; });
+    left.Upsert(2, [](Stats &stats) { stats = {2, 20}; });
+    right.Upsert(2, [](Stats &stats) { stats = {3, 30}; });
+    right.Upsert(3, [](Stats &stats) { stats = {4, 40}; });
+
+    WHEN("they are merged") {
+      left.Merge(right, combine);
+
+      THEN("the aggregates of the shared keys should be combined") {
+        CHECK(left.size() == 3);
+        CHECK(left.Search(1)->sum == 10);
+        CHECK(left.Search(2)->count == 5);
+        CHECK(left.Search(2)->sum == 50);
+        CHECK(left.Search(3)->sum == 40);
+      }
+    }
+  }
+
+  GIVEN("rows aggregated by several threads") {
+    const auto rows = make_rows(50000, 3000);
+    const int num_threads = GENERATE(1, 4);
+
+    const auto table = AggregateParallel<int, Stats>(
+        rows, [](const Row &row) { return row.key; }, add, combine, num_threads);
+
+    THEN("the result should match a sequential aggregation") {
+      const auto expected = expected_stats(rows);
+      REQUIRE(table.size() == static_cast<int>(expected.size()));
+      for (const auto &[key, stats] : expected) {
+        CHECK(table.Search(key)->count == stats.first);
+        CHECK(table.Search(key)->sum == stats.second);
+      }
+    }
+  }
+
+  GIVEN("rows one of which fails to aggregate") {
+    const auto rows = make_rows(10000, 100);
+    const auto update = [](Stats &stats, const Row &row) {
+      if (row.amount == 99) {
+        throw std::runtime_error("bad row");
+      }
+      add(stats, row);
+    };
+
+    THEN("the exception should be rethrown on the calling thread") {
+      CHECK_THROWS_WITH((AggregateParallel<int, Stats>(rows, [](const Row &row) { return row.key; }, update, combine,
+                                                       4)),
+                        "bad row");
+    }
+  }
+
+  GIVEN("aggregate table with a small memory budget") {
+    auto table = SpillingAggregateTable<int, Stats>(16 * 1024, 8);
+    const auto rows = make_rows(100000, 20000);
+
+    WHEN("more keys are aggregated than fit into the budget") {
+      for (const auto &row : rows) {
+        table.Upsert(row.key, [&](Stats &stats) { add(stats, row); });
+      }
+
+      THEN("it should spill and still emit every key once with its final aggregate") {
+        CHECK(table.num_spills() > 0);
+
+        std::map<int, std::pair<long, long>> emitted;
+        table.Finish(combine, [&](int key, const Stats &stats) {
+          CHECK(emitted.count(key) == 0);
+          emitted[key] = {stats.count, stats.sum};
+        });
+        CHECK(emitted == expected_stats(rows));
+        CHECK(table.size() == 0);
+      }
+    }
+
+    WHEN("the keys fit into the budget") {
+      for (int key = 0; key < 10; key++) {
+        table.Upsert(key, [](Stats &stats) { stats.count++; });
+      }
+
+      THEN("nothing should be spilled") {
+        int num_emitted = 0;
+        table.Finish(combine, [&](int, const Stats &stats) {
+          CHECK(stats.count == 1);
+          num_emitted++;
+        });
+        CHECK(table.num_spills() == 0);
+        CHECK(num_emitted == 10);
+      }
+    }
+  }
+
+  GIVEN("invalid parameters") {
+    CHECK_THROWS_AS((AggregateTable<int, Stats>(0)), std::logic_error);
+    CHECK_THROWS_AS((SpillingAggregateTable<int, Stats>(0)), std::logic_error);
+    CHECK_THROWS_AS((SpillingAggregateTable<int, Stats>(1024, 0)), std::logic_error);
+  }
+}
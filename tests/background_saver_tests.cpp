@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdio>  // remove
+#include <fstream>
+#include <sstream>
+#include <string>  // to_string
+#include <thread>
+
+#include <unistd.h>  // getpid
+
+#include "background_saver.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("hash table save and load") {
+
+  GIVEN("hash table with some pairs") {
+    auto hash_table = HashTable(8);
+    for (int key = -50; key < 500; key++) {
+      hash_table.Put(key, std::string((key + 50) % 7 + 1, 'x') + std::to_string(key));
+    }
+
+    WHEN("saving it to a stream and loading it back") {
+      std::stringstream stream;
+      hash_table.Save(stream);
+      const auto loaded = HashTable::Load(stream);
+
+      THEN("the loaded table should have the same pairs") {
+        CHECK(loaded.size() == hash_table.size());
+        CHECK(loaded.capacity() == hash_table.capacity());
+        for (int key = -50; key < 500; key++) {
+          CHECK(loaded.Search(key) == hash_table.Search(key));
+        }
+      }
+    }
+
+    AND_WHEN("loading a truncated stream") {
+      std::stringstream stream;
+      hash_table.Save(stream);
+      const std::string data = stream.str();
+      std::stringstream truncated(data.substr(0, data.size() / 2));
+
+      THEN("loading should fail") {
+        CHECK_THROWS_AS(HashTable::Load(truncated), std::runtime_error);
+      }
+    }
+  }
+}
+
+SCENARIO("background save of a hash table") {
+
+  GIVEN("hash table and a background saver") {
+    const std::string path = "/tmp/itis_background_save_" + std::to_string(getpid()) + ".bin";
+    auto hash_table = HashTable(16);
+    for (int key = 0; key < 10000; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    auto saver = BackgroundSaver();
+    REQUIRE(saver.status() == BackgroundSaver::Status::kIdle);
+
+    WHEN("saving while the table keeps changing") {
+      int num_callbacks = 0;
+      auto reported = BackgroundSaver::Status::kIdle;
+      saver.BackgroundSave(hash_table, path, [&](BackgroundSaver::Status status) {
+        num_callbacks++;
+        reported = status;
+      });
+
+      for (int key = 0; key < 10000; key += 2) {
+        hash_table.Remove(key);
+      }
+      hash_table.Put(-1, "after the save");
+
+      CHECK_THROWS_AS(saver.BackgroundSave(hash_table, path), std::logic_error);
+
+      while (saver.Poll() == BackgroundSaver::Status::kInProgress) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      THEN("the checkpoint should hold the table as of the start of the save") {
+        REQUIRE(saver.status() == BackgroundSaver::Status::kSucceeded);
+        CHECK(num_callbacks == 1);
+        CHECK(reported == BackgroundSaver::Status::kSucceeded);
+
+        std::ifstream input(path, std::ios::binary);
+        const auto loaded = HashTable::Load(input);
+        CHECK(loaded.size() == 10000);
+        CHECK(loaded.Search(0).value() == "0");
+        CHECK_FALSE(loaded.ContainsKey(-1));
+      }
+
+      std::remove(path.c_str());
+    }
+
+    AND_WHEN("saving to a directory that does not exist") {
+      saver.BackgroundSave(hash_table, "/nonexistent/directory/table.bin");
+
+      THEN("the save should fail") {
+        CHECK(saver.Wait() == BackgroundSaver::Status::kFailed);
+      }
+    }
+  }
+}
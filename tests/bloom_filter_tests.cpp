@@ -0,0 +1,92 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+
+#include "bloom_filter.hpp"
+#include "hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("bloom filter") {
+
+  GIVEN("bloom filter with inserted keys") {
+    const double false_positive_rate = GENERATE(0.1, 0.01, 0.001);
+    const int num_keys = 10'000;
+    auto filter = BloomFilter(num_keys, false_positive_rate);
+
+    for (int key = 0; key < num_keys; key++) {
+      filter.Insert(key * 3);
+    }
+
+    WHEN("checking the inserted keys") {
+
+      THEN("there should be no false negatives") {
+        bool all_found = true;
+        for (int key = 0; key < num_keys; key++) {
+          all_found = all_found && filter.MayContain(key * 3);
+        }
+        CHECK(all_found);
+      }
+    }
+
+    AND_WHEN("checking absent keys") {
+      int false_positives = 0;
+      const int num_probes = 100'000;
+      for (int key = 0; key < num_probes; key++) {
+        false_positives += filter.MayContain(-key - 1) ? 1 : 0;
+      }
+
+      THEN("the false positive rate should be close to the target") {
+        CHECK(static_cast<double>(false_positives) / num_probes < false_positive_rate * 1.5);
+      }
+    }
+  }
+}
+
+SCENARIO("hash table with bloom filter") {
+
+  GIVEN("hash table with the bloom filter enabled") {
+    auto hash_table = HashTable(4);
+    hash_table.EnableBloomFilter(0.01);
+
+    REQUIRE(hash_table.bloom_filter_bytes() > 0);
+
+    for (int key = 0; key < 1000; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    WHEN("searching for present and absent keys after growth") {
+
+      THEN("the results should be the same as without the filter") {
+        for (int key = -500; key < 1500; key++) {
+          CHECK(hash_table.ContainsKey(key) == (key >= 0 && key < 1000));
+        }
+      }
+    }
+
+    AND_WHEN("removing most of the keys") {
+      for (int key = 0; key < 900; key++) {
+        REQUIRE(hash_table.Remove(key).has_value());
+      }
+
+      THEN("removed keys should not be found and the rest should") {
+        for (int key = 0; key < 1000; key++) {
+          CHECK(hash_table.Search(key).has_value() == (key >= 900));
+        }
+        CHECK_FALSE(hash_table.Remove(0).has_value());
+      }
+    }
+
+    AND_WHEN("enabling the filter with an invalid rate") {
+
+      const int bytes = hash_table.bloom_filter_bytes();
+
+      THEN("an exception must be thrown and the current filter kept") {
+        REQUIRE_THROWS_AS(hash_table.EnableBloomFilter(1.0), std::logic_error);
+        CHECK(hash_table.bloom_filter_bytes() == bytes);
+        CHECK_FALSE(hash_table.ContainsKey(5000));
+      }
+    }
+  }
+}
@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>  // remove
+#include <fstream>
+#include <stdexcept>
+#include <string>  // to_string
+
+#include <unistd.h>  // getpid
+
+#include "bulk_loader.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  void write_file(const std::string &path, const std::string &content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+  }
+
+}  // namespace
+
+SCENARIO("bulk loading of key-value files") {
+
+  const std::string path = "/tmp/itis_bulk_" + std::to_string(getpid()) + ".txt";
+
+  GIVEN("tab-separated file with Windows line ends, empty lines and a repeated key") {
+    write_file(path, "1\tone\r\n-2\tminus two\r\n\r\n\n3\t\r\n1\tuno\n4\tno newline at the end");
+
+    WHEN("it is loaded") {
+      const auto table = LoadKeyValueFile(path);
+
+      THEN("every key should have the value of its last line") {
+        CHECK(table.size() == 4);
+        CHECK(table.Search(1) == "uno");
+        CHECK(table.Search(-2) == "minus two");
+        CHECK(table.Search(3) == "");
+        CHECK(table.Search(4) == "no newline at the end");
+      }
+    }
+  }
+
+  GIVEN("comma-separated file") {
+    write_file(path, "10,a,b\n20,c\n");
+
+    WHEN("it is loaded with the comma delimiter") {
+      const auto table = LoadKeyValueFile(path, BulkLoadOptions{',', 1});
+
+      THEN("the value should be everything after the first comma") {
+        CHECK(table.size() == 2);
+        CHECK(table.Search(10) == "a,b");
+        CHECK(table.Search(20) == "c");
+      }
+    }
+  }
+
+  GIVEN("file of several chunks") {
+    const int num_keys = 200000;  // ~3 MiB
+    std::string content;
+    for (int key = 0; key < num_keys; key++) {
+      content += std::to_string(key) + "\tvalue " + std::to_string(key) + "\n";
+    }
+    for (int key = 0; key < num_keys; key += 1000) {
+      content += std::to_string(key) + "\tupdated\n";
+    }
+    write_file(path, content);
+
+    WHEN("it is parsed by several threads") {
+      const auto table = LoadKeyValueFile(path, BulkLoadOptions{'\t', 4});
+
+      THEN("no line should be lost or reordered across the chunk boundaries") {
+        REQUIRE(table.size() == num_keys);
+        for (int key = 0; key < num_keys; key++) {
+          CHECK(table.Search(key) == (key % 1000 == 0 ? "updated" : "value " + std::to_string(key)));
+        }
+      }
+    }
+  }
+
+  GIVEN("file of several chunks with a malformed line in a later chunk") {
+    const int num_keys = 200000;  // ~3 MiB, so the malformed line is past the first chunk
+    std::string content;
+    for (int key = 0; key < num_keys; key++) {
+      if (key == 100000) {
+        content += "\n";
+      }
+      content += key == 150000 ? "malformed\n" : std::to_string(key) + "\tvalue " + std::to_string(key) + "\n";
+    }
+    write_file(path, content);
+
+    THEN("parsing by several threads should report its line number in the whole file") {
+      CHECK_THROWS_WITH(LoadKeyValueFile(path, BulkLoadOptions{'\t', 4}), "malformed line 150002 of " + path);
+    }
+  }
+
+  GIVEN("malformed files") {
+    const auto content = GENERATE(std::string("1\tone\n\nx\ttwo\n"), std::string("1\tone\n\n3 no delimiter\n"),
+                                  std::string("1\tone\n\n99999999999\ttoo big\n"));
+    write_file(path, content);
+
+    THEN("loading should report the line number") {
+      CHECK_THROWS_WITH(LoadKeyValueFile(path), "malformed line 3 of " + path);
+    }
+  }
+
+  GIVEN("empty file") {
+    write_file(path, "");
+
+    THEN("the table should be empty") {
+      CHECK(LoadKeyValueFile(path).empty());
+    }
+  }
+
+  GIVEN("missing file") {
+    std::remove(path.c_str());
+
+    THEN("loading should fail") {
+      CHECK_THROWS_AS(LoadKeyValueFile(path), std::runtime_error);
+    }
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,158 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <string>  // to_string
+#include <thread>
+#include <vector>
+
+#include "hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("change data capture of a hash table") {
+
+  GIVEN("hash table with a subscriber") {
+    auto table = HashTable(4);
+    table.Put(-1, "before the subscription");
+    auto stream = table.Subscribe(16);
+
+    WHEN("the table is mutated") {
+      table.Put(1, "one");
+      table.Put(1, "uno");
+      table.Put(2, "two");
+      table.Remove(1);
+      table.Remove(100);  // nothing is removed, nothing is published
+      table.Search(2);
+
+      std::vector<ChangeEvent> batch;
+      const auto count = stream->Consume(batch);
+
+      THEN("every mutation since the subscription should be delivered in order") {
+        REQUIRE(count == 4);
+        CHECK(batch[0].type == ChangeEvent::Type::kPut);
+        CHECK(batch[0].key == 1);
+        CHECK(batch[0].value == "one");
+        CHECK(batch[1].value == "uno");
+        CHECK(batch[2].key == 2);
+        CHECK(batch[3].type == ChangeEvent::Type::kRemove);
+        CHECK(batch[3].value == "uno");
+        for (std::size_t index = 0; index < batch.size(); index++) {
+          CHECK(batch[index].sequence == index + 1);
+        }
+        CHECK(stream->Consume(batch) == 0);
+      }
+    }
+
+    AND_WHEN("the table is copied") {
+      auto copy = table;
+      copy.Put(3, "three");
+
+      THEN("the mutations of the copy should not be delivered") {
+        std::vector<ChangeEvent> batch;
+        CHECK(stream->Consume(batch) == 0);
+      }
+    }
+
+    AND_WHEN("the subscription is closed") {
+      stream->Close();
+      table.Put(4, "four");
+
+      THEN("nothing should be delivered") {
+        std::vector<ChangeEvent> batch;
+        CHECK(stream->Consume(batch) == 0);
+      }
+    }
+  }
+
+  GIVEN("a consumer falling behind") {
+    auto table = HashTable(4);
+    const auto policy = GENERATE(ChangeStream::OverflowPolicy::kDrop, ChangeStream::OverflowPolicy::kOverwrite);
+    auto stream = table.Subscribe(8, policy);
+
+    WHEN("more mutations happen than the stream buffers") {
+      for (int key = 0; key < 20; key++) {
+        table.Put(key, std::to_string(key));
+      }
+
+      std::vector<ChangeEvent> batch;
+      stream->Consume(batch, 5);
+      stream->Consume(batch);
+
+      THEN("the overflow policy should decide which events are kept") {
+        REQUIRE(batch.size() == 8);
+        CHECK(stream->num_lost() == 12);
+        const int first = policy == ChangeStream::OverflowPolicy::kDrop ? 0 : 12;
+        for (int index = 0; index < 8; index++) {
+          CHECK(batch[index].key == first + index);
+          CHECK(batch[index].sequence == static_cast<std::uint64_t>(first + index + 1));
+        }
+      }
+    }
+  }
+
+  GIVEN("a blocking subscription with a full buffer") {
+    auto table = HashTable(4);
+    auto stream = table.Subscribe(1, ChangeStream::OverflowPolicy::kBlock);
+    table.Put(1, "fills the buffer");
+
+    WHEN("the consumer releases the stream without closing it while the writer waits") {
+      auto writer = std::thread([&table] { table.Put(2, "blocks"); });
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      stream.reset();
+      writer.join();
+      table.Put(3, "after the release");
+
+      THEN("the writer should be released") {
+        CHECK(table.Search(2) == "blocks");
+        CHECK(table.Search(3) == "after the release");
+      }
+    }
+  }
+
+  GIVEN("a consumer thread") {
+    constexpr int kNumMutations = 200'000;
+    const auto policy = GENERATE(ChangeStream::OverflowPolicy::kBlock, ChangeStream::OverflowPolicy::kOverwrite);
+    auto table = HashTable(1024);
+    auto stream = table.Subscribe(64, policy);
+
+    WHEN("the table is mutated concurrently with the consumption") {
+      std::uint64_t num_received = 0;
+      bool is_ordered = true;
+      auto consumer = std::thread([&] {
+        std::vector<ChangeEvent> batch;
+        std::uint64_t last_sequence = 0;
+        while (last_sequence < kNumMutations) {
+          batch.clear();
+          const bool is_closed = stream->is_closed();  // checked first: the stream is drained after the close
+          if (stream->Consume(batch, 32) == 0) {
+            if (is_closed) {
+              break;
+            }
+            std::this_thread::yield();
+            continue;
+          }
+          for (const auto &event : batch) {
+            is_ordered = is_ordered && event.sequence > last_sequence && event.key == static_cast<int>(event.sequence);
+            last_sequence = event.sequence;
+          }
+          num_received += batch.size();
+        }
+      });
+
+      for (int key = 1; key <= kNumMutations; key++) {
+        table.Put(key, "v");
+      }
+      stream->Close();  // lets an overwriting consumer stop once the stream is drained
+      consumer.join();
+
+      THEN("the consumer should receive the events in order, all of them unless overwritten") {
+        CHECK(is_ordered);
+        CHECK(num_received + stream->num_lost() == kNumMutations);
+        if (policy == ChangeStream::OverflowPolicy::kBlock) {
+          CHECK(stream->num_lost() == 0);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+#include <thread>
+#include <vector>
+
+#include "clock_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("clock hash table eviction") {
+
+  GIVEN("full clock hash table") {
+    const int max_keys = GENERATE(1, 4, 16);
+    auto hash_table = ClockHashTable(max_keys);
+
+    for (int key = 0; key < max_keys; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    REQUIRE(hash_table.size() == max_keys);
+
+    WHEN("referencing every key but the last one and putting a new key") {
+      for (int key = 0; key < max_keys - 1; key++) {
+        REQUIRE(hash_table.Search(key).value() == std::to_string(key));
+      }
+      hash_table.Put(max_keys, "new");
+
+      THEN("the unreferenced key should be evicted") {
+        CHECK(hash_table.size() == max_keys);
+        CHECK(hash_table.evictions() == 1);
+        CHECK(hash_table.ContainsKey(max_keys));
+        CHECK_FALSE(hash_table.ContainsKey(max_keys - 1));
+      }
+    }
+
+    AND_WHEN("putting many more keys than fit") {
+      for (int key = max_keys; key < max_keys * 100; key++) {
+        hash_table.Put(key, std::to_string(key));
+        hash_table.Remove(key - 1);
+        hash_table.Put(key - 1, std::to_string(key - 1));
+      }
+
+      THEN("the table should stay bounded and consistent") {
+        CHECK(hash_table.size() == max_keys);
+        CHECK(static_cast<int>(hash_table.keys().size()) == max_keys);
+        for (int key : hash_table.keys()) {
+          CHECK(hash_table.Search(key).value() == std::to_string(key));
+        }
+      }
+    }
+  }
+
+  AND_GIVEN("clock hash table at the eviction steady state") {
+    const int max_keys = 1000;
+    auto hash_table = ClockHashTable(max_keys);
+
+    WHEN("putting far more keys than fit") {
+      const int num_puts = 100 * max_keys;
+      for (int key = 0; key < num_puts; key++) {
+        hash_table.Put(key, std::to_string(key));
+      }
+
+      THEN("the tombstones of the evictions should be dropped by occasional rehashes only") {
+        CHECK(hash_table.size() == max_keys);
+        CHECK(hash_table.evictions() == num_puts - max_keys);
+        CHECK(hash_table.rehashes() <= num_puts / static_cast<int>(max_keys * ClockHashTable::kTombstoneHeadroom));
+        for (int key = num_puts - 10; key < num_puts; key++) {
+          CHECK(hash_table.Search(key).value() == std::to_string(key));
+        }
+      }
+    }
+  }
+
+  AND_GIVEN("clock hash table shared by concurrent readers") {
+    auto hash_table = ClockHashTable(1000);
+    for (int key = 0; key < 1000; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    WHEN("searching from several threads at once") {
+      std::vector<std::thread> readers;
+      std::vector<int> found(4, 0);
+      for (int thread = 0; thread < 4; thread++) {
+        readers.emplace_back([&hash_table, &found, thread] {
+          for (int key = 0; key < 1000; key++) {
+            found[thread] += hash_table.Search(key).has_value() ? 1 : 0;
+          }
+        });
+      }
+      for (auto &reader : readers) {
+        reader.join();
+      }
+
+      THEN("every reader should find every key") {
+        for (int count : found) {
+          CHECK(count == 1000);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch.hpp>
+
+#include <string>   // to_string
+#include <utility>  // pair
+#include <vector>
+
+#include "dense_key_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+using Catch::Equals;
+
+SCENARIO("dense key hash table") {
+
+  GIVEN("table in the direct-address mode") {
+    auto hash_table = DenseKeyHashTable(-10, 100);
+
+    for (int key = -10; key <= 100; key += 2) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    REQUIRE(hash_table.is_direct());
+    REQUIRE(hash_table.size() == 56);
+
+    WHEN("searching and removing keys inside the range") {
+      auto removed = hash_table.Remove(0);
+
+      THEN("the table should stay in the direct-address mode") {
+        CHECK(removed.value() == "0");
+        CHECK(hash_table.is_direct());
+        CHECK_FALSE(hash_table.ContainsKey(0));
+        CHECK_FALSE(hash_table.ContainsKey(1));
+        CHECK_FALSE(hash_table.ContainsKey(1000));
+        CHECK(hash_table.Search(98).value() == "98");
+        CHECK(hash_table.size() == 55);
+      }
+    }
+
+    AND_WHEN("putting a key outside the range") {
+      hash_table.Put(1'000'000, "far");
+
+      THEN("the table should fall back to hashing and keep all the pairs") {
+        CHECK_FALSE(hash_table.is_direct());
+        CHECK(hash_table.size() == 57);
+        CHECK(hash_table.Search(1'000'000).value() == "far");
+        for (int key = -10; key <= 100; key += 2) {
+          CHECK(hash_table.Search(key).value() == std::to_string(key));
+        }
+      }
+    }
+  }
+
+  AND_GIVEN("pairs with dense or sparse keys") {
+    std::vector<std::pair<int, std::string>> dense;
+    std::vector<std::pair<int, std::string>> sparse;
+    for (int key = 0; key < 100; key++) {
+      dense.emplace_back(key + 5000, std::to_string(key));
+      sparse.emplace_back(key * 1000, std::to_string(key));
+    }
+
+    WHEN("detecting the mode") {
+      const auto dense_table = DenseKeyHashTable::Detect(dense);
+      const auto sparse_table = DenseKeyHashTable::Detect(sparse);
+
+      THEN("only dense keys should use the direct-address mode") {
+        CHECK(dense_table.is_direct());
+        CHECK_FALSE(sparse_table.is_direct());
+        CHECK(dense_table.size() == 100);
+        CHECK(sparse_table.size() == 100);
+        CHECK(dense_table.Search(5099).value() == "99");
+        CHECK(sparse_table.Search(99'000).value() == "99");
+      }
+
+      AND_THEN("the hash table of sparse keys should be sized for them up front") {
+        CHECK(sparse_table.capacity() == static_cast<int>(100 / HashTable::kDefaultLoadFactor) + 1);
+      }
+    }
+
+    AND_WHEN("the keys span more than the largest direct-address range") {
+      const auto wide_table = DenseKeyHashTable::Detect({{0, "first"}, {1 << 30, "last"}}, 0.0);
+
+      THEN("the table should use hashing") {
+        CHECK_FALSE(wide_table.is_direct());
+        CHECK(wide_table.Search(1 << 30).value() == "last");
+        CHECK_THROWS_AS(DenseKeyHashTable(0, DenseKeyHashTable::kMaxRange), std::logic_error);
+      }
+    }
+  }
+}
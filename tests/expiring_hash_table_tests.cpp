@@ -0,0 +1,133 @@
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>  // to_string
+
+#include "expiring_hash_table.hpp"
+#include "timer_wheel.hpp"
+
+using namespace std;
+using namespace std::chrono_literals;
+using namespace itis;
+
+SCENARIO("timer wheel") {
+
+  GIVEN("timer wheel with timers on every level") {
+    auto wheel = TimerWheel(0ms);
+    const auto deadlines = {1ms, 63ms, 64ms, 65ms, 4095ms, 4096ms, 300'000ms, 20'000'000ms};
+
+    int key = 0;
+    for (const auto deadline : deadlines) {
+      wheel.Schedule(key++, deadline);
+    }
+
+    REQUIRE(wheel.size() == static_cast<int>(deadlines.size()));
+
+    WHEN("advancing the wheel") {
+
+      THEN("every timer should fire exactly at its deadline") {
+        for (const auto deadline : deadlines) {
+          CHECK(wheel.Advance(deadline - 1ms).empty());
+
+          const auto expired = wheel.Advance(deadline);
+          REQUIRE(expired.size() == 1);
+          CHECK(expired.front().second == deadline);
+        }
+        CHECK(wheel.size() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("timer wheel with random deadlines") {
+
+  GIVEN("timer wheel with many random timers") {
+    auto wheel = TimerWheel(1000ms);
+    const int num_timers = 1000;
+    for (int key = 0; key < num_timers; key++) {
+      wheel.Schedule(key, std::chrono::milliseconds(1001 + (key * 7919LL) % 10'000'000));
+    }
+
+    WHEN("advancing the wheel in uneven steps") {
+      int num_fired = 0;
+      bool in_time = true;
+      auto previous = 1000ms;
+      for (auto now = 1000ms; now < 10'002'000ms; now += std::chrono::milliseconds(1 + (now.count() * 31) % 50'000)) {
+        for (const auto &[key, deadline] : wheel.Advance(now)) {
+          in_time = in_time && deadline > previous && deadline <= now;
+          num_fired++;
+        }
+        previous = now;
+      }
+
+      THEN("every timer should fire once, between the previous and the current time") {
+        CHECK(in_time);
+        CHECK(num_fired == num_timers);
+        CHECK(wheel.size() == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("expiring hash table") {
+
+  GIVEN("expiring hash table with a manual clock") {
+    auto time_source = std::make_shared<ManualTimeSource>();
+    auto hash_table = ExpiringHashTable(8, time_source);
+
+    for (int key = 0; key < 100; key++) {
+      hash_table.Put(key, std::to_string(key), std::chrono::milliseconds(10 * (key + 1)));
+    }
+    hash_table.Put(-1, "forever");
+
+    WHEN("time has passed") {
+      time_source->Advance(505ms);
+
+      THEN("the expired pairs should not be found") {
+        for (int key = 0; key < 100; key++) {
+          CHECK(hash_table.Search(key).has_value() == (key >= 50));
+        }
+        CHECK(hash_table.Search(-1).value() == "forever");
+      }
+
+      AND_THEN("the expired pairs should be reclaimed without lookups") {
+        CHECK(hash_table.ReclaimExpired() == 50);
+        CHECK(hash_table.size() == 51);
+        CHECK(hash_table.ReclaimExpired() == 0);
+      }
+    }
+
+    AND_WHEN("a pair is put again without time-to-live") {
+      hash_table.Put(0, "persistent");
+      time_source->Advance(10'000ms);
+
+      THEN("its old timer should be ignored") {
+        CHECK(hash_table.ReclaimExpired() == 99);
+        CHECK(hash_table.Search(0).value() == "persistent");
+        CHECK(hash_table.size() == 2);
+      }
+    }
+
+    AND_WHEN("a pair is put again and again with a long time-to-live") {
+      for (int round = 0; round < 100'000; round++) {
+        hash_table.Put(-2, std::to_string(round), 3'600'000ms);
+      }
+      time_source->Advance(10'000ms);
+
+      THEN("the stale timers should not pile up") {
+        CHECK(hash_table.num_timers() <= ExpiringHashTable::kMinTimersToRebuild);
+        CHECK(hash_table.ReclaimExpired() == 100);
+        CHECK(hash_table.Search(-2).value() == "99999");
+        CHECK(hash_table.values().size() == 2);
+      }
+    }
+
+    AND_WHEN("putting a pair with non-positive time-to-live") {
+
+      THEN("an exception must be thrown") {
+        REQUIRE_THROWS_AS(hash_table.Put(1, "1", 0ms), std::logic_error);
+      }
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch.hpp>
+
+#include <string_view>
+
+#include "fixed_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  constexpr FixedHashTable<int, std::string_view, 4> kStatusCodes{
+      {200, "OK"}, {404, "Not Found"}, {500, "Internal Server Error"}};
+
+  constexpr auto build_squares() {
+    FixedHashTable<int, int, 16> squares;
+    for (int key = -8; key < 8; key++) {
+      squares.Put(key, key * key);
+    }
+    squares.Remove(0);
+    squares.Put(100, 10'000);
+    return squares;
+  }
+
+  constexpr auto kSquares = build_squares();
+
+  // evaluated by the compiler: no storage is initialized at runtime
+  static_assert(kStatusCodes.Search(404) == std::string_view("Not Found"));
+  static_assert(!kStatusCodes.ContainsKey(302));
+  static_assert(kSquares.size() == 16);
+  static_assert(kSquares.Search(-7) == 49);
+  static_assert(!kSquares.Search(0).has_value());
+
+}  // namespace
+
+SCENARIO("fixed hash table") {
+
+  GIVEN("fixed hash table built at compile time") {
+
+    WHEN("using it at runtime") {
+
+      THEN("the pairs should be found") {
+        CHECK(kStatusCodes.Search(200).value() == "OK");
+        CHECK(kStatusCodes.size() == 3);
+        CHECK(kSquares.Search(100).value() == 10'000);
+      }
+    }
+  }
+
+  AND_GIVEN("full fixed hash table") {
+    FixedHashTable<std::string_view, int, 3> table{{"a", 1}, {"b", 2}, {"c", 3}};
+
+    WHEN("putting a new key") {
+
+      THEN("an exception must be thrown") {
+        REQUIRE_THROWS_AS(table.Put("d", 4), std::length_error);
+      }
+    }
+
+    AND_WHEN("removing a key and putting a new one") {
+      auto removed = table.Remove("b");
+      table.Put("d", 4);
+      table.Put("a", 10);
+
+      THEN("the table should reuse the freed slot") {
+        CHECK(removed.value() == 2);
+        CHECK(table.size() == 3);
+        CHECK(table.Search("d").value() == 4);
+        CHECK(table.Search("a").value() == 10);
+        CHECK_FALSE(table.ContainsKey("b"));
+      }
+    }
+  }
+}
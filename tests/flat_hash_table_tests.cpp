@@ -0,0 +1,83 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>  // transform
+#include <numeric>    // iota
+#include <string>     // to_string
+
+#include "flat_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+using Catch::Equals;
+
+SCENARIO("flat hash table put, search and remove") {
+
+  GIVEN("empty flat hash table") {
+    const int capacity = GENERATE(range(1, 10));
+    auto hash_table = FlatHashTable(capacity, 0.75);
+
+    REQUIRE(hash_table.empty());
+    REQUIRE(hash_table.capacity() == capacity);
+
+    auto keys = std::vector<int>(capacity * 4);
+    auto values = std::vector<std::string>();
+
+    std::iota(std::begin(keys), std::end(keys), -capacity);  // including negative keys
+    values.reserve(keys.size());
+
+    std::transform(keys.cbegin(), keys.cend(), std::back_inserter(values), [](int key) { return std::to_string(key); });
+
+    for (int index = 0; index < static_cast<int>(keys.size()); index++) {
+      hash_table.Put(keys[index], values[index]);
+    }
+
+    WHEN("putting elements exceeding loading factor") {
+
+      THEN("hash table should grow and keep all the pairs") {
+        CHECK(hash_table.size() == static_cast<int>(keys.size()));
+        CHECK(hash_table.capacity() > static_cast<int>(keys.size()));
+
+        for (int index = 0; index < static_cast<int>(keys.size()); index++) {
+          REQUIRE(hash_table.Search(keys[index]));
+          CHECK(hash_table.Search(keys[index]).value() == values[index]);
+        }
+      }
+    }
+
+    AND_WHEN("putting an existing key with a different value") {
+      hash_table.Put(keys.front(), "reference");
+
+      THEN("value should change") {
+        CHECK(hash_table.size() == static_cast<int>(keys.size()));
+        CHECK(hash_table.Search(keys.front()).value() == "reference");
+      }
+    }
+
+    AND_WHEN("removing every other key") {
+      for (int index = 0; index < static_cast<int>(keys.size()); index += 2) {
+        auto removed = hash_table.Remove(keys[index]);
+        REQUIRE(removed.has_value());
+        CHECK(removed.value() == values[index]);
+      }
+
+      THEN("only the remaining keys should be found") {
+        for (int index = 0; index < static_cast<int>(keys.size()); index++) {
+          CHECK(hash_table.ContainsKey(keys[index]) == (index % 2 == 1));
+        }
+        CHECK(hash_table.size() == static_cast<int>(keys.size() / 2));
+        CHECK_FALSE(hash_table.Remove(keys.front()).has_value());
+      }
+
+      AND_THEN("removed keys can be put again over tombstones") {
+        for (int round = 0; round < 4; round++) {
+          for (int index = 0; index < static_cast<int>(keys.size()); index += 2) {
+            hash_table.Put(keys[index], values[index]);
+            hash_table.Remove(keys[index]);
+          }
+        }
+        CHECK(hash_table.size() == static_cast<int>(keys.size() / 2));
+        CHECK(hash_table.keys().size() == keys.size() / 2);
+      }
+    }
+  }
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <sstream>
+#include <string>  // to_string
+#include <utility>  // pair
+#include <vector>
+
+#include "frozen_hash_table.hpp"
+#include "hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  template <typename T>
+  void write_vector(std::ostream &output, const std::vector<T> &values) {
+    const auto size = static_cast<std::uint64_t>(values.size());
+    output.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    output.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+  }
+
+  // stream in the format of FrozenHashTable::Save with two buckets whose pilots are in the side table
+  std::string make_stream(const std::vector<std::pair<std::uint32_t, std::uint32_t>> &large_pilots) {
+    std::stringstream stream;
+    const std::uint64_t seed = 1;
+    stream.write("ITISFHT1", 8);
+    stream.write(reinterpret_cast<const char *>(&seed), sizeof(seed));
+    write_vector(stream, std::vector<std::uint8_t>{FrozenHashTable::kLargePilot, FrozenHashTable::kLargePilot});
+    write_vector(stream, large_pilots);
+    write_vector(stream, std::vector<std::uint32_t>{});
+    write_vector(stream, std::vector<int>{1, 2});
+    write_vector(stream, std::vector<std::uint64_t>{0, 0, 0});
+    write_vector(stream, std::vector<char>{});
+    return stream.str();
+  }
+
+}  // namespace
+
+SCENARIO("frozen hash table") {
+
+  GIVEN("populated hash table") {
+    const int num_keys = GENERATE(1, 2, 10, 1000, 20'000);
+    auto hash_table = HashTable(16);
+    for (int index = 0; index < num_keys; index++) {
+      hash_table.Put(index * 37 - 5000, std::to_string(index));
+    }
+
+    WHEN("freezing it") {
+      const auto frozen = hash_table.Freeze();
+
+      THEN("every key should be found with its value and absent keys should not") {
+        CHECK(frozen.size() == num_keys);
+        for (int index = 0; index < num_keys; index++) {
+          REQUIRE(frozen.Search(index * 37 - 5000).value() == std::to_string(index));
+          CHECK_FALSE(frozen.ContainsKey(index * 37 - 4999));
+        }
+        CHECK(frozen.keys() == hash_table.keys());
+      }
+
+      AND_THEN("the perfect hash function should be compact") {
+        if (num_keys >= 1000) {
+          CHECK(frozen.bits_per_key() < 3.5);
+        }
+      }
+
+      AND_WHEN("saving and loading it") {
+        std::stringstream stream;
+        frozen.Save(stream);
+        const auto loaded = FrozenHashTable::Load(stream);
+
+        THEN("the loaded table should be the same") {
+          CHECK(loaded.size() == num_keys);
+          for (int index = 0; index < num_keys; index++) {
+            REQUIRE(loaded.Search(index * 37 - 5000).value() == std::to_string(index));
+          }
+        }
+      }
+    }
+  }
+
+  AND_GIVEN("an empty hash table") {
+    const auto frozen = HashTable(4).Freeze();
+
+    THEN("the frozen table should be empty") {
+      CHECK(frozen.empty());
+      CHECK_FALSE(frozen.Search(0).has_value());
+    }
+  }
+
+  AND_GIVEN("pairs with a duplicate key") {
+    const std::vector<std::pair<int, std::string>> pairs = {{1, "a"}, {2, "b"}, {3, "c"}, {1, "d"}};
+
+    THEN("building a frozen table should throw") {
+      REQUIRE_THROWS_AS(FrozenHashTable(pairs), std::logic_error);
+    }
+  }
+
+  AND_GIVEN("a stream whose side table of large pilots does not match the marked buckets") {
+    const auto large_pilots = GENERATE(std::vector<std::pair<std::uint32_t, std::uint32_t>>{{0, 7}, {0, 8}},
+                                       std::vector<std::pair<std::uint32_t, std::uint32_t>>{{1, 7}, {0, 8}},
+                                       std::vector<std::pair<std::uint32_t, std::uint32_t>>{{0, 7}});
+
+    THEN("loading it should throw") {
+      std::stringstream stream(make_stream(large_pilots));
+      REQUIRE_THROWS_AS(FrozenHashTable::Load(stream), std::runtime_error);
+
+      std::stringstream valid(make_stream({{0, 7}, {1, 8}}));
+      CHECK(FrozenHashTable::Load(valid).size() == 2);
+    }
+  }
+
+  AND_GIVEN("a stream that does not contain a frozen table") {
+    std::stringstream stream("definitely not a table");
+
+    THEN("loading it should throw") {
+      REQUIRE_THROWS_AS(FrozenHashTable::Load(stream), std::runtime_error);
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>  // sort
+#include <mutex>
+#include <stdexcept>
+#include <string>  // to_string
+#include <tuple>
+#include <utility>  // pair
+#include <vector>
+
+#include "hash_join.hpp"
+#include "test_data.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  using Match = std::tuple<std::size_t, int, std::string>;  // probe index, key, payload
+
+  std::vector<std::pair<int, std::string>> make_relation(int num_rows, int num_keys) {
+    const auto keys = test_data::scattered_keys(num_rows, num_keys, -num_keys / 3, 4099);
+    std::vector<std::pair<int, std::string>> relation;
+    for (int row = 0; row < num_rows; row++) {
+      relation.emplace_back(keys[row], "row " + std::to_string(row));
+    }
+    return relation;
+  }
+
+  // nested-loop join in the order of the probe keys, then of the build rows
+  std::vector<Match> expected_matches(const std::vector<std::pair<int, std::string>> &relation,
+                                      const std::vector<int> &keys) {
+    std::vector<Match> matches;
+    for (std::size_t index = 0; index < keys.size(); index++) {
+      for (const auto &[key, payload] : relation) {
+        if (key == keys[index]) {
+          matches.emplace_back(index, key, payload);
+        }
+      }
+    }
+    return matches;
+  }
+
+}  // namespace
+
+SCENARIO("hash join of two relations") {
+
+  GIVEN("build relation with duplicate keys") {
+    const auto relation = make_relation(3000, 500);
+    const auto keys = test_data::scattered_keys(2000, 1000, -500, 104729);
+    const auto expected = expected_matches(relation, keys);
+    REQUIRE_FALSE(expected.empty());
+
+    const int radix_bits = GENERATE(as<int>{}, HashJoin::kAutoRadixBits, 0, 4);
+    const auto join = HashJoin(relation, 2, radix_bits);
+    CHECK(join.size() == 3000);
+
+    WHEN("it is probed") {
+      std::vector<Match> matches;
+      std::size_t max_batch = 0;
+      const auto count = join.Probe(
+          keys,
+          [&](const std::vector<JoinMatch> &batch) {
+            max_batch = std::max(max_batch, batch.size());
+            for (const auto &match : batch) {
+              matches.emplace_back(match.probe_index, match.key, std::string(match.payload));
+            }
+          },
+          100);
+
+      THEN("every matching pair should be emitted in order, in batches of at most the batch size") {
+        CHECK(count == expected.size());
+        CHECK(matches == expected);
+        CHECK(max_batch == 100);
+      }
+    }
+
+    WHEN("it is probed by several threads") {
+      std::mutex mutex;
+      std::vector<std::vector<Match>> per_thread(4);
+      const auto count = join.ProbeParallel(
+          keys,
+          [&](int thread, const std::vector<JoinMatch> &batch) {
+            std::lock_guard lock(mutex);
+            for (const auto &match : batch) {
+              per_thread.at(thread).emplace_back(match.probe_index, match.key, std::string(match.payload));
+            }
+          },
+          4, 64);
+
+      THEN("the threads together should emit every matching pair once") {
+        std::vector<Match> matches;
+        for (const auto &thread_matches : per_thread) {
+          CHECK(std::is_sorted(thread_matches.begin(), thread_matches.end(),
+                               [](const Match &left, const Match &right) {
+                                 return std::get<0>(left) < std::get<0>(right);
+                               }));
+          matches.insert(matches.end(), thread_matches.begin(), thread_matches.end());
+        }
+        std::sort(matches.begin(), matches.end());
+        auto sorted_expected = expected;
+        std::sort(sorted_expected.begin(), sorted_expected.end());
+
+        CHECK(count == expected.size());
+        CHECK(matches == sorted_expected);
+      }
+    }
+
+    WHEN("the callback of a probing thread throws") {
+      const auto probe = [&] {
+        join.ProbeParallel(
+            keys,
+            [](int thread, const std::vector<JoinMatch> &) {
+              if (thread == 1) {
+                throw std::runtime_error("emit failed");
+              }
+            },
+            4, 64);
+      };
+
+      THEN("the exception should be rethrown on the calling thread") {
+        CHECK_THROWS_WITH(probe(), "emit failed");
+      }
+    }
+  }
+
+  GIVEN("large build relation") {
+    const auto join = HashJoin(make_relation(200000, 200000), 0);
+
+    THEN("it should be split into partitions fitting the target size") {
+      CHECK(join.num_partitions() == (1 << join.radix_bits()));
+      CHECK(join.num_partitions() > 1);
+    }
+  }
+
+  GIVEN("empty build relation") {
+    const auto join = HashJoin({});
+
+    THEN("nothing should match") {
+      int num_batches = 0;
+      CHECK(join.Probe({1, 2, 3}, [&](const std::vector<JoinMatch> &) { num_batches++; }) == 0);
+      CHECK(num_batches == 0);
+      CHECK(join.ProbeParallel({}, [&](int, const std::vector<JoinMatch> &) { num_batches++; }) == 0);
+    }
+  }
+
+  GIVEN("invalid parameters") {
+    CHECK_THROWS_AS(HashJoin({}, 1, HashJoin::kMaxRadixBits + 1), std::logic_error);
+    CHECK_THROWS_AS(HashJoin({}, 1, -2), std::logic_error);
+    CHECK_THROWS_AS(HashJoin({}).Probe({1}, [](const std::vector<JoinMatch> &) {}, 0), std::logic_error);
+  }
+}
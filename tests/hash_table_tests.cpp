@@ -0,0 +1,278 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+#include <vector>
+
+#include "hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("hash table with long collision chains") {
+
+  GIVEN("hash table with keys colliding into a single bucket") {
+    const int num_keys = GENERATE(1, 7, 8, 9, 17, 40);
+    auto hash_table = HashTable(64, 1);
+
+    // multiples of 2^20 share bucket 0 while the capacity stays below 2^20
+    auto keys = std::vector<int>();
+    for (int index = 0; index < num_keys; index++) {
+      keys.push_back(index << 20);
+      hash_table.Put(keys.back(), std::to_string(index));
+    }
+
+    REQUIRE(hash_table.size() == num_keys);
+
+    WHEN("searching for every key") {
+
+      THEN("all of them should be found across the chain blocks") {
+        for (int index = 0; index < num_keys; index++) {
+          REQUIRE(hash_table.Search(keys[index]));
+          CHECK(hash_table.Search(keys[index]).value() == std::to_string(index));
+        }
+        CHECK_FALSE(hash_table.ContainsKey(num_keys << 20));
+      }
+    }
+
+    AND_WHEN("removing keys from the middle of the chain") {
+      for (int index = 0; index < num_keys; index += 3) {
+        auto removed = hash_table.Remove(keys[index]);
+        REQUIRE(removed.has_value());
+        CHECK(removed.value() == std::to_string(index));
+      }
+
+      THEN("the remaining keys should still be found") {
+        for (int index = 0; index < num_keys; index++) {
+          CHECK(hash_table.ContainsKey(keys[index]) == (index % 3 != 0));
+        }
+        CHECK(static_cast<int>(hash_table.values().size()) == hash_table.size());
+      }
+    }
+  }
+}
+
+SCENARIO("hash table with hot-key cache") {
+
+  GIVEN("hash table with the hot-key cache enabled") {
+    auto hash_table = HashTable(16);
+    hash_table.EnableHotKeyCache(64);
+
+    for (int key = 0; key < 100; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    WHEN("searching for the same key repeatedly") {
+      for (int round = 0; round < 10; round++) {
+        REQUIRE(hash_table.Search(42).value() == "42");
+      }
+
+      THEN("all the lookups but the first one should hit the cache") {
+        CHECK(hash_table.hot_key_cache_stats().misses == 1);
+        CHECK(hash_table.hot_key_cache_stats().hits == 9);
+        CHECK(hash_table.hot_key_cache_stats().hit_rate() == Approx(0.9));
+      }
+    }
+
+    AND_WHEN("searching through a const reference") {
+      const auto &readonly = hash_table;
+      for (int round = 0; round < 10; round++) {
+        REQUIRE(readonly.Search(42).value() == "42");
+      }
+
+      THEN("the cache should be bypassed") {
+        CHECK(hash_table.hot_key_cache_stats().hits == 0);
+        CHECK(hash_table.hot_key_cache_stats().misses == 0);
+      }
+    }
+
+    AND_WHEN("updating, removing and growing after the key has been cached") {
+      REQUIRE(hash_table.Search(7).value() == "7");
+
+      hash_table.Put(7, "seven");
+      CHECK(hash_table.Search(7).value() == "seven");
+
+      hash_table.Remove(7);
+      CHECK_FALSE(hash_table.Search(7).has_value());
+
+      for (int key = 100; key < 1000; key++) {
+        hash_table.Put(key, std::to_string(key));
+      }
+
+      THEN("the cache should never return stale values") {
+        for (int key = 0; key < 1000; key++) {
+          CHECK(hash_table.Search(key) == (key == 7 ? std::nullopt : std::optional<std::string>(std::to_string(key))));
+        }
+      }
+    }
+
+    AND_WHEN("searching for keys that differ in their high bits only") {
+      for (int index = 0; index < 8; index++) {
+        hash_table.Put(index << 20, std::to_string(index));
+      }
+      for (int round = 0; round < 2; round++) {
+        for (int index = 0; index < 8; index++) {
+          REQUIRE(hash_table.Search(index << 20).value() == std::to_string(index));
+        }
+      }
+
+      THEN("the keys should be cached in different slots") {
+        CHECK(hash_table.hot_key_cache_stats().misses == 8);
+        CHECK(hash_table.hot_key_cache_stats().hits == 8);
+      }
+    }
+
+    AND_WHEN("disabling the cache") {
+      hash_table.Search(1);
+      hash_table.DisableHotKeyCache();
+      hash_table.Search(1);
+
+      THEN("the counters should be reset") {
+        CHECK(hash_table.hot_key_cache_stats().hits == 0);
+        CHECK(hash_table.hot_key_cache_stats().misses == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("hash table with self-organizing chains") {
+
+  GIVEN("hash table with a single long chain") {
+    const auto ordering = GENERATE(HashTable::ChainOrdering::kMoveToFront, HashTable::ChainOrdering::kTranspose);
+    auto hash_table = HashTable(64, 1);
+    hash_table.set_chain_ordering(ordering);
+
+    const int num_keys = 20;
+    for (int index = 0; index < num_keys; index++) {
+      hash_table.Put(index << 20, std::to_string(index));
+    }
+
+    const int hot_key = (num_keys - 1) << 20;
+    REQUIRE(hash_table.ChainPosition(hot_key) == num_keys - 1);
+
+    WHEN("searching for the last key of the chain repeatedly") {
+      for (int round = 0; round < num_keys; round++) {
+        REQUIRE(hash_table.Search(hot_key).value() == std::to_string(num_keys - 1));
+      }
+
+      THEN("the key should move to the head of the chain") {
+        CHECK(hash_table.ChainPosition(hot_key) == 0);
+      }
+
+      AND_THEN("all the other keys should still be found") {
+        for (int index = 0; index < num_keys; index++) {
+          CHECK(hash_table.Search(index << 20).value() == std::to_string(index));
+        }
+        CHECK(hash_table.size() == num_keys);
+      }
+    }
+
+    WHEN("searching for the last key of the chain through a const reference") {
+      const auto &readonly = hash_table;
+      for (int round = 0; round < num_keys; round++) {
+        REQUIRE(readonly.Search(hot_key).value() == std::to_string(num_keys - 1));
+        REQUIRE(readonly.ContainsKey(hot_key));
+      }
+      REQUIRE(readonly.SearchBatch({hot_key, hot_key}).front().value() == std::to_string(num_keys - 1));
+
+      THEN("the chain should not be reordered") {
+        CHECK(hash_table.ChainPosition(hot_key) == num_keys - 1);
+      }
+    }
+  }
+}
+
+SCENARIO("hash table snapshots") {
+
+  GIVEN("hash table with a snapshot of its pairs") {
+    auto hash_table = HashTable(16);
+    for (int key = 0; key < 200; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    const auto snapshot = hash_table.Snapshot();
+    REQUIRE(snapshot.size() == 200);
+
+    WHEN("updating, removing and growing the table after the snapshot") {
+      for (int key = 0; key < 200; key += 2) {
+        hash_table.Put(key, "updated");
+      }
+      for (int key = 1; key < 200; key += 2) {
+        hash_table.Remove(key);
+      }
+      for (int key = 200; key < 2000; key++) {
+        hash_table.Put(key, std::to_string(key));
+      }
+
+      THEN("the snapshot should keep the pairs as of the moment it was taken") {
+        CHECK(snapshot.size() == 200);
+        CHECK(snapshot.keys().size() == 200);
+        for (int key = 0; key < 200; key++) {
+          REQUIRE(snapshot.Search(key));
+          CHECK(snapshot.Search(key).value() == std::to_string(key));
+        }
+        CHECK_FALSE(snapshot.ContainsKey(200));
+      }
+
+      AND_THEN("the table should see its own changes") {
+        CHECK(hash_table.size() == 1900);
+        CHECK(hash_table.Search(0).value() == "updated");
+        CHECK_FALSE(hash_table.ContainsKey(1));
+        CHECK(hash_table.Search(1999).value() == "1999");
+      }
+    }
+
+    AND_WHEN("taking several snapshots between the changes") {
+      hash_table.Put(0, "first");
+      const auto first = hash_table.Snapshot();
+      hash_table.Put(0, "second");
+      hash_table.Remove(1);
+      const auto second = hash_table.Snapshot();
+      hash_table.Put(0, "third");
+
+      THEN("every snapshot should see only the changes made before it") {
+        CHECK(snapshot.Search(0).value() == "0");
+        CHECK(first.Search(0).value() == "first");
+        CHECK(second.Search(0).value() == "second");
+        CHECK(hash_table.Search(0).value() == "third");
+
+        CHECK(first.ContainsKey(1));
+        CHECK_FALSE(second.ContainsKey(1));
+        CHECK(second.values().size() == 199);
+      }
+    }
+  }
+}
+
+SCENARIO("hash table batched search") {
+
+  GIVEN("hash table with many keys") {
+    const auto ordering = GENERATE(HashTable::ChainOrdering::kInsertion, HashTable::ChainOrdering::kMoveToFront);
+    auto hash_table = HashTable(16);
+    hash_table.set_chain_ordering(ordering);
+    for (int key = 0; key < 1000; key += 2) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    WHEN("searching for a batch of present, absent and repeated keys") {
+      std::vector<int> keys;
+      for (int key = -10; key < 1010; key++) {
+        keys.push_back(key);
+        keys.push_back(998 - key);
+      }
+      const auto values = hash_table.SearchBatch(keys);
+
+      THEN("every key should get the same answer as Search") {
+        REQUIRE(values.size() == keys.size());
+        for (std::size_t index = 0; index < keys.size(); index++) {
+          REQUIRE(values[index] == hash_table.Search(keys[index]));
+        }
+      }
+    }
+
+    AND_WHEN("searching for an empty batch") {
+      THEN("nothing should be found") {
+        CHECK(hash_table.SearchBatch({}).empty());
+      }
+    }
+  }
+}
@@ -0,0 +1,116 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "kv_server.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  int connect_to(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    return fd;
+  }
+
+  // read until the response ends with the terminator
+  std::string request(int fd, const std::string &data, const std::string &terminator) {
+    REQUIRE(send(fd, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size()));
+
+    std::string response;
+    char chunk[4096];
+    while (response.size() < terminator.size()
+           || response.compare(response.size() - terminator.size(), terminator.size(), terminator) != 0) {
+      const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+      REQUIRE(received > 0);
+      response.append(chunk, static_cast<size_t>(received));
+    }
+    return response;
+  }
+
+}  // namespace
+
+SCENARIO("memcached-protocol server") {
+
+  GIVEN("server running on a free port") {
+    const auto backend = GENERATE(KvServer::Backend::kEpoll, KvServer::Backend::kAuto);
+    auto table = HashTable(16);
+    auto server = KvServer(table, 0, backend);
+    REQUIRE(server.port() > 0);
+    REQUIRE(server.backend() != KvServer::Backend::kAuto);
+
+    auto loop = std::thread([&server] { server.Run(); });
+
+    WHEN("two clients talk to the server") {
+      const int first = connect_to(server.port());
+      const int second = connect_to(server.port());
+
+      const auto stored = request(first, "set 1 0 0 5\r\nhello\r\n", "\r\n");
+      const auto found = request(second, "get 1 2\r\n", "END\r\n");
+      const auto large = request(first, "set 2 0 0 100000\r\n" + std::string(100000, 'v') + "\r\n", "\r\n");
+      const auto multi = request(second, "get 2 1\r\n", "END\r\n");
+
+      const auto quit_response = request(first, "get 1\r\nquit\r\n", "END\r\n");
+      char byte = 0;
+      const auto after_quit = recv(first, &byte, 1, 0);
+
+      close(first);
+      close(second);
+
+      THEN("they should see each other's updates") {
+        CHECK(stored == "STORED\r\n");
+        CHECK(found == "VALUE 1 0 5\r\nhello\r\nEND\r\n");
+        CHECK(large == "STORED\r\n");
+        CHECK(quit_response == "VALUE 1 0 5\r\nhello\r\nEND\r\n");
+        CHECK(after_quit == 0);
+        CHECK(multi == "VALUE 2 0 100000\r\n" + std::string(100000, 'v') + "\r\nVALUE 1 0 5\r\nhello\r\nEND\r\n");
+      }
+    }
+
+    AND_WHEN("a client pipelines more responses than the server buffers before reading them") {
+      const int fd = connect_to(server.port());
+      const std::string value(1000000, 'v');
+      const auto stored = request(fd, "set 1 0 0 1000000\r\n" + value + "\r\n", "\r\n");
+
+      const std::string response = "VALUE 1 0 1000000\r\n" + value + "\r\nEND\r\n";
+      constexpr int kNumGets = 10;
+      std::string gets;
+      for (int index = 0; index < kNumGets; index++) {
+        gets += "get 1\r\n";
+      }
+      REQUIRE(send(fd, gets.data(), gets.size(), 0) == static_cast<ssize_t>(gets.size()));
+
+      // the gets held back by the output limit must be served without the client sending more
+      std::string responses;
+      char chunk[65536];
+      while (responses.size() < response.size() * kNumGets) {
+        const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        REQUIRE(received > 0);
+        responses.append(chunk, static_cast<size_t>(received));
+      }
+      close(fd);
+
+      THEN("every get should be answered in order") {
+        CHECK(stored == "STORED\r\n");
+        CHECK(responses.size() == response.size() * kNumGets);
+        CHECK(responses.compare(0, response.size(), response) == 0);
+        CHECK(responses.compare(responses.size() - response.size(), response.size(), response) == 0);
+      }
+    }
+
+    server.Stop();
+    loop.join();
+  }
+}
@@ -0,0 +1,87 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+
+#include "lru_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+using Catch::Equals;
+
+SCENARIO("lru hash table eviction") {
+
+  GIVEN("full lru hash table bounded by the number of keys") {
+    const int max_keys = GENERATE(1, 3, 10);
+    auto hash_table = LruHashTable(max_keys);
+
+    for (int key = 0; key < max_keys; key++) {
+      hash_table.Put(key, std::to_string(key));
+    }
+
+    REQUIRE(hash_table.size() == max_keys);
+    REQUIRE(hash_table.evictions() == 0);
+
+    WHEN("searching for the oldest key and putting a new one") {
+      REQUIRE(hash_table.Search(0).value() == "0");
+      hash_table.Put(max_keys, "new");
+
+      THEN("the least recently used key should be evicted") {
+        CHECK(hash_table.size() == max_keys);
+        CHECK(hash_table.evictions() == 1);
+        CHECK(hash_table.ContainsKey(max_keys));
+        CHECK(hash_table.ContainsKey(0) == (max_keys > 1));
+        if (max_keys > 1) {
+          CHECK_FALSE(hash_table.ContainsKey(1));
+        }
+      }
+    }
+
+    AND_WHEN("updating an existing key") {
+      hash_table.Put(0, "updated");
+
+      THEN("nothing should be evicted and the key becomes the most recently used") {
+        CHECK(hash_table.evictions() == 0);
+        CHECK(hash_table.values().front() == "updated");
+      }
+    }
+
+    AND_WHEN("removing a key") {
+      auto removed = hash_table.Remove(max_keys - 1);
+
+      THEN("a new key fits without eviction") {
+        CHECK(removed.value() == std::to_string(max_keys - 1));
+        hash_table.Put(-1, "negative");
+        CHECK(hash_table.evictions() == 0);
+        CHECK(hash_table.Search(-1).value() == "negative");
+      }
+    }
+  }
+
+  AND_GIVEN("lru hash table bounded by the size of the values") {
+    auto hash_table = LruHashTable(100, 10);
+
+    hash_table.Put(1, "aaaa");
+    hash_table.Put(2, "bbbb");
+    hash_table.Put(3, "cc");
+
+    REQUIRE(hash_table.bytes() == 10);
+
+    WHEN("putting a value that does not fit") {
+      hash_table.Put(4, "ddd");
+
+      THEN("the oldest values should be evicted until it fits") {
+        CHECK(hash_table.bytes() == 9);
+        CHECK_THAT(hash_table.values(), Equals(std::vector<std::string>{"ddd", "cc", "bbbb"}));
+        CHECK(hash_table.evictions() == 1);
+      }
+    }
+
+    AND_WHEN("putting a value larger than the limit") {
+
+      THEN("an exception must be thrown") {
+        REQUIRE_THROWS_AS(hash_table.Put(5, std::string(11, 'x')), std::logic_error);
+        CHECK(hash_table.size() == 3);
+      }
+    }
+  }
+}
@@ -0,0 +1,191 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>  // min
+#include <limits>
+#include <string>
+
+#include <sys/uio.h>
+
+#include "memcached_protocol.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  std::string process(HashTable &table, std::string &input, bool &is_closing,
+                      std::size_t max_output = std::numeric_limits<std::size_t>::max()) {
+    memcached::Output output;
+    const auto consumed = memcached::Process(input, table, output, max_output, is_closing);
+    input.erase(0, consumed);
+    return output.str();
+  }
+
+}  // namespace
+
+SCENARIO("memcached text protocol") {
+
+  GIVEN("hash table served over the protocol") {
+    auto table = HashTable(16);
+    bool is_closing = false;
+
+    WHEN("setting, getting and deleting keys") {
+      std::string input = "set 1 0 0 3\r\none\r\nset -2 5 0 0\r\n\r\nget 1 2 -2\r\ndelete 1\r\ndelete 1\r\nget 1\r\n";
+      const auto output = process(table, input, is_closing);
+
+      THEN("every request should get its response") {
+        CHECK(output
+              == "STORED\r\nSTORED\r\n"
+                 "VALUE 1 0 3\r\none\r\nVALUE -2 0 0\r\n\r\nEND\r\n"
+                 "DELETED\r\nNOT_FOUND\r\nEND\r\n");
+        CHECK(input.empty());
+        CHECK_FALSE(is_closing);
+        CHECK(table.size() == 1);
+      }
+    }
+
+    AND_WHEN("a request arrives in pieces") {
+      std::string input = "set 7 0 0 5\r\nsev";
+      const auto first = process(table, input, is_closing);
+      input += "en\r\nget";
+      const auto second = process(table, input, is_closing);
+      input += " 7\r\n";
+      const auto third = process(table, input, is_closing);
+
+      THEN("it should be served once it is complete") {
+        CHECK(first.empty());
+        CHECK(second == "STORED\r\n");
+        CHECK(third == "VALUE 7 0 5\r\nseven\r\nEND\r\n");
+      }
+    }
+
+    AND_WHEN("sending noreply and malformed requests") {
+      std::string input = "set 1 0 0 1 noreply\r\nx\r\nflush_all\r\nget key\r\nversion\r\nget 1\r\n";
+      const auto output = process(table, input, is_closing);
+
+      THEN("errors should be reported without breaking the stream") {
+        CHECK(output
+              == "ERROR\r\nCLIENT_ERROR bad key format\r\nVERSION itis-hash-table 1.0\r\n"
+                 "VALUE 1 0 1\r\nx\r\nEND\r\n");
+        CHECK_FALSE(is_closing);
+      }
+    }
+
+    AND_WHEN("the data block does not match its length") {
+      std::string input = "set 1 0 0 2\r\nabc\r\nget 1\r\n";
+      const auto output = process(table, input, is_closing);
+
+      THEN("the connection should be closed") {
+        CHECK(output == "CLIENT_ERROR bad data chunk\r\n");
+        CHECK(is_closing);
+        CHECK(table.empty());
+      }
+    }
+
+    AND_WHEN("pipelining gets around the updates of their keys") {
+      std::string input =
+          "set 1 0 0 1\r\na\r\nget 1\r\nget 1 2\r\nset 2 0 0 1\r\nb\r\nget 2\r\ndelete 1\r\nget 1 2\r\n";
+      const auto output = process(table, input, is_closing);
+
+      THEN("every get should see exactly the updates before it") {
+        CHECK(output
+              == "STORED\r\nVALUE 1 0 1\r\na\r\nEND\r\nVALUE 1 0 1\r\na\r\nEND\r\n"
+                 "STORED\r\nVALUE 2 0 1\r\nb\r\nEND\r\nDELETED\r\nVALUE 2 0 1\r\nb\r\nEND\r\n");
+      }
+    }
+
+    AND_WHEN("quitting") {
+      std::string input = "quit\r\nget 1\r\n";
+      const auto output = process(table, input, is_closing);
+
+      THEN("the following requests should not be served") {
+        CHECK(output.empty());
+        CHECK(is_closing);
+      }
+    }
+
+    AND_WHEN("the responses reach the output limit") {
+      std::string input = "set 1 0 0 8\r\n12345678\r\nget 1\r\nset 2 0 0 1\r\nb\r\nget 2\r\n";
+      const auto output = process(table, input, is_closing, 20);
+
+      THEN("the following requests should stay in the input") {
+        CHECK(output == "STORED\r\nVALUE 1 0 8\r\n12345678\r\nEND\r\n");
+        CHECK(input == "set 2 0 0 1\r\nb\r\nget 2\r\n");
+        CHECK_FALSE(is_closing);
+        CHECK_FALSE(table.ContainsKey(2));
+      }
+    }
+
+    AND_WHEN("a run of gets reaches the output limit") {
+      std::string input = "set 1 0 0 8\r\n12345678\r\nget 1\r\nget 1\r\nget 2\r\n";
+      const auto output = process(table, input, is_closing, 20);
+
+      THEN("the gets after the limit should stay in the input") {
+        CHECK(output == "STORED\r\nVALUE 1 0 8\r\n12345678\r\nEND\r\n");
+        CHECK(input == "get 1\r\nget 2\r\n");
+      }
+    }
+
+    AND_WHEN("pipelining more get keys than one batch looks up") {
+      std::string input;
+      std::string expected;
+      for (int key = 0; key < 1000; key++) {
+        input += "get " + std::to_string(key % 2) + "\r\n";
+        expected += key % 2 == 0 ? "END\r\n" : "VALUE 1 0 0\r\n\r\nEND\r\n";
+      }
+      table.Put(1, "");
+      const auto output = process(table, input, is_closing);
+
+      THEN("every get should be served") {
+        CHECK(output == expected);
+        CHECK(input.empty());
+      }
+    }
+  }
+}
+
+SCENARIO("memcached response output") {
+
+  GIVEN("output with short texts and a long value") {
+    memcached::Output output;
+    const std::string value(memcached::Output::kMinMovedValueBytes * 4, 'v');
+    output.Append("VALUE 1 0 2048\r\n");
+    output.AppendValue(std::string(value));
+    output.Append("\r\n");
+    output.Append("END\r\n");
+
+    const std::string expected = "VALUE 1 0 2048\r\n" + value + "\r\nEND\r\n";
+    REQUIRE(output.size() == expected.size());
+
+    WHEN("gathering it for a vectored write") {
+      iovec vectors[8];
+      const int count = output.Gather(vectors, 8);
+
+      THEN("the long value should be a separate piece and adjacent texts should be merged") {
+        REQUIRE(count == 3);
+        CHECK(vectors[1].iov_len == value.size());
+        CHECK(vectors[2].iov_len == 7);
+        CHECK(output.str() == expected);
+      }
+    }
+
+    AND_WHEN("it is sent in pieces") {
+      std::string sent;
+      while (!output.empty()) {
+        iovec vectors[2];
+        const int count = output.Gather(vectors, 2);
+        REQUIRE(count > 0);
+        // a short write that ends in the middle of a piece
+        const std::size_t bytes = std::min<std::size_t>(vectors[0].iov_len, 1000);
+        sent.append(static_cast<const char *>(vectors[0].iov_base), bytes);
+        output.Consume(bytes);
+      }
+
+      THEN("the bytes should come out in order") {
+        CHECK(sent == expected);
+        CHECK(output.size() == 0);
+        CHECK(output.str().empty());
+      }
+    }
+  }
+}
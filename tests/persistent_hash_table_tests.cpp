@@ -0,0 +1,92 @@
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <random>
+#include <string>  // to_string
+#include <vector>
+
+#include "persistent_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("persistent hash table versions") {
+
+  GIVEN("version with a few thousand keys") {
+    auto version = PersistentHashTable();
+    for (int key = -1000; key < 3000; key++) {
+      version = version.Put(key, std::to_string(key));
+    }
+
+    REQUIRE(version.size() == 4000);
+
+    WHEN("putting and removing keys in new versions") {
+      const auto updated = version.Put(0, "zero").Put(5000, "5000");
+      const auto removed = updated.Remove(1).Remove(-1000).Remove(123456);
+
+      THEN("every version should keep its own pairs") {
+        CHECK(version.size() == 4000);
+        CHECK(version.Search(0).value() == "0");
+        CHECK_FALSE(version.ContainsKey(5000));
+
+        CHECK(updated.size() == 4001);
+        CHECK(updated.Search(0).value() == "zero");
+        CHECK(updated.Search(5000).value() == "5000");
+
+        CHECK(removed.size() == 3999);
+        CHECK_FALSE(removed.ContainsKey(1));
+        CHECK_FALSE(removed.ContainsKey(-1000));
+        CHECK(updated.ContainsKey(1));
+        CHECK(version.ContainsKey(-1000));
+      }
+    }
+
+    AND_WHEN("removing every key") {
+      auto empty = version;
+      for (int key = -1000; key < 3000; key++) {
+        empty = empty.Remove(key);
+      }
+
+      THEN("the new version should be empty while the old one is intact") {
+        CHECK(empty.empty());
+        CHECK(empty.keys().empty());
+        CHECK(version.keys().size() == 4000);
+        CHECK(version.values().size() == 4000);
+      }
+    }
+  }
+
+  GIVEN("random operations mirrored in a reference map") {
+    std::mt19937 engine(38);
+    std::uniform_int_distribution<int> key_distribution(-500, 500);
+
+    auto versions = std::vector<PersistentHashTable>{PersistentHashTable()};
+    auto references = std::vector<std::map<int, std::string>>{{}};
+
+    for (int step = 0; step < 3000; step++) {
+      const int key = key_distribution(engine);
+      auto reference = references.back();
+
+      if (step % 3 == 2) {
+        versions.push_back(versions.back().Remove(key));
+        reference.erase(key);
+      } else {
+        versions.push_back(versions.back().Put(key, std::to_string(step)));
+        reference[key] = std::to_string(step);
+      }
+      references.push_back(std::move(reference));
+    }
+
+    THEN("every historical version should match its reference") {
+      for (int version = 0; version < static_cast<int>(versions.size()); version += 97) {
+        REQUIRE(versions[version].size() == static_cast<int>(references[version].size()));
+        for (int key = -500; key <= 500; key++) {
+          const auto found = references[version].find(key);
+          const auto expected =
+              found == references[version].end() ? std::nullopt : std::optional<std::string>(found->second);
+          REQUIRE(versions[version].Search(key) == expected);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,160 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+#include <utility>  // pair
+
+#include <sys/socket.h>
+
+#include "replication.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  // connect the follower to the primary over a fresh socket pair
+  void connect(ReplicationPrimary &primary, ReplicationFollower &follower) {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    follower.Connect(fds[0]);
+    primary.AddFollower(fds[1]);
+  }
+
+  // exchange the frames until the follower has applied every mutation
+  void synchronize(ReplicationPrimary &primary, ReplicationFollower &follower) {
+    while (follower.primary_id() != primary.id() || follower.sequence() != primary.sequence()) {
+      primary.Flush();
+      REQUIRE(follower.Poll());
+    }
+  }
+
+}  // namespace
+
+SCENARIO("log-shipping replication") {
+
+  GIVEN("primary with some pairs and a new follower") {
+    auto primary = ReplicationPrimary(16, 100);
+    for (int key = 0; key < 500; key++) {
+      primary.Put(key, std::to_string(key));
+    }
+    primary.Remove(0);
+
+    auto follower = ReplicationFollower();
+    connect(primary, follower);
+    synchronize(primary, follower);
+
+    THEN("the follower should catch up from a snapshot") {
+      CHECK(follower.sequence() == 501);
+      CHECK(follower.size() == 499);
+      CHECK(follower.Search(499).value() == "499");
+      CHECK_FALSE(follower.ContainsKey(0));
+    }
+
+    WHEN("the primary keeps changing") {
+      primary.Put(1, "updated");
+      primary.Remove(2);
+      CHECK_FALSE(primary.Remove(2).has_value());  // nothing to ship
+      primary.Put(1000, std::string(100000, 'v'));
+      synchronize(primary, follower);
+
+      THEN("the follower should apply every mutation in order") {
+        CHECK(follower.sequence() == 504);
+        CHECK(follower.Search(1).value() == "updated");
+        CHECK_FALSE(follower.ContainsKey(2));
+        CHECK(follower.Search(1000).value() == std::string(100000, 'v'));
+        CHECK(follower.size() == primary.table().size());
+      }
+    }
+
+    AND_WHEN("the follower reconnects after missing a few mutations") {
+      follower.Disconnect();
+      for (int key = 0; key < 50; key++) {
+        primary.Put(key, "missed " + std::to_string(key));
+      }
+      REQUIRE(primary.num_followers() == 0);  // noticed on the first failed send
+
+      connect(primary, follower);
+      synchronize(primary, follower);
+
+      THEN("it should catch up from the log") {
+        CHECK(follower.Search(49).value() == "missed 49");
+        CHECK(follower.Search(50).value() == "50");
+        CHECK(primary.num_followers() == 1);
+      }
+    }
+
+    AND_WHEN("the follower misses more mutations than the log keeps") {
+      follower.Disconnect();
+      for (int key = 0; key < 300; key++) {
+        primary.Put(key, "missed " + std::to_string(key));
+      }
+
+      connect(primary, follower);
+      synchronize(primary, follower);
+
+      THEN("it should catch up from a new snapshot") {
+        CHECK(follower.Search(299).value() == "missed 299");
+        CHECK(follower.size() == 500);
+      }
+    }
+
+    AND_WHEN("the primary goes away") {
+      auto other = ReplicationFollower();
+      {
+        auto gone = ReplicationPrimary();
+        gone.Put(1, "one");
+        connect(gone, other);
+      }
+
+      THEN("the follower should keep serving what it has applied") {
+        CHECK_FALSE(other.Poll());
+        CHECK(other.Search(1).value() == "one");
+        CHECK(other.sequence() == 1);
+      }
+    }
+
+    AND_WHEN("the primary is restarted with another history") {
+      auto restarted = ReplicationPrimary(16, 1000);  // the log reaches back to the follower's sequence number
+      for (int key = 0; key < 600; key++) {
+        restarted.Put(-key, "restarted " + std::to_string(key));
+      }
+      REQUIRE(restarted.sequence() > follower.sequence());
+      REQUIRE(restarted.id() != primary.id());
+
+      follower.Disconnect();
+      connect(restarted, follower);
+      synchronize(restarted, follower);
+
+      THEN("the follower should start over from a snapshot instead of replaying the log on top of its table") {
+        CHECK(follower.primary_id() == restarted.id());
+        CHECK(follower.size() == 600);
+        CHECK_FALSE(follower.ContainsKey(499));
+        CHECK(follower.Search(-599).value() == "restarted 599");
+      }
+    }
+  }
+
+  GIVEN("primary with a table larger than the backlog limit") {
+    const int num_keys = 70'000;  // 1 KiB values, about 70 MiB
+    auto primary = ReplicationPrimary(1024, 100);
+    for (int key = 0; key < num_keys; key++) {
+      primary.Put(key, std::string(1024, static_cast<char>('a' + key % 26)));
+    }
+
+    WHEN("a new follower joins") {
+      auto follower = ReplicationFollower();
+      connect(primary, follower);
+      REQUIRE(primary.num_followers() == 1);
+
+      primary.Put(num_keys, "after the snapshot");
+      synchronize(primary, follower);
+
+      THEN("it should receive the whole snapshot in parts and the mutations after it") {
+        CHECK(primary.num_followers() == 1);
+        CHECK(follower.size() == num_keys + 1);
+        CHECK(follower.Search(num_keys - 1).value() == std::string(1024, static_cast<char>('a' + (num_keys - 1) % 26)));
+        CHECK(follower.Search(num_keys).value() == "after the snapshot");
+      }
+    }
+  }
+}
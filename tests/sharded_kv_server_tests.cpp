@@ -0,0 +1,161 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sharded_kv_server.hpp"
+
+using namespace std;
+using namespace itis;
+
+namespace {
+
+  int connect_to(int port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    REQUIRE(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+    return fd;
+  }
+
+  // read until the response ends with the terminator
+  std::string request(int fd, const std::string &data, const std::string &terminator) {
+    REQUIRE(send(fd, data.data(), data.size(), 0) == static_cast<ssize_t>(data.size()));
+
+    std::string response;
+    char chunk[4096];
+    while (response.size() < terminator.size()
+           || response.compare(response.size() - terminator.size(), terminator.size(), terminator) != 0) {
+      const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+      REQUIRE(received > 0);
+      response.append(chunk, static_cast<size_t>(received));
+    }
+    return response;
+  }
+
+}  // namespace
+
+SCENARIO("thread-per-core sharded server") {
+
+  GIVEN("invalid number of shards") {
+    THEN("the server should not be created") {
+      CHECK_THROWS_AS(ShardedKvServer(0, 0), std::logic_error);
+    }
+  }
+
+  GIVEN("server with four shards") {
+    constexpr int kNumShards = 4;
+    constexpr int kNumKeys = 100;
+
+    auto server = ShardedKvServer(kNumShards, 0);
+    REQUIRE(server.port() > 0);
+    server.Start();
+
+    WHEN("clients store keys of every shard") {
+      const int first = connect_to(server.port());
+      const int second = connect_to(server.port());
+
+      std::string stored;
+      for (int key = 0; key < kNumKeys; key++) {
+        stored += request(first, "set " + to_string(key) + " 0 0 1\r\n" + to_string(key % 10) + "\r\n", "\r\n");
+      }
+
+      // a pipelined batch of requests touching several shards
+      const auto pipelined = request(second, "get 3 1 2\r\ndelete 1\r\nget 1\r\ndelete 1\r\n", "NOT_FOUND\r\n");
+      const auto version = request(second, "version\r\n", "\r\n");
+
+      const auto quit_response = request(first, "get 7\r\nquit\r\n", "END\r\n");
+      char byte = 0;
+      const auto after_quit = recv(first, &byte, 1, 0);
+
+      close(first);
+      close(second);
+      server.Stop();
+
+      THEN("responses should come in the order of the requests") {
+        std::string expected_stored;
+        for (int key = 0; key < kNumKeys; key++) {
+          expected_stored += "STORED\r\n";
+        }
+        CHECK(stored == expected_stored);
+        CHECK(pipelined
+              == "VALUE 3 0 1\r\n3\r\nVALUE 1 0 1\r\n1\r\nVALUE 2 0 1\r\n2\r\nEND\r\n"
+                 "DELETED\r\nEND\r\nNOT_FOUND\r\n");
+        CHECK(version.rfind("VERSION ", 0) == 0);
+        CHECK(quit_response == "VALUE 7 0 1\r\n7\r\nEND\r\n");
+        CHECK(after_quit == 0);
+      }
+
+      THEN("keys should be spread over the shards") {
+        int num_keys = 0;
+        for (int shard = 0; shard < kNumShards; shard++) {
+          CHECK(server.shard_size(shard) > 0);
+          num_keys += server.shard_size(shard);
+        }
+        CHECK(num_keys == kNumKeys - 1);
+      }
+    }
+
+    server.Stop();
+  }
+
+  GIVEN("server with more shards than CPUs") {
+    constexpr int kNumShards = 16;
+    constexpr int kNumKeys = 5000;
+
+    auto server = ShardedKvServer(kNumShards, 0);
+    server.Start();
+
+    WHEN("a client pipelines more requests to other shards than their queues hold") {
+      const int fd = connect_to(server.port());
+
+      std::string sets;
+      std::string expected;
+      for (int key = 0; key < kNumKeys; key++) {
+        sets += "set " + to_string(key) + " 0 0 1\r\nv\r\n";
+        expected += "STORED\r\n";
+      }
+      const auto stored = request(fd, sets + "get 4999\r\n", "END\r\n");
+
+      close(fd);
+      server.Stop();
+
+      THEN("every request should be served") {
+        CHECK(stored == expected + "VALUE 4999 0 1\r\nv\r\nEND\r\n");
+
+        int num_keys = 0;
+        for (int shard = 0; shard < kNumShards; shard++) {
+          num_keys += server.shard_size(shard);
+        }
+        CHECK(num_keys == kNumKeys);
+      }
+    }
+
+    server.Stop();
+  }
+}
+
+SCENARIO("shard selection") {
+
+  GIVEN("sequential keys") {
+    THEN("every key should belong to a valid shard and the shards should be balanced") {
+      int counts[8] = {};
+      for (int key = -4000; key < 4000; key++) {
+        const int shard = ShardedKvServer::ShardOf(key, 8);
+        REQUIRE(shard >= 0);
+        REQUIRE(shard < 8);
+        counts[shard]++;
+      }
+      for (const int count : counts) {
+        CHECK(count > 800);
+        CHECK(count < 1200);
+      }
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#include <catch2/catch.hpp>
+
+#include <string>  // to_string
+
+#include <sys/wait.h>
+#include <unistd.h>  // fork, getpid
+
+#include "shared_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("hash table in shared memory") {
+
+  GIVEN("invalid arguments") {
+    THEN("the table should not be created") {
+      CHECK_THROWS_AS(SharedHashTable::Create("no_slash"), std::logic_error);
+      CHECK_THROWS_AS(SharedHashTable::Create("/itis_invalid", 1024, 0), std::logic_error);
+      CHECK_THROWS_AS(SharedHashTable::Create("/itis_invalid", 64, 1024), std::logic_error);
+      CHECK_THROWS_AS(SharedHashTable::Open("/itis_missing_" + std::to_string(getpid())), std::runtime_error);
+    }
+  }
+
+  GIVEN("table created in a new segment") {
+    const std::string name = "/itis_shared_hash_table_" + std::to_string(getpid());
+    SharedHashTable::Unlink(name);
+    auto table = SharedHashTable::Create(name, 1024 * 1024, 4);
+
+    WHEN("putting, updating and removing pairs") {
+      for (int key = -100; key < 1000; key++) {
+        table.Put(key, std::string(static_cast<std::size_t>(key + 100) % 40, 'x'));
+      }
+      for (int key = 0; key < 1000; key += 2) {
+        table.Put(key, "updated " + std::to_string(key));
+      }
+      for (int key = -100; key < 0; key++) {
+        REQUIRE(table.Remove(key) == std::string(static_cast<std::size_t>(key + 100) % 40, 'x'));
+      }
+
+      THEN("the table should hold the latest values and grow") {
+        CHECK(table.size() == 1000);
+        CHECK(table.capacity() > 1000);
+        CHECK(table.keys().size() == 1000);
+        CHECK(table.Search(2).value() == "updated 2");
+        CHECK(table.Search(3).value() == std::string(103 % 40, 'x'));
+        CHECK_FALSE(table.ContainsKey(-1));
+        CHECK_FALSE(table.Remove(-1).has_value());
+      }
+
+      AND_THEN("the freed blocks should be reused") {
+        std::size_t bytes_used = 0;
+        for (int round = 0; round < 10; round++) {
+          if (round == 1) {
+            bytes_used = table.bytes_used();
+          }
+          for (int key = 0; key < 1000; key++) {
+            table.Put(key, std::to_string(round) + std::string(20, 'y'));
+          }
+          for (int key = 0; key < 1000; key++) {
+            table.Remove(key);
+          }
+        }
+        CHECK(table.empty());
+        CHECK(table.bytes_used() <= bytes_used);
+      }
+    }
+
+    AND_WHEN("the segment runs out of space") {
+      table.Put(1, "one");
+      CHECK_THROWS_AS(table.Put(2, std::string(2 * 1024 * 1024, 'v')), std::runtime_error);
+      CHECK_THROWS_AS(table.Put(1, std::string(2 * 1024 * 1024, 'v')), std::runtime_error);
+
+      THEN("the table should be left unchanged") {
+        CHECK(table.size() == 1);
+        CHECK(table.Search(1).value() == "one");
+        CHECK_FALSE(table.ContainsKey(2));
+      }
+    }
+
+    AND_WHEN("another process opens the segment and writes to it") {
+      table.Put(1, "from parent");
+
+      const pid_t child = fork();
+      REQUIRE(child != -1);
+      if (child == 0) {
+        int status = 1;
+        try {
+          auto shared = SharedHashTable::Open(name);
+          for (int key = 100; key < 2000; key++) {
+            shared.Put(key, "from child " + std::to_string(key));
+          }
+          status = shared.Search(1) == "from parent" ? 0 : 2;
+        } catch (...) {
+        }
+        _exit(status);
+      }
+
+      int wait_status = 0;
+      waitpid(child, &wait_status, 0);
+
+      THEN("this process should see the pairs written by the other one") {
+        REQUIRE(WIFEXITED(wait_status));
+        CHECK(WEXITSTATUS(wait_status) == 0);
+        CHECK(table.size() == 1901);
+        CHECK(table.Search(1999).value() == "from child 1999");
+        CHECK(SharedHashTable::Open(name).Search(100).value() == "from child 100");
+      }
+    }
+
+    AND_WHEN("another process reads while this one writes") {
+      const std::string short_value(10, 'a');
+      const std::string long_value(1000, 'b');
+      table.Put(1, short_value);
+
+      const pid_t child = fork();
+      REQUIRE(child != -1);
+      if (child == 0) {
+        int status = 1;
+        try {
+          // lookups do not take the mutex, yet they must never see a half-written value
+          auto shared = SharedHashTable::Open(name);
+          status = 0;
+          for (int round = 0; round < 20'000 && status == 0; round++) {
+            const auto value = shared.Search(1);
+            status = value == short_value || value == long_value ? 0 : 2;
+          }
+        } catch (...) {
+        }
+        _exit(status);
+      }
+
+      for (int round = 0; round < 20'000; round++) {
+        table.Put(1, round % 2 == 0 ? long_value : short_value);
+        table.Put(round % 500 + 2, "filler");  // grows the table and recycles blocks under the reader
+        table.Remove((round + 250) % 500 + 2);
+      }
+
+      int wait_status = 0;
+      waitpid(child, &wait_status, 0);
+
+      THEN("every lookup should see a whole value") {
+        REQUIRE(WIFEXITED(wait_status));
+        CHECK(WEXITSTATUS(wait_status) == 0);
+      }
+    }
+
+    AND_WHEN("the segment is created twice") {
+      THEN("the second creation should fail") {
+        CHECK_THROWS_AS(SharedHashTable::Create(name), std::runtime_error);
+      }
+    }
+
+    CHECK(SharedHashTable::Unlink(name));
+  }
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+
+#include <thread>
+
+#include "spsc_queue.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("single-producer single-consumer queue") {
+
+  GIVEN("empty queue") {
+    auto queue = SpscQueue<int>(3);
+    int value = 0;
+
+    THEN("its capacity should be rounded up to a power of two") {
+      CHECK(queue.capacity() == 4);
+      CHECK_FALSE(queue.TryPop(value));
+    }
+
+    WHEN("the queue is filled up") {
+      for (int index = 0; index < 4; index++) {
+        REQUIRE(queue.TryPush(int{index}));
+      }
+
+      THEN("it should reject more values and return the queued ones in order") {
+        CHECK_FALSE(queue.TryPush(4));
+        for (int index = 0; index < 4; index++) {
+          REQUIRE(queue.TryPop(value));
+          CHECK(value == index);
+        }
+        CHECK_FALSE(queue.TryPop(value));
+        CHECK(queue.TryPush(4));
+      }
+    }
+  }
+
+  GIVEN("producer and consumer threads") {
+    constexpr int kNumValues = 1'000'000;
+    auto queue = SpscQueue<int>(64);
+
+    WHEN("the producer pushes many more values than fit into the queue") {
+      auto producer = std::thread([&queue] {
+        for (int index = 0; index < kNumValues; index++) {
+          while (!queue.TryPush(int{index})) {
+            std::this_thread::yield();
+          }
+        }
+      });
+
+      bool is_ordered = true;
+      int value = 0;
+      for (int index = 0; index < kNumValues; index++) {
+        while (!queue.TryPop(value)) {
+          std::this_thread::yield();
+        }
+        is_ordered = is_ordered && value == index;
+      }
+      producer.join();
+
+      THEN("the consumer should receive every value in order") {
+        CHECK(is_ordered);
+        CHECK_FALSE(queue.TryPop(value));
+      }
+    }
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+namespace itis {
+
+  namespace test_data {
+
+    /**
+     * Keys of the rows of a test relation, taken from a range of consecutive values in a scattered order.
+     * @param num_rows - number of the keys to generate
+     * @param num_keys - size of the range (a stride coprime with it visits every value before repeating one)
+     * @param first - smallest value of the range
+     * @param stride - distance between the positions of consecutive rows inside the range
+     * @return key of every row
+     */
+    inline std::vector<int> scattered_keys(int num_rows, int num_keys, int first, int stride) {
+      std::vector<int> keys;
+      keys.reserve(num_rows);
+      for (int row = 0; row < num_rows; row++) {
+        keys.push_back(static_cast<int>(static_cast<long long>(row) * stride % num_keys) + first);
+      }
+      return keys;
+    }
+
+  }  // namespace test_data
+
+}  // namespace itis
@@ -0,0 +1,176 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>  // remove
+#include <fstream>
+#include <string>  // to_string
+#include <thread>
+#include <vector>
+
+#include <unistd.h>  // getpid
+
+#include "durable_hash_table.hpp"
+
+using namespace std;
+using namespace itis;
+
+SCENARIO("write-ahead log records") {
+
+  GIVEN("log with a few records") {
+    const std::string path = "/tmp/itis_wal_" + std::to_string(getpid()) + ".log";
+    std::remove(path.c_str());
+
+    {
+      auto log = WriteAheadLog(path);
+      REQUIRE(log.Recover().empty());
+      log.Append(WriteAheadLog::RecordType::kPut, 1, "one");
+      log.Append(WriteAheadLog::RecordType::kPut, -2, std::string(1000, 'x'));
+      const auto lsn = log.Append(WriteAheadLog::RecordType::kRemove, 1);
+      log.Commit(lsn);
+      CHECK(log.durable_lsn() == 3);
+      CHECK(log.num_syncs() == 1);
+    }
+
+    WHEN("reopening the log") {
+      auto log = WriteAheadLog(path);
+      const auto records = log.Recover();
+
+      THEN("the records should be read back in order") {
+        REQUIRE(records.size() == 3);
+        CHECK(records[0].type == WriteAheadLog::RecordType::kPut);
+        CHECK(records[0].key == 1);
+        CHECK(records[0].value == "one");
+        CHECK(records[1].value == std::string(1000, 'x'));
+        CHECK(records[2].type == WriteAheadLog::RecordType::kRemove);
+      }
+    }
+
+    AND_WHEN("the last record is torn by a crash") {
+      {
+        std::ofstream output(path, std::ios::binary | std::ios::app);
+        output << "partial record";
+      }
+
+      auto log = WriteAheadLog(path);
+      const auto records = log.Recover();
+      log.Append(WriteAheadLog::RecordType::kPut, 4, "four");
+      log.Sync();
+
+      THEN("the torn tail should be dropped and new records appended after the valid ones") {
+        CHECK(records.size() == 3);
+
+        auto reopened = WriteAheadLog(path);
+        const auto all_records = reopened.Recover();
+        REQUIRE(all_records.size() == 4);
+        CHECK(all_records.back().value == "four");
+      }
+    }
+
+    std::remove(path.c_str());
+  }
+}
+
+SCENARIO("durable hash table recovery") {
+
+  GIVEN("durable hash table with logged mutations") {
+    const auto durability = GENERATE(DurableHashTable::Durability::kSynchronous,
+                                     DurableHashTable::Durability::kBuffered);
+    const std::string prefix = "/tmp/itis_durable_" + std::to_string(getpid());
+    const std::string snapshot_path = prefix + ".snapshot";
+    const std::string log_path = prefix + ".log";
+    std::remove(snapshot_path.c_str());
+    std::remove(log_path.c_str());
+
+    {
+      auto table = DurableHashTable(snapshot_path, log_path, durability);
+      for (int key = 0; key < 100; key++) {
+        table.Put(key, std::to_string(key));
+      }
+      table.Remove(7);
+      table.Put(8, "eight");
+      table.Sync();
+    }
+
+    WHEN("reopening the table") {
+      auto table = DurableHashTable(snapshot_path, log_path, durability);
+
+      THEN("the mutations should be replayed from the log") {
+        CHECK(table.size() == 99);
+        CHECK_FALSE(table.ContainsKey(7));
+        CHECK(table.Search(8).value() == "eight");
+        CHECK(table.Search(99).value() == "99");
+      }
+    }
+
+    AND_WHEN("checkpointing and mutating again before reopening") {
+      {
+        auto table = DurableHashTable(snapshot_path, log_path, durability);
+        table.Checkpoint();
+        table.Put(1000, "after the checkpoint");
+        table.Remove(0);
+      }
+      auto table = DurableHashTable(snapshot_path, log_path, durability);
+
+      THEN("the log should be replayed on top of the snapshot") {
+        CHECK(table.size() == 99);
+        CHECK(table.Search(1000).value() == "after the checkpoint");
+        CHECK_FALSE(table.ContainsKey(0));
+        CHECK(table.Search(8).value() == "eight");
+      }
+    }
+
+    std::remove(snapshot_path.c_str());
+    std::remove(log_path.c_str());
+  }
+
+  GIVEN("buffered durable hash table") {
+    const std::string prefix = "/tmp/itis_group_" + std::to_string(getpid());
+    std::remove((prefix + ".log").c_str());
+    auto table = DurableHashTable(prefix + ".snapshot", prefix + ".log", DurableHashTable::Durability::kBuffered,
+                                  4096);
+
+    WHEN("putting many small pairs") {
+      for (int key = 0; key < 10000; key++) {
+        table.Put(key, "value");
+      }
+
+      THEN("the records should be synced in groups") {
+        CHECK(table.num_syncs() > 0);
+        CHECK(table.num_syncs() < 100);
+      }
+    }
+
+    std::remove((prefix + ".log").c_str());
+  }
+
+  GIVEN("synchronous durable hash table written by several threads") {
+    const std::string prefix = "/tmp/itis_threads_" + std::to_string(getpid());
+    std::remove((prefix + ".log").c_str());
+
+    {
+      auto table = DurableHashTable(prefix + ".snapshot", prefix + ".log");
+      std::vector<std::thread> writers;
+      for (int writer = 0; writer < 4; writer++) {
+        writers.emplace_back([&table, writer] {
+          for (int index = 0; index < 100; index++) {
+            table.Put(writer * 1000 + index, std::to_string(index));
+          }
+        });
+      }
+      for (auto &writer : writers) {
+        writer.join();
+      }
+      CHECK(table.num_syncs() <= 400);
+    }
+
+    WHEN("reopening the table") {
+      auto table = DurableHashTable(prefix + ".snapshot", prefix + ".log");
+
+      THEN("every acknowledged put should be recovered") {
+        CHECK(table.size() == 400);
+        CHECK(table.Search(3099).value() == "99");
+      }
+    }
+
+    std::remove((prefix + ".log").c_str());
+  }
+}